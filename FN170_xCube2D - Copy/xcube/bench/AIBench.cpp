@@ -0,0 +1,250 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "AIScheduler.h"
+#include "Benchmark.h"
+#include "Crowd.h"
+#include "EnemyEntity.h"
+#include "EnemySwarm.h"
+#include "FlowField.h"
+#include "HierarchicalPathfinder.h"
+
+static const int SWARM_BENCH_COUNT = 50000;
+
+static void fillSwarm(EnemySwarm & swarm) {
+	swarm.reserve(SWARM_BENCH_COUNT);
+	for (int i = 0; i < SWARM_BENCH_COUNT; ++i)
+		swarm.add(Vector2f((float)getRandom(-400, 1200), (float)getRandom(-300, 900)));
+}
+
+// what MyGame does per enemy, scaled up to a wave
+XCUBE_BENCHMARK(EnemyEntity_update_50k) {
+	std::vector<std::unique_ptr<EnemyEntity>> enemies;
+	for (int i = 0; i < SWARM_BENCH_COUNT; ++i) {
+		enemies.push_back(std::unique_ptr<EnemyEntity>(new EnemyEntity()));
+		enemies.back()->setPosition(Point2(getRandom(-400, 1200), getRandom(-300, 900)));
+	}
+
+	while (state.keepRunning()) {
+		for (size_t i = 0; i < enemies.size(); ++i)
+			enemies[i]->update(0.016f, Point2(400, 300));
+		doNotOptimize(enemies[0]->getPosition());
+	}
+}
+
+XCUBE_BENCHMARK(EnemySwarm_update_scalar_50k) {
+	EnemySwarm swarm;
+	fillSwarm(swarm);
+	while (state.keepRunning()) {
+		swarm.updateScalar(Vector2f(400, 300), 0.016f);
+		doNotOptimize(swarm.getPositionsX()[0]);
+	}
+}
+
+XCUBE_BENCHMARK(EnemySwarm_update_50k) {
+	EnemySwarm swarm;
+	fillSwarm(swarm);
+	while (state.keepRunning()) {
+		swarm.update(Vector2f(400, 300), 0.016f);
+		doNotOptimize(swarm.getPositionsX()[0]);
+	}
+}
+
+XCUBE_BENCHMARK(EnemySwarm_update_threads_50k) {
+	EnemySwarm swarm;
+	fillSwarm(swarm);
+	swarm.setThreadCount(0);
+	while (state.keepRunning()) {
+		swarm.update(Vector2f(400, 300), 0.016f);
+		doNotOptimize(swarm.getPositionsX()[0]);
+	}
+}
+
+// the demo's 800x600 play area in 8 pixel cells with scattered walls
+template <class Grid>
+static void fillWalls(Grid & grid) {
+	for (int i = 0; i < 120; ++i) {
+		SDL_Rect wall = { getRandom(0, 800), getRandom(0, 600), getRandom(8, 48), getRandom(8, 48) };
+		grid.setBlockedRect(wall, true);
+	}
+}
+
+XCUBE_BENCHMARK(FlowField_rebuild_100x75) {
+	FlowField field(100, 75, 8.0f);
+	fillWalls(field);
+	int i = 0;
+	while (state.keepRunning()) {
+		// a new target cell every time, so each rebuild is a full search
+		field.setTarget(Vector2f((float)(i * 37 % 800), (float)(i * 53 % 600)));
+		field.rebuild();
+		++i;
+	}
+}
+
+XCUBE_BENCHMARK(EnemySwarm_update_flow_50k) {
+	FlowField field(100, 75, 8.0f);
+	fillWalls(field);
+	field.setTarget(Vector2f(400, 300));
+	field.rebuild();
+
+	EnemySwarm swarm;
+	fillSwarm(swarm);
+	while (state.keepRunning()) {
+		swarm.update(field, Vector2f(400, 300), 0.016f);
+		doNotOptimize(swarm.getPositionsX()[0]);
+	}
+}
+
+XCUBE_BENCHMARK(HierarchicalPathfinder_rebuild_100x75) {
+	HierarchicalPathfinder paths(100, 75, 8.0f);
+	fillWalls(paths);
+	while (state.keepRunning())
+		paths.rebuild();
+}
+
+XCUBE_BENCHMARK(HierarchicalPathfinder_request_500) {
+	HierarchicalPathfinder paths(100, 75, 8.0f);
+	fillWalls(paths);
+	paths.rebuild();
+
+	std::vector<PoolHandle> handles(500);
+	int i = 0;
+	while (state.keepRunning()) {
+		// different cells every round, so no search is served from the path cache
+		for (PoolHandle & handle : handles) {
+			handle = paths.requestPath(Vector2f((float)(i * 37 % 800), (float)(i * 53 % 600)), Vector2f((float)(i * 71 % 800), (float)(i * 29 % 600)));
+			++i;
+		}
+		while (paths.getPendingCount() > 0)
+			paths.update();
+		for (const PoolHandle & handle : handles)
+			paths.releasePath(handle);
+	}
+}
+
+XCUBE_BENCHMARK(Crowd_update_50k) {
+	EnemySwarm swarm;
+	fillSwarm(swarm);
+	Crowd crowd;
+	while (state.keepRunning()) {
+		crowd.update(swarm.getPositionsX(), swarm.getPositionsY(), swarm.getVelocitiesX(), swarm.getVelocitiesY(), swarm.getCount());
+		doNotOptimize(crowd.getForcesX()[0]);
+	}
+}
+
+XCUBE_BENCHMARK(Crowd_update_threads_50k) {
+	EnemySwarm swarm;
+	fillSwarm(swarm);
+	Crowd crowd;
+	crowd.setThreadCount(0);
+	while (state.keepRunning()) {
+		crowd.update(swarm.getPositionsX(), swarm.getPositionsY(), swarm.getVelocitiesX(), swarm.getVelocitiesY(), swarm.getCount());
+		doNotOptimize(crowd.getForcesX()[0]);
+	}
+}
+
+// every agent against every other, what the spatial hash saves
+XCUBE_BENCHMARK(Crowd_all_pairs_5k) {
+	const int count = SWARM_BENCH_COUNT / 10;
+	std::vector<float> x(count), y(count), forceX(count), forceY(count);
+	for (int i = 0; i < count; ++i) {
+		x[i] = (float)getRandom(-400, 1200);
+		y[i] = (float)getRandom(-300, 900);
+	}
+
+	const CrowdSettings settings;
+	const float radius2 = settings.separationRadius * settings.separationRadius;
+	while (state.keepRunning()) {
+		for (int i = 0; i < count; ++i) {
+			float fx = 0, fy = 0;
+			for (int j = 0; j < count; ++j) {
+				const float dx = x[i] - x[j], dy = y[i] - y[j], d2 = dx * dx + dy * dy;
+				if (j != i && d2 < radius2 && d2 > 0) {
+					const float d = std::sqrt(d2);
+					const float strength = (1.0f - d / settings.separationRadius) / d;
+					fx += dx * strength;
+					fy += dy * strength;
+				}
+			}
+			forceX[i] = fx * settings.separation;
+			forceY[i] = fy * settings.separation;
+		}
+		doNotOptimize(forceX[0]);
+	}
+}
+
+XCUBE_BENCHMARK(Crowd_update_5k) {
+	EnemySwarm swarm;
+	for (int i = 0; i < SWARM_BENCH_COUNT / 10; ++i)
+		swarm.add(Vector2f((float)getRandom(-400, 1200), (float)getRandom(-300, 900)));
+
+	Crowd crowd;
+	while (state.keepRunning()) {
+		crowd.update(swarm.getPositionsX(), swarm.getPositionsY(), swarm.getVelocitiesX(), swarm.getVelocitiesY(), swarm.getCount());
+		doNotOptimize(crowd.getForcesX()[0]);
+	}
+}
+
+/* AI LEVEL OF DETAIL - agents spread over a world 8000 pixels across, the player in the middle */
+
+struct BenchAgent {
+	Vector2f position;
+	float thinkTimer;
+};
+
+static void fillAgents(std::vector<BenchAgent> & agents, const int & count) {
+	agents.resize(count);
+	for (BenchAgent & agent : agents) {
+		agent.position = Vector2f((float)getRandom(0, 8000), (float)getRandom(0, 8000));
+		agent.thinkTimer = 0.0f;
+	}
+}
+
+// stands in for an enemy's logic, which only stays right at any rate if it uses dt.
+// Agents circle the player, so the tiers keep their populations while measuring
+static void thinkAgent(BenchAgent & agent, const Vector2f & player, const float & dt) {
+	Vector2f toPlayer(player.x - agent.position.x, player.y - agent.position.y);
+	float length = std::sqrt(toPlayer.x * toPlayer.x + toPlayer.y * toPlayer.y);
+	if (length > 1.0f) {
+		agent.position.x += -toPlayer.y / length * 60.0f * dt;
+		agent.position.y += toPlayer.x / length * 60.0f * dt;
+	}
+	agent.thinkTimer += dt;
+}
+
+static void benchEveryTick(BenchState & state, const int & count) {
+	const Vector2f player(4000, 4000);
+	std::vector<BenchAgent> agents;
+	fillAgents(agents, count);
+	while (state.keepRunning()) {
+		for (BenchAgent & agent : agents)
+			thinkAgent(agent, player, 0.016f);
+		doNotOptimize(agents[0].position);
+	}
+}
+
+static void benchScheduled(BenchState & state, const int & count) {
+	std::vector<BenchAgent> agents;
+	fillAgents(agents, count);
+
+	const Vector2f player(4000, 4000);
+	AIScheduler scheduler;
+	scheduler.setUpdateBudget(2000);
+	scheduler.setFocus(player);
+	for (const BenchAgent & agent : agents)
+		scheduler.add(agent.position);
+
+	while (state.keepRunning()) {
+		scheduler.update(player, 0.016f, [&](int id, float dt) {
+			thinkAgent(agents[id], player, dt);
+			scheduler.setPosition(id, agents[id].position);
+		});
+		doNotOptimize(agents[0].position);
+	}
+}
+
+XCUBE_BENCHMARK(AI_every_tick_10k) { benchEveryTick(state, 10000); }
+XCUBE_BENCHMARK(AI_every_tick_100k) { benchEveryTick(state, 100000); }
+XCUBE_BENCHMARK(AIScheduler_update_10k) { benchScheduled(state, 10000); }
+XCUBE_BENCHMARK(AIScheduler_update_100k) { benchScheduled(state, 100000); }
@@ -0,0 +1,26 @@
+#include "Benchmark.h"
+#include "BenchEngine.h"
+
+static std::shared_ptr<MyEngineSystem> getAudioSystem() {
+	std::shared_ptr<MyEngineSystem> system = getBenchEngine()->getMyEngineSystem();
+	if (!ResourceManager::getSound("res/sounds/beep.wav"))
+		ResourceManager::loadSound("res/sounds/beep.wav");
+	system->CreateLayer("bench");
+	return system;
+}
+
+XCUBE_BENCHMARK(MyEngineSystem_Play) {
+	std::shared_ptr<MyEngineSystem> system = getAudioSystem();
+	system->MuteLayer("bench", false);
+	while (state.keepRunning())
+		system->Play("bench", "res/sounds/beep.wav");
+	system->StopAll();
+}
+
+XCUBE_BENCHMARK(MyEngineSystem_Play_muted) {
+	std::shared_ptr<MyEngineSystem> system = getAudioSystem();
+	system->MuteLayer("bench", true);
+	while (state.keepRunning())
+		system->Play("bench", "res/sounds/beep.wav");
+	system->MuteLayer("bench", false);
+}
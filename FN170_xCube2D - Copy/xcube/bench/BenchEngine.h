@@ -0,0 +1,14 @@
+#ifndef __BENCH_ENGINE_H__
+#define __BENCH_ENGINE_H__
+
+#include <memory>
+
+#include "XCube2d.h"
+
+/**
+ * Engine instance shared by benchmarks that need a renderer / mixer
+ * Created on first use so math / physics only runs never open a window
+ */
+std::shared_ptr<XCube2Engine> getBenchEngine();
+
+#endif
@@ -0,0 +1,54 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "Benchmark.h"
+#include "BenchEngine.h"
+
+static bool engineCreated = false;
+
+std::shared_ptr<XCube2Engine> getBenchEngine() {
+	engineCreated = true;
+	return XCube2Engine::getInstance();
+}
+
+static void printUsage() {
+	std::cout << "usage: xcube_bench [--filter name] [--json file] [--label text]" << std::endl;
+	std::cout << "                   [--repetitions n] [--min-time-ms ms]" << std::endl;
+	std::cout << "run from the directory containing res/" << std::endl;
+}
+
+int main(int argc, char * args[]) {
+	std::string filter, jsonFile, label;
+	int repetitions = 10;
+	double minBatchMs = 20.0;
+
+	for (int i = 1; i < argc; ++i) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(args[i], "--filter") == 0 && hasValue) filter = args[++i];
+		else if (strcmp(args[i], "--json") == 0 && hasValue) jsonFile = args[++i];
+		else if (strcmp(args[i], "--label") == 0 && hasValue) label = args[++i];
+		else if (strcmp(args[i], "--repetitions") == 0 && hasValue) repetitions = atoi(args[++i]);
+		else if (strcmp(args[i], "--min-time-ms") == 0 && hasValue) minBatchMs = atof(args[++i]);
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	std::vector<BenchResult> results;
+	try {
+		results = BenchRunner::runAll(filter, minBatchMs, repetitions);
+	} catch (EngineException & e) {
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	if (engineCreated)
+		XCube2Engine::quit();
+
+	if (!jsonFile.empty() && !BenchRunner::writeJSON(jsonFile, label, results))
+		return 1;
+
+	return 0;
+}
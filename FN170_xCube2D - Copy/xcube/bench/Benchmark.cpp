@@ -0,0 +1,128 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+#include "Timer.h"
+
+const void * volatile benchEscape = nullptr;
+
+static const Uint64 BENCH_MAX_ITERATIONS = 1ULL << 30;
+
+/* BENCH STATE */
+
+BenchState::BenchState(Uint64 iterations) : iterations(iterations), remaining(iterations), startNanos(0), elapsedNanos(0), started(false) {}
+
+bool BenchState::keepRunning() {
+	if (!started) {
+		started = true;
+		startNanos = Timer::getNanos();
+	}
+
+	if (remaining == 0) {
+		elapsedNanos += Timer::getNanos() - startNanos;
+		return false;
+	}
+
+	--remaining;
+	return true;
+}
+
+void BenchState::pauseTiming() {
+	elapsedNanos += Timer::getNanos() - startNanos;
+}
+
+void BenchState::resumeTiming() {
+	startNanos = Timer::getNanos();
+}
+
+/* BENCH RUNNER */
+
+std::vector<BenchRunner::Entry> & BenchRunner::registry() {
+	// function local so registration order across translation units does not matter
+	static std::vector<Entry> entries;
+	return entries;
+}
+
+void BenchRunner::add(const std::string & name, BenchFunction function) {
+	Entry entry = { name, function };
+	registry().push_back(entry);
+}
+
+Uint64 BenchRunner::run(BenchFunction function, Uint64 iterations) {
+	BenchState state(iterations);
+	function(state);
+	return state.elapsedNanos;
+}
+
+std::vector<BenchResult> BenchRunner::runAll(const std::string & filter, const double & minBatchMs, const int & repetitions) {
+	std::vector<BenchResult> results;
+	int reps = repetitions < 1 ? 1 : (repetitions > BENCH_MAX_REPETITIONS ? BENCH_MAX_REPETITIONS : repetitions);
+	Uint64 minBatchNanos = (Uint64)(minBatchMs * NANOS_PER_MILLI);
+
+	printf("%-40s %12s %12s %12s %12s\n", "benchmark", "iterations", "min ns/op", "p50 ns/op", "p95 ns/op");
+
+	for (size_t i = 0; i < registry().size(); ++i) {
+		const Entry & entry = registry()[i];
+		if (!filter.empty() && entry.name.find(filter) == std::string::npos)
+			continue;
+
+		// grow the batch until a single repetition is long enough to time reliably
+		Uint64 iterations = 1;
+		Uint64 elapsed = run(entry.function, iterations);
+		while (elapsed < minBatchNanos && iterations < BENCH_MAX_ITERATIONS) {
+			Uint64 scale = elapsed > 0 ? (Uint64)(minBatchNanos * 1.4 / elapsed) : 10;
+			if (scale < 2) scale = 2;
+			if (scale > 10) scale = 10;
+			iterations *= scale;
+			elapsed = run(entry.function, iterations);
+		}
+
+		RollingStats<BENCH_MAX_REPETITIONS> stats;
+		for (int r = 0; r < reps; ++r)
+			stats.add((float)((double)run(entry.function, iterations) / iterations));
+
+		BenchResult result;
+		result.name = entry.name;
+		result.iterations = iterations;
+		result.nsPerOp = stats.getSummary();
+		results.push_back(result);
+
+		printf("%-40s %12llu %12.2f %12.2f %12.2f\n", entry.name.c_str(), (unsigned long long)iterations,
+			result.nsPerOp.min, result.nsPerOp.p50, result.nsPerOp.p95);
+		fflush(stdout);
+	}
+
+	return results;
+}
+
+bool BenchRunner::writeJSON(const std::string & fileName, const std::string & label, const std::vector<BenchResult> & results) {
+	FILE * file = fopen(fileName.c_str(), "w");
+	if (nullptr == file) {
+		std::cout << "Failed to open " << fileName << " for writing" << std::endl;
+		return false;
+	}
+
+	// names and labels are plain identifiers, no escaping is done
+	fprintf(file, "{\n");
+	fprintf(file, "  \"suite\": \"xcube_bench\",\n");
+	fprintf(file, "  \"label\": \"%s\",\n", label.c_str());
+	fprintf(file, "  \"timestamp\": %lld,\n", (long long)time(nullptr));
+	fprintf(file, "  \"platform\": \"%s\",\n", SDL_GetPlatform());
+	fprintf(file, "  \"cpu_count\": %d,\n", SDL_GetCPUCount());
+	fprintf(file, "  \"results\": [\n");
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchResult & r = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"iterations\": %llu, \"repetitions\": %d, "
+			"\"ns_per_op\": { \"min\": %.3f, \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"max\": %.3f } }%s\n",
+			r.name.c_str(), (unsigned long long)r.iterations, r.nsPerOp.count,
+			r.nsPerOp.min, r.nsPerOp.mean, r.nsPerOp.p50, r.nsPerOp.p95, r.nsPerOp.max,
+			i + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(file, "  ]\n}\n");
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,102 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+
+#include "RollingStats.h"
+
+static const int BENCH_MAX_REPETITIONS = 64;
+
+/**
+ * Passed to every benchmark, the body to measure goes inside
+ *
+ *		while (state.keepRunning()) { ...measured code... }
+ *
+ * Anything before the loop is setup and is not timed
+ */
+class BenchState {
+	friend class BenchRunner;
+	private:
+		Uint64 iterations;
+		Uint64 remaining;
+		Uint64 startNanos, elapsedNanos;
+		bool started;
+
+		BenchState(Uint64 iterations);
+	public:
+		bool keepRunning();
+
+		/**
+		* Excludes per iteration setup / teardown from the measurement
+		*/
+		void pauseTiming();
+		void resumeTiming();
+
+		Uint64 getIterations() const { return iterations; }
+};
+
+typedef void (*BenchFunction)(BenchState &);
+
+struct BenchResult {
+	std::string name;
+	Uint64 iterations;	// per repetition
+	StatsSummary nsPerOp;	// over repetitions
+};
+
+/**
+ * Benchmarks register themselves at static init time through XCUBE_BENCHMARK
+ */
+class BenchRunner {
+	private:
+		struct Entry {
+			std::string name;
+			BenchFunction function;
+		};
+
+		static std::vector<Entry> & registry();
+
+		static Uint64 run(BenchFunction, Uint64 iterations);
+	public:
+		static void add(const std::string & name, BenchFunction);
+
+		/**
+		* Runs every benchmark whose name contains filter
+		*
+		* @param minBatchMs - iterations are scaled until one repetition takes at least this long
+		* @param repetitions - timed repetitions per benchmark, statistics are taken over these
+		*/
+		static std::vector<BenchResult> runAll(const std::string & filter, const double & minBatchMs, const int & repetitions);
+
+		/**
+		* Writes results as JSON so runs of different commits can be diffed / plotted
+		*/
+		static bool writeJSON(const std::string & fileName, const std::string & label, const std::vector<BenchResult> &);
+};
+
+struct BenchRegistrar {
+	BenchRegistrar(const char * name, BenchFunction f) { BenchRunner::add(name, f); }
+};
+
+#define XCUBE_BENCHMARK(name) \
+	static void name(BenchState &); \
+	static BenchRegistrar name##_registrar(#name, name); \
+	static void name(BenchState & state)
+
+/**
+ * Keeps the optimiser from removing a computation whose result is unused
+ */
+extern const void * volatile benchEscape;
+
+template <class T>
+inline void doNotOptimize(const T & value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	benchEscape = &value;
+#endif
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Entity.h"
+#include "EntityWorld.h"
+#include "EntityComponents.h"
+
+static const int ECS_ENTITY_COUNT = 100000;
+
+// the virtual hierarchy way, one heap object per entity
+class MovingEntity : public Entity {
+	public:
+		MovingEntity(const Point2 & v) { velocity = v; }
+		void update(float dt) override {
+			position.x += velocity.x * dt;
+			position.y += velocity.y * dt;
+		}
+		void render(GraphicsEngine *) override {}
+};
+
+XCUBE_BENCHMARK(Entity_virtual_update_100k) {
+	std::vector<std::unique_ptr<Entity>> entities;
+	for (int i = 0; i < ECS_ENTITY_COUNT; ++i)
+		entities.push_back(std::unique_ptr<Entity>(new MovingEntity(Point2(getRandom(-60, 60), getRandom(-60, 60)))));
+
+	// after spawning and killing for a while a game's entities are no longer in allocation order
+	std::shuffle(entities.begin(), entities.end(), std::mt19937(42));
+
+	while (state.keepRunning()) {
+		for (size_t i = 0; i < entities.size(); ++i)
+			entities[i]->update(0.016f);
+		doNotOptimize(entities[0]->getPosition());
+	}
+}
+
+static void fillWorld(EntityWorld & world) {
+	for (int i = 0; i < ECS_ENTITY_COUNT; ++i)
+		world.create(Transform(), Velocity(Vector2f((float)getRandom(-60, 60), (float)getRandom(-60, 60))));
+}
+
+XCUBE_BENCHMARK(EntityWorld_forEach_100k) {
+	EntityWorld world;
+	fillWorld(world);
+	EntityQuery<Transform, Velocity> query = world.query<Transform, Velocity>();
+
+	while (state.keepRunning()) {
+		query.forEach([](Transform & t, const Velocity & v) {
+			t.position.x += v.value.x * 0.016f;
+			t.position.y += v.value.y * 0.016f;
+		});
+		doNotOptimize(world.getArchetype(1).getArray<Transform>(0)[0]);
+	}
+}
+
+XCUBE_BENCHMARK(EntityWorld_forEachChunk_100k) {
+	EntityWorld world;
+	fillWorld(world);
+	EntityQuery<Transform, Velocity> query = world.query<Transform, Velocity>();
+
+	while (state.keepRunning()) {
+		query.forEachChunk([](int count, const EntityId *, Transform * t, const Velocity * v) {
+			for (int i = 0; i < count; ++i) {
+				t[i].position.x += v[i].value.x * 0.016f;
+				t[i].position.y += v[i].value.y * 0.016f;
+			}
+		});
+		doNotOptimize(world.getArchetype(1).getArray<Transform>(0)[0]);
+	}
+}
+
+XCUBE_BENCHMARK(EntityWorld_create_destroy) {
+	EntityWorld world;
+	fillWorld(world);
+
+	while (state.keepRunning()) {
+		EntityId e = world.create(Transform(), Velocity(), ProjectileTag());
+		world.destroy(e);
+		doNotOptimize(e);
+	}
+}
+
+XCUBE_BENCHMARK(EntityWorld_add_remove_component) {
+	EntityWorld world;
+	fillWorld(world);
+	EntityId e = world.create(Transform(), Velocity());
+
+	while (state.keepRunning()) {
+		world.add(e, EnemyTag());
+		world.remove<EnemyTag>(e);
+		doNotOptimize(e);
+	}
+}
@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include "BenchEngine.h"
+
+// loaded once, the cached font is reused by every run (ResourceManager_loadFont keeps the cache pointing at a live one)
+static TTF_Font * getFont() {
+	TTF_Font * font = ResourceManager::getFont("res/fonts/arial.ttf");
+	return font ? font : ResourceManager::loadFont("res/fonts/arial.ttf", 24);
+}
+
+static std::shared_ptr<GraphicsEngine> getGraphics() {
+	std::shared_ptr<GraphicsEngine> gfx = getBenchEngine()->getGraphicsEngine();
+	gfx->useFont(getFont());
+	gfx->setDrawColor(SDL_COLOR_WHITE);
+	return gfx;
+}
+
+XCUBE_BENCHMARK(GraphicsEngine_drawText) {
+	std::shared_ptr<GraphicsEngine> gfx = getGraphics();
+	while (state.keepRunning())
+		gfx->drawText("Score: 1250", 20, 20);
+	gfx->clearScreen();
+}
+
+XCUBE_BENCHMARK(GraphicsEngine_drawText_bitmapFont) {
+	std::shared_ptr<GraphicsEngine> gfx = getGraphics();
+	BitmapFont font;
+	font.build(getFont());
+	while (state.keepRunning())
+		font.draw(gfx.get(), "Score: 1250", 20, 20, SDL_COLOR_WHITE);
+	gfx->clearScreen();
+}
+
+XCUBE_BENCHMARK(GraphicsEngine_drawCircle) {
+	std::shared_ptr<GraphicsEngine> gfx = getGraphics();
+	while (state.keepRunning())
+		gfx->drawCircle(Point2(400, 300), 10.0f);
+	gfx->clearScreen();
+}
+
+XCUBE_BENCHMARK(GraphicsEngine_fillRect) {
+	std::shared_ptr<GraphicsEngine> gfx = getGraphics();
+	while (state.keepRunning())
+		gfx->fillRect(392, 292, 16, 16);
+	gfx->clearScreen();
+}
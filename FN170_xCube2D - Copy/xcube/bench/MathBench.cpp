@@ -0,0 +1,95 @@
+#include "Benchmark.h"
+#include "GameMath.h"
+
+// inputs are read from arrays so the compiler cannot fold the maths away
+static const int INPUT_COUNT = 256;
+
+static void fillVectors(Vector2f * v) {
+	for (int i = 0; i < INPUT_COUNT; ++i)
+		v[i] = Vector2f((float)getRandom(-500, 500), (float)getRandom(-500, 500));
+}
+
+XCUBE_BENCHMARK(GameMath_length) {
+	Vector2f v[INPUT_COUNT];
+	fillVectors(v);
+	int i = 0;
+	while (state.keepRunning()) {
+		float len = length(v[i]);
+		doNotOptimize(len);
+		i = (i + 1) & (INPUT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(GameMath_normalise) {
+	Vector2f v[INPUT_COUNT];
+	fillVectors(v);
+	int i = 0;
+	while (state.keepRunning()) {
+		Vector2f n = normalise(v[i]);
+		doNotOptimize(n);
+		i = (i + 1) & (INPUT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(GameMath_scale) {
+	Vector2f v[INPUT_COUNT];
+	fillVectors(v);
+	int i = 0;
+	while (state.keepRunning()) {
+		Vector2f s = v[i] * 0.016f;
+		doNotOptimize(s);
+		i = (i + 1) & (INPUT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(GameMath_toRadians) {
+	float degrees[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; ++i)
+		degrees[i] = (float)getRandom(0, 360);
+	int i = 0;
+	while (state.keepRunning()) {
+		float r = toRadians(degrees[i]);
+		doNotOptimize(r);
+		i = (i + 1) & (INPUT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(GameMath_getRandom) {
+	while (state.keepRunning()) {
+		int r = getRandom(50, 750);
+		doNotOptimize(r);
+	}
+}
+
+// one semi-implicit Euler step in Q16.16, against the same step in float below
+XCUBE_BENCHMARK(Fixed_euler_step) {
+	Fixed pos[INPUT_COUNT], vel[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; ++i) {
+		pos[i] = getRandom(-500, 500);
+		vel[i] = getRandom(-200, 200);
+	}
+	const Fixed h = 1.0f / 240.0f, acc = 600, drag = 0.99f;
+	int i = 0;
+	while (state.keepRunning()) {
+		vel[i] = (vel[i] + acc * h) * drag;
+		pos[i] += vel[i] * h;
+		doNotOptimize(pos[i]);
+		i = (i + 1) & (INPUT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(Float_euler_step) {
+	float pos[INPUT_COUNT], vel[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; ++i) {
+		pos[i] = (float)getRandom(-500, 500);
+		vel[i] = (float)getRandom(-200, 200);
+	}
+	const float h = 1.0f / 240.0f, acc = 600, drag = 0.99f;
+	int i = 0;
+	while (state.keepRunning()) {
+		vel[i] = (vel[i] + acc * h) * drag;
+		pos[i] += vel[i] * h;
+		doNotOptimize(pos[i]);
+		i = (i + 1) & (INPUT_COUNT - 1);
+	}
+}
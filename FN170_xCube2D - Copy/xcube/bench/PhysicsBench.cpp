@@ -0,0 +1,501 @@
+#include "AABBBatch.h"
+#include "Benchmark.h"
+#include "BenchEngine.h"
+#include "GameMath.h"
+#include "PhysicsEngine.h"
+#include "ObjectPool.h"
+#include "Projectile.h"
+
+#include <algorithm>
+#include <vector>
+
+static const int OBJECT_COUNT = 256;
+
+// objects scattered over the 800x600 play area, roughly the demo's sizes
+static std::vector<PhysicsObject> makeObjects() {
+	std::vector<PhysicsObject> objects;
+	objects.reserve(OBJECT_COUNT);
+	for (int i = 0; i < OBJECT_COUNT; ++i) {
+		float size = (float)getRandom(16, 128);
+		objects.push_back(PhysicsObject(Point2(getRandom(0, 800), getRandom(0, 600)), size, size));
+	}
+	return objects;
+}
+
+XCUBE_BENCHMARK(PhysicsObject_isColliding) {
+	std::vector<PhysicsObject> objects = makeObjects();
+	int i = 0;
+	while (state.keepRunning()) {
+		bool hit = objects[i].isColliding(objects[(i + 1) & (OBJECT_COUNT - 1)]);
+		doNotOptimize(hit);
+		i = (i + 1) & (OBJECT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(Rectangle2_intersects_rect) {
+	std::vector<Rectangle2> rects;
+	for (int i = 0; i < OBJECT_COUNT; ++i)
+		rects.push_back(Rectangle2(getRandom(0, 800), getRandom(0, 600), getRandom(16, 128), getRandom(16, 128)));
+	int i = 0;
+	while (state.keepRunning()) {
+		bool hit = rects[i].intersects(rects[(i + 1) & (OBJECT_COUNT - 1)]);
+		doNotOptimize(hit);
+		i = (i + 1) & (OBJECT_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(Rectangle2_intersects_line) {
+	std::vector<Rectangle2> rects;
+	std::vector<Line2i> lines;
+	for (int i = 0; i < OBJECT_COUNT; ++i) {
+		rects.push_back(Rectangle2(getRandom(0, 800), getRandom(0, 600), getRandom(16, 128), getRandom(16, 128)));
+		lines.push_back(Line2i(Point2(getRandom(0, 800), getRandom(0, 600)), Point2(getRandom(0, 800), getRandom(0, 600))));
+	}
+	int i = 0;
+	while (state.keepRunning()) {
+		bool hit = rects[i].intersects(lines[i]);
+		doNotOptimize(hit);
+		i = (i + 1) & (OBJECT_COUNT - 1);
+	}
+}
+
+static const int BROADPHASE_OBJECT_COUNT = 2048;
+
+// projectile sized bodies over a 1600x1200 area, same layout for both variants
+static std::vector<std::shared_ptr<PhysicsObject>> makeBroadphaseObjects() {
+	std::vector<std::shared_ptr<PhysicsObject>> objects;
+	for (int i = 0; i < BROADPHASE_OBJECT_COUNT; ++i) {
+		float size = (float)getRandom(8, 48);
+		objects.push_back(std::make_shared<PhysicsObject>(Point2(getRandom(0, 1600), getRandom(0, 1200)), size, size));
+	}
+	return objects;
+}
+
+XCUBE_BENCHMARK(PhysicsEngine_update_broadphase_2k) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->registerObject(objects[i]);
+
+	while (state.keepRunning()) {
+		physics->update();
+		doNotOptimize(physics->getContacts().size());
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+XCUBE_BENCHMARK(PhysicsEngine_update_sap_2k) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->registerObject(objects[i]);
+
+	physics->setBroadphase(BROADPHASE_SAP);
+	int frame = 0;
+	while (state.keepRunning()) {
+		// a tenth of the bodies move each update, the rest keep their cached contacts
+		for (size_t i = frame % 10; i < objects.size(); i += 10) {
+			Point2 c = objects[i]->getCenter();
+			objects[i]->setCenter(Point2(c.x + ((frame & 1) ? 2 : -2), c.y));
+		}
+		++frame;
+
+		physics->update();
+		doNotOptimize(physics->getContactEvents().size());
+	}
+	physics->setBroadphase(BROADPHASE_GRID);
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+// 4096 line of sight checks between random bodies, the kind of load many AI agents generate
+XCUBE_BENCHMARK(PhysicsEngine_raycastBatch_4k_rays) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->registerObject(objects[i]);
+
+	std::vector<RayQuery> rays;
+	for (int i = 0; i < 4096; ++i) {
+		PhysicsObject * from = objects[getRandom(0, BROADPHASE_OBJECT_COUNT - 1)].get();
+		PhysicsObject * to = objects[getRandom(0, BROADPHASE_OBJECT_COUNT - 1)].get();
+		rays.push_back(RayQuery(from->getCenter(), to->getCenter(), from, to));
+	}
+	std::vector<RaycastHit> hits(rays.size());
+
+	physics->update();
+	while (state.keepRunning()) {
+		int blocked = physics->raycastBatch(rays.data(), (int)rays.size(), hits.data());
+		doNotOptimize(blocked);
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+XCUBE_BENCHMARK(PhysicsEngine_queryAABB_2k) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->registerObject(objects[i]);
+
+	PhysicsObject * results[256];
+	physics->update();
+	int q = 0;
+	while (state.keepRunning()) {
+		Point2 c = objects[q]->getCenter();
+		int found = physics->queryAABB(Rectf((float)c.x - 100.0f, (float)c.y - 100.0f, 200.0f, 200.0f), results, 256);
+		doNotOptimize(found);
+		q = (q + 1) & (BROADPHASE_OBJECT_COUNT - 1);
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+// a hexagon inside the body's box
+static CollisionShape makeHexagon(const float & radius) {
+	Vector2f vertices[6];
+	for (int v = 0; v < 6; ++v)
+		vertices[v] = Vector2f(radius * std::cos(toRadians(v * 60.0f)), radius * std::sin(toRadians(v * 60.0f)));
+	return CollisionShape::polygon(vertices, 6);
+}
+
+// every body dynamic and moving, mostly the integrator's substeps plus a full grid rebuild
+static void runDynamicScene(BenchState & state, const int & threads, const ShapeType & shape = SHAPE_BOX) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i) {
+		float half = objects[i]->getHalfLengthX();
+		if (shape == SHAPE_CIRCLE)
+			objects[i]->setShape(CollisionShape::circle(half));
+		else if (shape == SHAPE_POLYGON)
+			objects[i]->setShape(makeHexagon(half));
+
+		objects[i]->setMotionType(MOTION_DYNAMIC);
+		objects[i]->setRestitution(0.5f);
+		objects[i]->setVelocity(Vector2f((float)getRandom(-60, 60), (float)getRandom(-60, 60)));
+		physics->registerObject(objects[i]);
+	}
+	physics->setThreadCount(threads);
+
+	int frame = 0;
+	while (state.keepRunning()) {
+		// turn everything around now and then so the bodies stay in the same area
+		if (++frame % 120 == 0)
+			for (size_t i = 0; i < objects.size(); ++i) {
+				Vector2f v = objects[i]->getVelocity();
+				objects[i]->setVelocity(Vector2f(-v.x, -v.y));
+			}
+
+		physics->update();
+		doNotOptimize(physics->getContacts().size());
+	}
+
+	physics->setThreadCount(1);
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+XCUBE_BENCHMARK(PhysicsEngine_update_dynamic_2k) {
+	runDynamicScene(state, 1);
+}
+
+// same scene with the narrow phase on every hardware thread
+XCUBE_BENCHMARK(PhysicsEngine_update_dynamic_2k_mt) {
+	runDynamicScene(state, 0);
+}
+
+// same scene as circles, the pairs go through the SIMD circle batch
+XCUBE_BENCHMARK(PhysicsEngine_update_circles_2k) {
+	runDynamicScene(state, 1, SHAPE_CIRCLE);
+}
+
+// and as hexagons, through the separating axis test
+XCUBE_BENCHMARK(PhysicsEngine_update_polygons_2k) {
+	runDynamicScene(state, 1, SHAPE_POLYGON);
+}
+
+// bullets and pickups that only care about a few enemies, most candidates are dropped by the layer AND
+XCUBE_BENCHMARK(PhysicsEngine_update_layers_2k) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	const Uint32 enemyLayer = 1 << 0, bulletLayer = 1 << 1, pickupLayer = 1 << 2;
+	for (size_t i = 0; i < objects.size(); ++i) {
+		if (i % 8 == 0)
+			objects[i]->setCollisionFilter(enemyLayer, bulletLayer);
+		else if (i % 2 == 0)
+			objects[i]->setCollisionFilter(bulletLayer, enemyLayer);
+		else
+			objects[i]->setCollisionFilter(pickupLayer, 0);
+		physics->registerObject(objects[i]);
+	}
+
+	int frame = 0;
+	while (state.keepRunning()) {
+		// everything moves so every candidate pair is looked at
+		int dx = (++frame & 1) ? 1 : -1;
+		for (size_t i = 0; i < objects.size(); ++i) {
+			Vector2f p = objects[i]->getPosition();
+			objects[i]->setPosition(Vector2f(p.x + dx, p.y));
+		}
+
+		physics->update();
+		doNotOptimize(physics->getContacts().size());
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+// a level of static scenery with a few movers, the static bodies are neither integrated nor paired with each other
+XCUBE_BENCHMARK(PhysicsEngine_update_static_2k) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i) {
+		if (i % 8 == 0) {
+			objects[i]->setMotionType(MOTION_DYNAMIC);
+			objects[i]->setVelocity(Vector2f((float)getRandom(-60, 60), (float)getRandom(-60, 60)));
+		}
+		else {
+			objects[i]->setMotionType(MOTION_STATIC);
+		}
+		physics->registerObject(objects[i]);
+	}
+
+	int frame = 0;
+	while (state.keepRunning()) {
+		if (++frame % 120 == 0)
+			for (size_t i = 0; i < objects.size(); i += 8) {
+				Vector2f v = objects[i]->getVelocity();
+				objects[i]->setVelocity(Vector2f(-v.x, -v.y));
+			}
+
+		physics->update();
+		doNotOptimize(physics->getContacts().size());
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+// one rollback step, save the frame then restore it, as a netcode resimulation would
+XCUBE_BENCHMARK(PhysicsEngine_snapshot_2k) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	for (size_t i = 0; i < objects.size(); ++i) {
+		objects[i]->setMotionType(MOTION_DYNAMIC);
+		objects[i]->setVelocity(Vector2f((float)getRandom(-60, 60), (float)getRandom(-60, 60)));
+		physics->registerObject(objects[i]);
+	}
+	physics->update();
+
+	PhysicsSnapshot snapshot;
+	while (state.keepRunning()) {
+		physics->saveSnapshot(snapshot);
+		physics->restoreSnapshot(snapshot);
+		doNotOptimize(snapshot.getSize());
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+		physics->unregisterObject(objects[i]);
+}
+
+// what MyGame did before the broadphase, every object against every other
+XCUBE_BENCHMARK(PhysicsObject_all_pairs_2k) {
+	std::vector<std::shared_ptr<PhysicsObject>> objects = makeBroadphaseObjects();
+	while (state.keepRunning()) {
+		int hits = 0;
+		for (int i = 0; i < BROADPHASE_OBJECT_COUNT; ++i)
+			for (int j = i + 1; j < BROADPHASE_OBJECT_COUNT; ++j)
+				if (objects[i]->isColliding(*objects[j]))
+					++hits;
+		doNotOptimize(hits);
+	}
+}
+
+static const int BATCH_BOX_COUNT = 4096;
+
+struct BatchBoxes {
+	std::vector<float> minX, minY, maxX, maxY;
+	std::vector<int> hits;
+
+	BatchBoxes() : hits(BATCH_BOX_COUNT) {
+		for (int i = 0; i < BATCH_BOX_COUNT; ++i) {
+			float x = (float)getRandom(0, 1600), y = (float)getRandom(0, 1200);
+			float size = (float)getRandom(8, 48);
+			minX.push_back(x); minY.push_back(y);
+			maxX.push_back(x + size); maxY.push_back(y + size);
+		}
+	}
+
+	AABBArrays arrays() const {
+		AABBArrays a = { minX.data(), minY.data(), maxX.data(), maxY.data() };
+		return a;
+	}
+};
+
+// one query box against 4096 boxes, ns per op is per full sweep
+XCUBE_BENCHMARK(AABB_batch_scalar_4k) {
+	BatchBoxes boxes;
+	AABBArrays arrays = boxes.arrays();
+	int q = 0;
+	while (state.keepRunning()) {
+		int hits = overlapAABBBatchScalar(boxes.minX[q], boxes.minY[q], boxes.maxX[q], boxes.maxY[q], arrays, 0, BATCH_BOX_COUNT, boxes.hits.data());
+		doNotOptimize(hits);
+		q = (q + 1) & (BATCH_BOX_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(AABB_batch_simd_4k) {
+	BatchBoxes boxes;
+	AABBArrays arrays = boxes.arrays();
+	int q = 0;
+	while (state.keepRunning()) {
+		int hits = overlapAABBBatch(boxes.minX[q], boxes.minY[q], boxes.maxX[q], boxes.maxY[q], arrays, 0, BATCH_BOX_COUNT, boxes.hits.data());
+		doNotOptimize(hits);
+		q = (q + 1) & (BATCH_BOX_COUNT - 1);
+	}
+}
+
+struct BatchCircles {
+	std::vector<float> dx, dy, radiusSum;
+	std::vector<int> hits;
+
+	BatchCircles() : hits(BATCH_BOX_COUNT) {
+		for (int i = 0; i < BATCH_BOX_COUNT; ++i) {
+			dx.push_back((float)getRandom(-64, 64));
+			dy.push_back((float)getRandom(-64, 64));
+			radiusSum.push_back((float)getRandom(8, 48));
+		}
+	}
+};
+
+// 4096 circle pairs, the narrow phase's batch, ns per op is per full batch
+XCUBE_BENCHMARK(Circle_batch_scalar_4k) {
+	BatchCircles circles;
+	while (state.keepRunning()) {
+		int hits = overlapCircleBatchScalar(circles.dx.data(), circles.dy.data(), circles.radiusSum.data(), BATCH_BOX_COUNT, circles.hits.data());
+		doNotOptimize(hits);
+	}
+}
+
+XCUBE_BENCHMARK(Circle_batch_simd_4k) {
+	BatchCircles circles;
+	while (state.keepRunning()) {
+		int hits = overlapCircleBatch(circles.dx.data(), circles.dy.data(), circles.radiusSum.data(), BATCH_BOX_COUNT, circles.hits.data());
+		doNotOptimize(hits);
+	}
+}
+
+// the same sweep through PhysicsObject::isColliding, the pre-SoA layout
+XCUBE_BENCHMARK(AABB_batch_objects_4k) {
+	std::vector<PhysicsObject> objects;
+	objects.reserve(BATCH_BOX_COUNT);
+	for (int i = 0; i < BATCH_BOX_COUNT; ++i) {
+		float size = (float)getRandom(8, 48);
+		objects.push_back(PhysicsObject(Point2(getRandom(0, 1600), getRandom(0, 1200)), size, size));
+	}
+	int q = 0;
+	while (state.keepRunning()) {
+		int hits = 0;
+		for (int i = 0; i < BATCH_BOX_COUNT; ++i)
+			if (objects[q].isColliding(objects[i]))
+				++hits;
+		doNotOptimize(hits);
+		q = (q + 1) & (BATCH_BOX_COUNT - 1);
+	}
+}
+
+static const int MASK_SIZE = 128;
+static const int MASK_OFFSET_COUNT = 64;
+
+// two of the player's 128x128 sprites, a round blob in a mostly transparent box,
+// at offsets where the boxes always overlap and the blobs touch about half of the time
+struct MaskPairs {
+	PixelMask mask;
+	std::vector<int> dx, dy;
+
+	MaskPairs() : mask(MASK_SIZE, MASK_SIZE) {
+		const int center = MASK_SIZE / 2, radius = MASK_SIZE / 3;
+		for (int y = 0; y < MASK_SIZE; ++y)
+			for (int x = 0; x < MASK_SIZE; ++x)
+				mask.set(x, y, (x - center) * (x - center) + (y - center) * (y - center) < radius * radius);
+
+		for (int i = 0; i < MASK_OFFSET_COUNT; ++i) {
+			dx.push_back(getRandom(-MASK_SIZE + 1, MASK_SIZE - 1));
+			dy.push_back(getRandom(-MASK_SIZE + 1, MASK_SIZE - 1));
+		}
+	}
+};
+
+XCUBE_BENCHMARK(PixelMask_overlap_scalar_128) {
+	MaskPairs pairs;
+	int i = 0;
+	while (state.keepRunning()) {
+		bool hit = overlapPixelMasksScalar(pairs.mask, pairs.mask, pairs.dx[i], pairs.dy[i]);
+		doNotOptimize(hit);
+		i = (i + 1) & (MASK_OFFSET_COUNT - 1);
+	}
+}
+
+XCUBE_BENCHMARK(PixelMask_overlap_simd_128) {
+	MaskPairs pairs;
+	int i = 0;
+	while (state.keepRunning()) {
+		bool hit = overlapPixelMasks(pairs.mask, pairs.mask, pairs.dx[i], pairs.dy[i]);
+		doNotOptimize(hit);
+		i = (i + 1) & (MASK_OFFSET_COUNT - 1);
+	}
+}
+
+// the same pairs pixel by pixel, what the word ANDs replace
+XCUBE_BENCHMARK(PixelMask_overlap_per_pixel_128) {
+	MaskPairs pairs;
+	int i = 0;
+	while (state.keepRunning()) {
+		bool hit = false;
+		for (int y = 0; y < MASK_SIZE && !hit; ++y)
+			for (int x = 0; x < MASK_SIZE && !hit; ++x)
+				hit = pairs.mask.get(x, y) && pairs.mask.get(x - pairs.dx[i], y - pairs.dy[i]);
+		doNotOptimize(hit);
+		i = (i + 1) & (MASK_OFFSET_COUNT - 1);
+	}
+}
+
+// what MyGame did per shot before the pool, a new projectile and body then the vector compacted
+XCUBE_BENCHMARK(Projectile_fire_kill_make_shared) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	std::vector<std::shared_ptr<Projectile>> projectiles;
+	while (state.keepRunning()) {
+		std::shared_ptr<Projectile> p = std::make_shared<Projectile>(Point2(400, 300), Vector2f(1, 0));
+		physics->registerObject(p->getPhysics());
+		projectiles.push_back(p);
+
+		p->kill();
+		physics->unregisterObject(p->getPhysics());
+		projectiles.erase(std::remove_if(projectiles.begin(), projectiles.end(),
+			[](const std::shared_ptr<Projectile> & q) { return !q->isAlive(); }), projectiles.end());
+	}
+}
+
+XCUBE_BENCHMARK(Projectile_fire_kill_pool) {
+	std::shared_ptr<PhysicsEngine> physics = getBenchEngine()->getPhysicsEngine();
+	ObjectPool<Projectile> projectiles(64);
+	while (state.keepRunning()) {
+		Projectile * p = projectiles.get(projectiles.acquire());
+		p->launch(Point2(400, 300), Vector2f(1, 0));
+		physics->registerObject(p->getPhysics());
+
+		p->kill();
+		projectiles.releaseIf([&physics](Projectile & q) {
+			if (q.isAlive())
+				return false;
+			physics->unregisterObject(q.getPhysics());
+			return true;
+		});
+	}
+}
@@ -0,0 +1,59 @@
+#include "Benchmark.h"
+#include "BenchEngine.h"
+
+XCUBE_BENCHMARK(ResourceManager_loadTexture) {
+	getBenchEngine();
+	while (state.keepRunning()) {
+		SDL_Texture * texture = ResourceManager::loadTexture("res/images/Circle_Red.png", SDL_COLOR_WHITE);
+		state.pauseTiming();
+		SDL_DestroyTexture(texture);	// loadTexture hands ownership to the caller
+		state.resumeTiming();
+	}
+}
+
+// the player's 128x128 sprite with its pixel mask, the mask's share is the difference to a plain load
+XCUBE_BENCHMARK(ResourceManager_loadTexture_pixelMask) {
+	getBenchEngine();
+	while (state.keepRunning()) {
+		SDL_Texture * texture = ResourceManager::loadTexture("res/images/fin_idle.png", SDL_COLOR_WHITE, true);
+		state.pauseTiming();
+		SDL_DestroyTexture(texture);
+		state.resumeTiming();
+	}
+}
+
+XCUBE_BENCHMARK(ResourceManager_loadSound) {
+	getBenchEngine();
+	// every load replaces the cached chunk, free the one it replaced so only the last stays cached,
+	// including the one cached by an earlier run of this benchmark
+	Mix_Chunk * previous = ResourceManager::getSound("res/sounds/beep.wav");
+	while (state.keepRunning()) {
+		Mix_Chunk * sound = ResourceManager::loadSound("res/sounds/beep.wav");
+		state.pauseTiming();
+		if (previous) Mix_FreeChunk(previous);
+		previous = sound;
+		state.resumeTiming();
+	}
+}
+
+XCUBE_BENCHMARK(ResourceManager_loadFont) {
+	getBenchEngine();
+	TTF_Font * previous = ResourceManager::getFont("res/fonts/arial.ttf");
+	while (state.keepRunning()) {
+		TTF_Font * font = ResourceManager::loadFont("res/fonts/arial.ttf", 24);
+		state.pauseTiming();
+		if (previous) TTF_CloseFont(previous);
+		previous = font;
+		state.resumeTiming();
+	}
+}
+
+XCUBE_BENCHMARK(ResourceManager_getSound) {
+	getBenchEngine();
+	if (!ResourceManager::getSound("res/sounds/beep.wav"))
+		ResourceManager::loadSound("res/sounds/beep.wav");
+	while (state.keepRunning()) {
+		Mix_Chunk * sound = ResourceManager::getSound("res/sounds/beep.wav");
+		doNotOptimize(sound);
+	}
+}
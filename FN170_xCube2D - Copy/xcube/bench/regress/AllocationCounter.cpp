@@ -0,0 +1,31 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocationCount(0);
+static std::atomic<size_t> allocatedBytes(0);
+
+size_t getAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+size_t getAllocatedBytes() {
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+static void * countedAlloc(size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+	void * p = malloc(size > 0 ? size : 1);
+	if (nullptr == p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void * operator new(size_t size) { return countedAlloc(size); }
+void * operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void * p) noexcept { free(p); }
+void operator delete[](void * p) noexcept { free(p); }
@@ -0,0 +1,13 @@
+#ifndef __ALLOCATION_COUNTER_H__
+#define __ALLOCATION_COUNTER_H__
+
+#include <cstddef>
+
+/**
+ * Counts calls to global operator new for the whole process
+ * (the replacement operators live in AllocationCounter.cpp)
+ */
+size_t getAllocationCount();
+size_t getAllocatedBytes();
+
+#endif
@@ -0,0 +1,90 @@
+#include "Baseline.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool Baseline::load(const std::string & fileName) {
+	std::ifstream file(fileName.c_str());
+	if (!file) {
+		std::cout << "Failed to open baseline " << fileName << std::endl;
+		return false;
+	}
+
+	metrics.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		++lineNumber;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream in(line);
+		std::string name, value, tolerance;
+		if (!(in >> name))
+			continue;	// blank line
+
+		if (!(in >> value >> tolerance)) {
+			std::cout << fileName << ":" << lineNumber << ": expected <name> <value|-> <tolerance>[%]" << std::endl;
+			return false;
+		}
+
+		BaselineMetric metric;
+		metric.name = name;
+		metric.hasValue = value != "-";
+		metric.value = metric.hasValue ? atof(value.c_str()) : 0.0;
+		metric.relative = tolerance[tolerance.size() - 1] == '%';
+		metric.tolerance = atof(tolerance.c_str());
+		metrics.push_back(metric);
+	}
+
+	return true;
+}
+
+bool Baseline::save(const std::string & fileName) {
+	FILE * file = fopen(fileName.c_str(), "w");
+	if (nullptr == file) {
+		std::cout << "Failed to open " << fileName << " for writing" << std::endl;
+		return false;
+	}
+
+	fprintf(file, "# xcube_regress baseline, regenerate with --update-baseline\n");
+	fprintf(file, "# <metric> <value|-> <tolerance>[%%]\n");
+	fprintf(file, "# timings are machine specific, record them on the machine that runs the check\n");
+	for (size_t i = 0; i < metrics.size(); ++i) {
+		const BaselineMetric & m = metrics[i];
+		if (m.hasValue)
+			fprintf(file, "%-22s %12.4f", m.name.c_str(), m.value);
+		else
+			fprintf(file, "%-22s %12s", m.name.c_str(), "-");
+		fprintf(file, " %g%s\n", m.tolerance, m.relative ? "%" : "");
+	}
+
+	fclose(file);
+	return true;
+}
+
+BaselineMetric * Baseline::find(const std::string & name) {
+	for (size_t i = 0; i < metrics.size(); ++i)
+		if (metrics[i].name == name)
+			return &metrics[i];
+	return nullptr;
+}
+
+void Baseline::set(const std::string & name, const double & value, const double & defaultTolerance) {
+	BaselineMetric * metric = find(name);
+	if (nullptr == metric) {
+		BaselineMetric m;
+		m.name = name;
+		m.tolerance = defaultTolerance;
+		metrics.push_back(m);
+		metric = &metrics.back();
+	}
+
+	metric->hasValue = true;
+	metric->value = value;
+}
@@ -0,0 +1,48 @@
+#ifndef __BASELINE_H__
+#define __BASELINE_H__
+
+#include <string>
+#include <vector>
+
+/**
+ * Checked in reference values for the regression harness
+ *
+ * Text format, one metric per line, '#' starts a comment:
+ *
+ *		<name> <value|-> <tolerance>[%]
+ *
+ * "-" means no reference has been recorded yet, the metric is reported but never fails.
+ * The tolerance is relative to the value when followed by '%', absolute otherwise.
+ * All metrics are "lower is better", a run fails when a value exceeds reference + tolerance
+ */
+struct BaselineMetric {
+	std::string name;
+	bool hasValue;
+	double value;
+	double tolerance;
+	bool relative;
+
+	BaselineMetric() : hasValue(false), value(0.0), tolerance(0.0), relative(true) {}
+
+	double getLimit() const { return value + (relative ? value * tolerance / 100.0 : tolerance); }
+};
+
+class Baseline {
+	private:
+		std::vector<BaselineMetric> metrics;
+	public:
+		bool load(const std::string & fileName);
+		bool save(const std::string & fileName);
+
+		/**
+		* @return the metric or nullptr if it is not in the baseline
+		*/
+		BaselineMetric * find(const std::string & name);
+
+		/**
+		* Adds the metric if missing, keeping an existing tolerance
+		*/
+		void set(const std::string & name, const double & value, const double & defaultTolerance);
+};
+
+#endif
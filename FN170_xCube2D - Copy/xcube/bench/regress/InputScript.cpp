@@ -0,0 +1,176 @@
+#include "InputScript.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// same order as the Key enum
+static const char * KEY_NAMES[Key::LAST] = {
+	"W", "S", "A", "D", "E", "F", "R", "ESC", "SPACE", "UP", "DOWN", "LEFT", "RIGHT", "QUIT", "F3"
+};
+
+static const char * BUTTON_NAMES[Mouse::BTN_LAST] = { "left", "right" };
+
+static int findName(const char ** names, const int & count, const std::string & name) {
+	for (int i = 0; i < count; ++i)
+		if (name == names[i])
+			return i;
+	return -1;
+}
+
+InputScript::InputScript() : cursor(0), endFrame(-1), lastMouse(-1, -1) {
+	for (int i = 0; i < Key::LAST; ++i) lastKeys[i] = false;
+	for (int i = 0; i < Mouse::BTN_LAST; ++i) lastButtons[i] = false;
+}
+
+bool InputScript::load(const std::string & fileName) {
+	std::ifstream file(fileName.c_str());
+	if (!file) {
+		std::cout << "Failed to open input script " << fileName << std::endl;
+		return false;
+	}
+
+	changes.clear();
+	cursor = 0;
+	endFrame = -1;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		++lineNumber;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream in(line);
+		Change change;
+		std::string type, arg;
+		if (!(in >> change.frame >> type))
+			continue;	// blank line
+
+		bool ok = true;
+		change.code = 0;
+		change.down = false;
+		if (type == "key" || type == "button") {
+			std::string state;
+			ok = (bool)(in >> arg >> state);
+			change.type = type == "key" ? Change::KEY : Change::BUTTON;
+			change.code = type == "key" ? findName(KEY_NAMES, Key::LAST, arg) : findName(BUTTON_NAMES, Mouse::BTN_LAST, arg);
+			change.down = state == "down";
+			ok = ok && change.code >= 0 && (state == "down" || state == "up");
+		}
+		else if (type == "mouse") {
+			change.type = Change::MOUSE;
+			ok = (bool)(in >> change.pos.x >> change.pos.y);
+		}
+		else if (type == "end") {
+			change.type = Change::END;
+			endFrame = change.frame;
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			std::cout << fileName << ":" << lineNumber << ": cannot parse \"" << line << "\"" << std::endl;
+			return false;
+		}
+
+		if (!changes.empty() && change.frame < changes.back().frame) {
+			std::cout << fileName << ":" << lineNumber << ": frames must not go backwards" << std::endl;
+			return false;
+		}
+
+		changes.push_back(change);
+	}
+
+	return true;
+}
+
+bool InputScript::save(const std::string & fileName) {
+	FILE * file = fopen(fileName.c_str(), "w");
+	if (nullptr == file) {
+		std::cout << "Failed to open " << fileName << " for writing" << std::endl;
+		return false;
+	}
+
+	fprintf(file, "# recorded by xcube_regress --record\n");
+	for (size_t i = 0; i < changes.size(); ++i) {
+		const Change & c = changes[i];
+		switch (c.type) {
+			case Change::KEY:		fprintf(file, "%d key %s %s\n", c.frame, KEY_NAMES[c.code], c.down ? "down" : "up"); break;
+			case Change::BUTTON:	fprintf(file, "%d button %s %s\n", c.frame, BUTTON_NAMES[c.code], c.down ? "down" : "up"); break;
+			case Change::MOUSE:		fprintf(file, "%d mouse %d %d\n", c.frame, c.pos.x, c.pos.y); break;
+			case Change::END:		fprintf(file, "%d end\n", c.frame); break;
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+void InputScript::apply(const int & frame, EventEngine * events) {
+	while (cursor < changes.size() && changes[cursor].frame <= frame) {
+		const Change & c = changes[cursor++];
+		switch (c.type) {
+			case Change::KEY:
+				if (c.down) events->setPressed((Key)c.code);
+				else events->setReleased((Key)c.code);
+				break;
+			case Change::BUTTON:
+				if (c.down) events->setPressed((Mouse)c.code);
+				else events->setReleased((Mouse)c.code);
+				break;
+			case Change::MOUSE:
+				events->setMousePos(c.pos);
+				break;
+			case Change::END:
+				break;
+		}
+	}
+}
+
+void InputScript::record(const int & frame, EventEngine * events) {
+	Change change;
+	change.frame = frame;
+
+	for (int i = 0; i < Key::LAST; ++i) {
+		bool down = events->isPressed((Key)i);
+		if (down != lastKeys[i]) {
+			change.type = Change::KEY;
+			change.code = i;
+			change.down = down;
+			changes.push_back(change);
+			lastKeys[i] = down;
+		}
+	}
+
+	for (int i = 0; i < Mouse::BTN_LAST; ++i) {
+		bool down = events->isPressed((Mouse)i);
+		if (down != lastButtons[i]) {
+			change.type = Change::BUTTON;
+			change.code = i;
+			change.down = down;
+			changes.push_back(change);
+			lastButtons[i] = down;
+		}
+	}
+
+	Point2 mouse = events->getMousePos();
+	if (mouse.x != lastMouse.x || mouse.y != lastMouse.y) {
+		change.type = Change::MOUSE;
+		change.pos = mouse;
+		changes.push_back(change);
+		lastMouse = mouse;
+	}
+
+	endFrame = frame + 1;
+}
+
+int InputScript::getEndFrame() {
+	if (endFrame >= 0)
+		return endFrame;
+	return changes.empty() ? 0 : changes.back().frame + 1;
+}
@@ -0,0 +1,63 @@
+#ifndef __INPUT_SCRIPT_H__
+#define __INPUT_SCRIPT_H__
+
+#include <string>
+#include <vector>
+
+#include "EventEngine.h"
+
+/**
+ * Frame stamped input changes, replayed into an EventEngine in emulated mode
+ *
+ * Text format, one change per line, '#' starts a comment:
+ *
+ *		<frame> key <W|S|A|D|E|F|R|ESC|SPACE|UP|DOWN|LEFT|RIGHT|QUIT|F3> <down|up>
+ *		<frame> button <left|right> <down|up>
+ *		<frame> mouse <x> <y>
+ *		<frame> end
+ *
+ * State persists between lines, i.e. a key stays down until its "up" line
+ */
+class InputScript {
+	private:
+		struct Change {
+			enum Type { KEY, BUTTON, MOUSE, END };
+
+			int frame;
+			Type type;
+			int code;
+			bool down;
+			Point2 pos;
+		};
+
+		std::vector<Change> changes;
+		size_t cursor;
+		int endFrame;
+
+		// last recorded state, only used by record()
+		bool lastKeys[Key::LAST];
+		bool lastButtons[Mouse::BTN_LAST];
+		Point2 lastMouse;
+	public:
+		InputScript();
+
+		bool load(const std::string & fileName);
+		bool save(const std::string & fileName);
+
+		/**
+		* Applies every change stamped with this frame, frames must be applied in order
+		*/
+		void apply(const int & frame, EventEngine * events);
+
+		/**
+		* Appends whatever changed since the previous call
+		*/
+		void record(const int & frame, EventEngine * events);
+
+		/**
+		* @return frame of the "end" line, or one past the last change
+		*/
+		int getEndFrame();
+};
+
+#endif
@@ -0,0 +1,216 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "MyGame.h"
+#include "Profiler.h"
+#include "RollingStats.h"
+#include "Timer.h"
+
+#include "AllocationCounter.h"
+#include "Baseline.h"
+#include "InputScript.h"
+
+static const int REGRESS_MAX_FRAMES = 8192;	// statistics window
+static const int REGRESS_WARMUP_FRAMES = 10;	// first frames load resources, replayed but not measured
+
+static const char * DEFAULT_INPUT_FILE = "bench/regress/replay_input.txt";
+static const char * DEFAULT_BASELINE_FILE = "bench/regress/baseline.txt";
+
+struct Metric {
+	std::string name;
+	double value;
+	double defaultTolerance;	// % used when the metric is new to the baseline
+};
+
+// large windows, kept out of the stack
+static RollingStats<REGRESS_MAX_FRAMES> frameStats, updateStats, physicsStats, renderStats;
+static RollingStats<REGRESS_MAX_FRAMES> allocStats, allocBytesStats, drawCallStats;
+
+static void printUsage() {
+	std::cout << "usage: xcube_regress [--input file] [--baseline file] [--seed n] [--windowed]" << std::endl;
+	std::cout << "                     [--update-baseline] [--record file] [--frames n]" << std::endl;
+	std::cout << "run from the directory containing res/ and bench/" << std::endl;
+}
+
+static void addMetric(std::vector<Metric> & metrics, const char * name, const double & value, const double & tolerance) {
+	Metric m;
+	m.name = name;
+	m.value = value;
+	m.defaultTolerance = tolerance;
+	metrics.push_back(m);
+}
+
+/**
+ * @return number of metrics over their limit
+ */
+static int report(Baseline & baseline, const std::vector<Metric> & metrics) {
+	int failures = 0;
+
+	printf("%-22s %12s %12s %12s %9s\n", "metric", "current", "baseline", "limit", "delta");
+	for (size_t i = 0; i < metrics.size(); ++i) {
+		const Metric & m = metrics[i];
+		const BaselineMetric * ref = baseline.find(m.name);
+
+		if (nullptr == ref || !ref->hasValue) {
+			printf("%-22s %12.4f %12s %12s %9s  (no baseline)\n", m.name.c_str(), m.value, "-", "-", "-");
+			continue;
+		}
+
+		double limit = ref->getLimit();
+		double delta = ref->value != 0.0 ? (m.value - ref->value) * 100.0 / ref->value : 0.0;
+		bool failed = m.value > limit;
+		if (failed)
+			++failures;
+
+		printf("%-22s %12.4f %12.4f %12.4f %+8.1f%%  %s\n", m.name.c_str(), m.value, ref->value, limit, delta, failed ? "FAIL" : "ok");
+	}
+
+	return failures;
+}
+
+int main(int argc, char * args[]) {
+	std::string inputFile = DEFAULT_INPUT_FILE;
+	std::string baselineFile = DEFAULT_BASELINE_FILE;
+	std::string recordFile;
+	unsigned int seed = 1234;
+	int maxFrames = -1;
+	bool headless = true;
+	bool updateBaseline = false;
+
+	for (int i = 1; i < argc; ++i) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(args[i], "--input") == 0 && hasValue) inputFile = args[++i];
+		else if (strcmp(args[i], "--baseline") == 0 && hasValue) baselineFile = args[++i];
+		else if (strcmp(args[i], "--record") == 0 && hasValue) recordFile = args[++i];
+		else if (strcmp(args[i], "--seed") == 0 && hasValue) seed = (unsigned int)atoi(args[++i]);
+		else if (strcmp(args[i], "--frames") == 0 && hasValue) maxFrames = atoi(args[++i]);
+		else if (strcmp(args[i], "--windowed") == 0) headless = false;
+		else if (strcmp(args[i], "--update-baseline") == 0) updateBaseline = true;
+		else {
+			printUsage();
+			return 2;
+		}
+	}
+
+	bool recording = !recordFile.empty();
+	if (recording)
+		headless = false;	// somebody has to play
+
+	InputScript script;
+	if (!recording && !script.load(inputFile))
+		return 2;
+
+	Baseline baseline;
+	if (!recording && !baseline.load(baselineFile))
+		return 2;
+
+	int endFrame = recording ? maxFrames : script.getEndFrame();
+	if (!recording && maxFrames >= 0 && maxFrames < endFrame)
+		endFrame = maxFrames;
+
+	if (headless) {
+		// must be set before the engine calls SDL_Init()
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	}
+
+	int frame = 0;
+	try {
+		MyGame game;
+		std::shared_ptr<XCube2Engine> engine = XCube2Engine::getInstance();
+		std::shared_ptr<GraphicsEngine> gfx = engine->getGraphicsEngine();
+		std::shared_ptr<EventEngine> events = engine->getEventEngine();
+
+		events->setEmulatedInput(!recording);
+		srand(seed);	// game spawns with rand(), seed after construction so nothing else consumes it
+
+		for (; game.isRunning() && (endFrame < 0 || frame < endFrame); ++frame) {
+			if (!recording)
+				script.apply(frame, events.get());
+
+			size_t allocsBefore = getAllocationCount();
+			size_t bytesBefore = getAllocatedBytes();
+
+			Profiler::beginFrame();
+			Timer frameTimer;
+			frameTimer.measure();
+			game.runFrame();
+			double frameMs = frameTimer.getElapsedMs();
+			Profiler::endFrame();
+
+			if (recording) {
+				script.record(frame, events.get());
+				gfx->adjustFPSDelay(16);
+			}
+
+			if (frame < REGRESS_WARMUP_FRAMES)
+				continue;
+
+			frameStats.add((float)frameMs);
+			updateStats.add(Profiler::getSectionMs(PROFILE_UPDATE));
+			physicsStats.add(Profiler::getSectionMs(PROFILE_PHYSICS));
+			renderStats.add(Profiler::getSectionMs(PROFILE_RENDER));
+			allocStats.add((float)(getAllocationCount() - allocsBefore));
+			allocBytesStats.add((float)(getAllocatedBytes() - bytesBefore));
+			drawCallStats.add((float)gfx->getLastDrawCallCount());
+		}
+
+		gfx.reset();
+		events.reset();
+		engine.reset();
+	} catch (EngineException & e) {
+		std::cout << e.what() << std::endl;
+		return 2;
+	}
+
+	if (recording) {
+		if (!script.save(recordFile))
+			return 2;
+		std::cout << "recorded " << frame << " frames to " << recordFile << std::endl;
+		return 0;
+	}
+
+	if (frameStats.getCount() == 0) {
+		std::cout << "no frames measured, the script is shorter than the warmup" << std::endl;
+		return 2;
+	}
+
+	std::vector<Metric> metrics;
+	const StatsSummary & fs = frameStats.getSummary();
+	addMetric(metrics, "frame_ms_mean", fs.mean, 25.0);
+	addMetric(metrics, "frame_ms_p50", fs.p50, 25.0);
+	addMetric(metrics, "frame_ms_p95", fs.p95, 25.0);
+	addMetric(metrics, "frame_ms_p99", fs.p99, 40.0);
+	addMetric(metrics, "update_ms_p95", updateStats.getP95(), 25.0);
+	addMetric(metrics, "physics_ms_p95", physicsStats.getP95(), 25.0);
+	addMetric(metrics, "render_ms_p95", renderStats.getP95(), 25.0);
+	addMetric(metrics, "allocs_per_frame_mean", allocStats.getMean(), 10.0);
+	addMetric(metrics, "allocs_per_frame_max", allocStats.getMax(), 10.0);
+	addMetric(metrics, "alloc_kb_per_frame", allocBytesStats.getMean() / 1024.0, 10.0);
+	addMetric(metrics, "draw_calls_mean", drawCallStats.getMean(), 5.0);
+	addMetric(metrics, "draw_calls_max", drawCallStats.getMax(), 5.0);
+
+	printf("xcube_regress: %d frames (%d measured), seed %u, %s\n", frame, frameStats.getCount(), seed, headless ? "headless" : "windowed");
+	int failures = report(baseline, metrics);
+
+	if (updateBaseline) {
+		for (size_t i = 0; i < metrics.size(); ++i)
+			baseline.set(metrics[i].name, metrics[i].value, metrics[i].defaultTolerance);
+		if (!baseline.save(baselineFile))
+			return 2;
+		std::cout << "baseline written to " << baselineFile << std::endl;
+		return 0;
+	}
+
+	if (failures > 0) {
+		std::cout << failures << " metric(s) regressed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "no regressions" << std::endl;
+	return 0;
+}
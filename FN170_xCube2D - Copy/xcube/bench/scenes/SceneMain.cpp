@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "StressScene.h"
+
+static const int SCENE_MAX_TICKS = 4096;	// statistics window, longer runs report the last ticks
+static const float SCENE_DT = 1.0f / 60.0f;
+
+struct SceneResult {
+	std::string name;
+	int ticks;
+	StatsSummary frame, update, render;
+};
+
+// large windows, kept out of the stack
+static RollingStats<SCENE_MAX_TICKS> frameStats, updateStats, renderStats;
+
+static void printUsage() {
+	std::cout << "usage: xcube_scenes [--scene name] [--ticks n] [--seed n] [--headless] [--json file]" << std::endl;
+	std::cout << "run from the directory containing res/" << std::endl;
+}
+
+static void printSummary(const char * what, const StatsSummary & s) {
+	printf("  %-7s mean %8.3f  p50 %8.3f  p95 %8.3f  p99 %8.3f  max %8.3f ms\n", what, s.mean, s.p50, s.p95, s.p99, s.max);
+}
+
+static void writeSummary(FILE * file, const char * what, const StatsSummary & s, bool last) {
+	fprintf(file, "\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s",
+		what, s.mean, s.p50, s.p95, s.p99, s.max, last ? "" : ", ");
+}
+
+static bool writeJSON(const std::string & fileName, const std::vector<SceneResult> & results, bool headless) {
+	FILE * file = fopen(fileName.c_str(), "w");
+	if (nullptr == file) {
+		std::cout << "Failed to open " << fileName << " for writing" << std::endl;
+		return false;
+	}
+
+	fprintf(file, "{\n  \"suite\": \"xcube_scenes\",\n  \"headless\": %s,\n  \"scenes\": [\n", headless ? "true" : "false");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const SceneResult & r = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"ticks\": %d, ", r.name.c_str(), r.ticks);
+		writeSummary(file, "frame_ms", r.frame, false);
+		writeSummary(file, "update_ms", r.update, false);
+		writeSummary(file, "render_ms", r.render, true);
+		fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char * args[]) {
+	std::string only, jsonFile;
+	int ticks = 600;
+	unsigned int seed = 1;
+	bool headless = false;
+
+	for (int i = 1; i < argc; ++i) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(args[i], "--scene") == 0 && hasValue) only = args[++i];
+		else if (strcmp(args[i], "--ticks") == 0 && hasValue) ticks = atoi(args[++i]);
+		else if (strcmp(args[i], "--seed") == 0 && hasValue) seed = (unsigned int)atoi(args[++i]);
+		else if (strcmp(args[i], "--json") == 0 && hasValue) jsonFile = args[++i];
+		else if (strcmp(args[i], "--headless") == 0) headless = true;
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (headless) {
+		// must be set before the engine calls SDL_Init()
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	}
+
+	std::vector<SceneResult> results;
+	try {
+		std::shared_ptr<XCube2Engine> engine = XCube2Engine::getInstance();
+		std::shared_ptr<GraphicsEngine> gfx = engine->getGraphicsEngine();
+		std::shared_ptr<EventEngine> events = engine->getEventEngine();
+
+		std::vector<std::shared_ptr<StressScene>> scenes = createStressScenes();
+		for (size_t s = 0; s < scenes.size(); ++s) {
+			std::shared_ptr<StressScene> scene = scenes[s];
+			if (!only.empty() && only != scene->getName())
+				continue;
+
+			srand(seed);	// same spawn layout every run
+			scene->setup(engine);
+
+			frameStats.clear();
+			updateStats.clear();
+			renderStats.clear();
+
+			Timer frameTimer, sectionTimer;
+			int tick = 0;
+			for (; tick < ticks; ++tick) {
+				frameTimer.measure();
+				events->pollEvents();
+				if (events->isPressed(Key::QUIT) || events->isPressed(Key::ESC))
+					break;
+
+				sectionTimer.measure();
+				scene->update(SCENE_DT);
+				updateStats.add((float)sectionTimer.getElapsedMs());
+
+				sectionTimer.measure();
+				gfx->clearScreen();
+				scene->render(gfx.get());
+				gfx->showScreen();
+				renderStats.add((float)sectionTimer.getElapsedMs());
+
+				frameStats.add((float)frameTimer.getElapsedMs());
+			}
+
+			scene->teardown();
+
+			SceneResult result;
+			result.name = scene->getName();
+			result.ticks = tick;
+			result.frame = frameStats.getSummary();
+			result.update = updateStats.getSummary();
+			result.render = renderStats.getSummary();
+			results.push_back(result);
+
+			printf("%s (%d ticks)\n", result.name.c_str(), tick);
+			printSummary("frame", result.frame);
+			printSummary("update", result.update);
+			printSummary("render", result.render);
+			fflush(stdout);
+
+			if (tick < ticks)
+				break;	// user closed the window
+		}
+
+		engine.reset();
+		gfx.reset();
+		events.reset();
+		XCube2Engine::quit();
+	} catch (EngineException & e) {
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	if (!jsonFile.empty() && !writeJSON(jsonFile, results, headless))
+		return 1;
+
+	return 0;
+}
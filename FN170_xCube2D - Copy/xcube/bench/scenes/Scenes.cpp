@@ -0,0 +1,338 @@
+#include "StressScene.h"
+#include "EnemyEntity.h"
+#include "Projectile.h"
+#include "ObjectPool.h"
+#include "Crowd.h"
+#include "EnemySwarm.h"
+
+#include <cstdio>
+
+static const int SCENE_WIDTH = DEFAULT_WINDOW_WIDTH;
+static const int SCENE_HEIGHT = DEFAULT_WINDOW_HEIGHT;
+
+/* SPRITES - 10k textured quads bouncing around, using the shape images */
+
+class SpriteScene : public StressScene {
+	private:
+		struct Sprite {
+			SDL_Texture * texture;
+			float x, y, vx, vy;
+			SDL_Rect dest;
+		};
+
+		std::vector<SDL_Texture *> textures;
+		std::vector<Sprite> sprites;
+	public:
+		const char * getName() override { return "sprites_10k"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+
+			const char * shapes[] = { "Circle", "Square", "Square_Cross", "Star", "Triangle", "Pawn" };
+			const char * colors[] = { "Blue", "Green", "Grey", "Red", "Yellow" };
+			for (int s = 0; s < 6; ++s) {
+				for (int c = 0; c < 5; ++c) {
+					std::string file = std::string("res/images/") + shapes[s] + "_" + colors[c] + ".png";
+					textures.push_back(ResourceManager::loadTexture(file, SDL_COLOR_WHITE));
+				}
+			}
+
+			sprites.resize(10000);
+			for (size_t i = 0; i < sprites.size(); ++i) {
+				Sprite & sp = sprites[i];
+				sp.texture = textures[i % textures.size()];
+				sp.x = (float)getRandom(0, SCENE_WIDTH - 32);
+				sp.y = (float)getRandom(0, SCENE_HEIGHT - 32);
+				sp.vx = (float)getRandom(-120, 120);
+				sp.vy = (float)getRandom(-120, 120);
+				sp.dest = { (int)sp.x, (int)sp.y, 32, 32 };
+			}
+		}
+
+		void update(const float & dt) override {
+			for (size_t i = 0; i < sprites.size(); ++i) {
+				Sprite & sp = sprites[i];
+				sp.x += sp.vx * dt;
+				sp.y += sp.vy * dt;
+				if (sp.x < 0 || sp.x > SCENE_WIDTH - 32) sp.vx = -sp.vx;
+				if (sp.y < 0 || sp.y > SCENE_HEIGHT - 32) sp.vy = -sp.vy;
+				sp.dest.x = (int)sp.x;
+				sp.dest.y = (int)sp.y;
+			}
+		}
+
+		void render(GraphicsEngine * gfx) override {
+			for (size_t i = 0; i < sprites.size(); ++i)
+				gfx->drawTexture(sprites[i].texture, &sprites[i].dest);
+		}
+
+		void teardown() override {
+			// loadTexture does not cache, the scene owns these
+			for (size_t i = 0; i < textures.size(); ++i)
+				SDL_DestroyTexture(textures[i]);
+			textures.clear();
+			sprites.clear();
+		}
+};
+
+/* PROJECTILES - 50k demo projectiles from a pool, relaunched when they leave the screen */
+
+class ProjectileScene : public StressScene {
+	private:
+		std::unique_ptr<ObjectPool<Projectile>> projectiles;
+
+		static void launch(Projectile & p) {
+			Point2 start(getRandom(0, SCENE_WIDTH), getRandom(0, SCENE_HEIGHT));
+			Vector2f dir((float)getRandom(-100, 100), (float)getRandom(-100, 100));
+			p.launch(start, dir);
+		}
+	public:
+		const char * getName() override { return "projectiles_50k"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+			projectiles.reset(new ObjectPool<Projectile>(50000));
+			for (int i = 0; i < 50000; ++i)
+				launch(*projectiles->get(projectiles->acquire()));
+		}
+
+		void update(const float & dt) override {
+			projectiles->forEach([dt](Projectile & p) {
+				p.update(dt);
+				if (!p.isAlive())
+					launch(p);
+			});
+		}
+
+		void render(GraphicsEngine * gfx) override {
+			projectiles->forEach([gfx](Projectile & p) { p.render(gfx); });
+		}
+
+		void teardown() override {
+			projectiles.reset();
+		}
+};
+
+/* ENEMIES - 1k enemies chasing a moving player, tested for collision like MyGame */
+
+class EnemyScene : public StressScene {
+	private:
+		SDL_Texture * enemyTexture;
+		std::vector<std::shared_ptr<EnemyEntity>> enemies;
+		std::shared_ptr<PhysicsObject> player;
+		Point2 playerPos;
+		float time;
+		int hits;
+	public:
+		EnemyScene() : enemyTexture(nullptr), time(0.0f), hits(0) {}
+
+		const char * getName() override { return "enemies_1k_chase"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+			enemyTexture = ResourceManager::loadTexture("res/images/Circle_Red.png", SDL_COLOR_WHITE);
+
+			player = std::make_shared<PhysicsObject>(Point2(SCENE_WIDTH / 2, SCENE_HEIGHT / 2), 128.0f, 128.0f);
+			for (int i = 0; i < 1000; ++i) {
+				std::shared_ptr<EnemyEntity> enemy = std::make_shared<EnemyEntity>();
+				enemy->setTexture(enemyTexture);
+				enemy->setPosition(Point2(getRandom(0, SCENE_WIDTH), getRandom(0, SCENE_HEIGHT)));
+				enemies.push_back(enemy);
+			}
+		}
+
+		void update(const float & dt) override {
+			// player circles the screen centre so enemies keep steering
+			time += dt;
+			playerPos = Point2(SCENE_WIDTH / 2 + (int)(200 * cos(time)), SCENE_HEIGHT / 2 + (int)(150 * sin(time)));
+			player->setCenter(playerPos);
+
+			for (size_t i = 0; i < enemies.size(); ++i) {
+				enemies[i]->update(dt, playerPos);
+				if (enemies[i]->getPhysics()->isColliding(*player))
+					++hits;
+			}
+		}
+
+		void render(GraphicsEngine * gfx) override {
+			for (size_t i = 0; i < enemies.size(); ++i)
+				enemies[i]->render(gfx);
+
+			gfx->setDrawColor(SDL_COLOR_GREEN);
+			gfx->drawRect(playerPos.x - 64, playerPos.y - 64, 128, 128);
+		}
+
+		void teardown() override {
+			enemies.clear();
+			player.reset();
+			SDL_DestroyTexture(enemyTexture);
+			enemyTexture = nullptr;
+		}
+};
+
+/* SWARM - 50k point enemies steered together towards a moving player */
+
+class SwarmScene : public StressScene {
+	private:
+		EnemySwarm swarm;
+		Vector2f playerPos;
+		float time;
+	public:
+		SwarmScene() : time(0.0f) {}
+
+		const char * getName() override { return "swarm_50k"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+			swarm.reserve(50000);
+			for (int i = 0; i < 50000; ++i)
+				swarm.add(Vector2f((float)getRandom(0, SCENE_WIDTH), (float)getRandom(0, SCENE_HEIGHT)));
+			swarm.setThreadCount(0);
+		}
+
+		void update(const float & dt) override {
+			time += dt;
+			playerPos = Vector2f(SCENE_WIDTH / 2 + 200 * cos(time), SCENE_HEIGHT / 2 + 150 * sin(time));
+			swarm.update(playerPos, dt);
+		}
+
+		void render(GraphicsEngine * gfx) override {
+			gfx->setDrawColor(SDL_COLOR_RED);
+			for (int i = 0; i < swarm.getCount(); ++i)
+				gfx->drawPoint(Point2((int)swarm.getPositionsX()[i], (int)swarm.getPositionsY()[i]));
+
+			gfx->setDrawColor(SDL_COLOR_GREEN);
+			gfx->drawRect((int)playerPos.x - 64, (int)playerPos.y - 64, 128, 128);
+		}
+
+		void teardown() override {
+			swarm.clear();
+			swarm.setThreadCount(1);
+		}
+};
+
+/* CROWD - 5k point enemies chasing the player while keeping apart from each other */
+
+class CrowdScene : public StressScene {
+	private:
+		EnemySwarm swarm;
+		Crowd crowd;
+		Vector2f playerPos;
+		float time;
+	public:
+		CrowdScene() : time(0.0f) {}
+
+		const char * getName() override { return "crowd_5k"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+			swarm.reserve(5000);
+			for (int i = 0; i < 5000; ++i)
+				swarm.add(Vector2f((float)getRandom(0, SCENE_WIDTH), (float)getRandom(0, SCENE_HEIGHT)));
+			swarm.setThreadCount(0);
+			crowd.setThreadCount(0);
+		}
+
+		void update(const float & dt) override {
+			time += dt;
+			playerPos = Vector2f(SCENE_WIDTH / 2 + 200 * cos(time), SCENE_HEIGHT / 2 + 150 * sin(time));
+			crowd.update(swarm.getPositionsX(), swarm.getPositionsY(), swarm.getVelocitiesX(), swarm.getVelocitiesY(), swarm.getCount());
+			swarm.applyForces(crowd.getForcesX(), crowd.getForcesY(), dt);
+			swarm.update(playerPos, dt);
+		}
+
+		void render(GraphicsEngine * gfx) override {
+			gfx->setDrawColor(SDL_COLOR_RED);
+			for (int i = 0; i < swarm.getCount(); ++i)
+				gfx->drawPoint(Point2((int)swarm.getPositionsX()[i], (int)swarm.getPositionsY()[i]));
+
+			gfx->setDrawColor(SDL_COLOR_GREEN);
+			gfx->drawRect((int)playerPos.x - 64, (int)playerPos.y - 64, 128, 128);
+		}
+
+		void teardown() override {
+			swarm.clear();
+			swarm.setThreadCount(1);
+			crowd.setThreadCount(1);
+		}
+};
+
+/* TEXT - 500 labels whose contents change every tick */
+
+class TextScene : public StressScene {
+	private:
+		int tick;
+	public:
+		TextScene() : tick(0) {}
+
+		const char * getName() override { return "text_500_labels"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+			e->getGraphicsEngine()->useFont(ResourceManager::loadFont("res/fonts/arial.ttf", 16));
+		}
+
+		void update(const float &) override {
+			++tick;
+		}
+
+		void render(GraphicsEngine * gfx) override {
+			char label[32];
+			gfx->setDrawColor(SDL_COLOR_WHITE);
+			for (int i = 0; i < 500; ++i) {
+				snprintf(label, sizeof(label), "Score %d", tick * 7 + i);
+				gfx->drawText(label, (i % 10) * 80, (i / 10) * 12);
+			}
+		}
+};
+
+/* AUDIO - bursts of concurrent triggers through the layered audio system */
+
+class AudioScene : public StressScene {
+	private:
+		std::shared_ptr<MyEngineSystem> audio;
+		std::vector<std::string> sounds;
+		int tick;
+	public:
+		AudioScene() : tick(0) {}
+
+		const char * getName() override { return "audio_triggers"; }
+
+		void setup(std::shared_ptr<XCube2Engine> e) override {
+			StressScene::setup(e);
+			audio = e->getMyEngineSystem();
+
+			const char * files[] = { "res/sounds/beep.wav", "res/sounds/collect.wav", "res/sounds/hurt.wav", "res/sounds/shoot.wav" };
+			for (int i = 0; i < 4; ++i) {
+				ResourceManager::loadSound(files[i]);
+				sounds.push_back(files[i]);
+			}
+		}
+
+		void update(const float &) override {
+			// 32 triggers per tick spread over the default layers, like a busy firefight
+			const char * layers[] = { "sfx", "ui", "foley", "sfx" };
+			for (int i = 0; i < 32; ++i)
+				audio->Play(layers[i % 4], sounds[(tick + i) % sounds.size()]);
+			++tick;
+		}
+
+		void render(GraphicsEngine *) override {}
+
+		void teardown() override {
+			audio->StopAll();
+			audio.reset();
+		}
+};
+
+std::vector<std::shared_ptr<StressScene>> createStressScenes() {
+	std::vector<std::shared_ptr<StressScene>> scenes;
+	scenes.push_back(std::make_shared<SpriteScene>());
+	scenes.push_back(std::make_shared<ProjectileScene>());
+	scenes.push_back(std::make_shared<EnemyScene>());
+	scenes.push_back(std::make_shared<SwarmScene>());
+	scenes.push_back(std::make_shared<CrowdScene>());
+	scenes.push_back(std::make_shared<TextScene>());
+	scenes.push_back(std::make_shared<AudioScene>());
+	return scenes;
+}
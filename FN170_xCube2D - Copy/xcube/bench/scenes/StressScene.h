@@ -0,0 +1,38 @@
+#ifndef __STRESS_SCENE_H__
+#define __STRESS_SCENE_H__
+
+#include <memory>
+#include <vector>
+
+#include "XCube2d.h"
+
+/**
+ * A canned load scenario, run for a fixed number of ticks by xcube_scenes
+ *
+ * Scenes go through the same engine code paths the demo game uses
+ * (entities, PhysicsObject, drawText, MyEngineSystem) so the load profile
+ * is close to a real frame, just scaled up
+ */
+class StressScene {
+	protected:
+		std::shared_ptr<XCube2Engine> engine;
+	public:
+		virtual ~StressScene() {}
+
+		virtual const char * getName() = 0;
+
+		/**
+		* Allocate and load everything here, setup is not timed
+		*/
+		virtual void setup(std::shared_ptr<XCube2Engine> e) { engine = e; }
+		virtual void update(const float & dt) = 0;
+		virtual void render(GraphicsEngine * gfx) = 0;
+		virtual void teardown() {}
+};
+
+/**
+ * Scene factories, defined in Scenes.cpp
+ */
+std::vector<std::shared_ptr<StressScene>> createStressScenes();
+
+#endif
@@ -8,7 +8,13 @@ int main(int argc, char * args[]) {
 	} catch (EngineException & e) {
 		std::cout << e.what() << std::endl;
 		getchar();
+		return 0;
 	}
 
+#ifdef __DEBUG
+	debug("The game finished and cleaned up successfully. Press Enter to exit");
+	getchar();
+#endif
+
 	return 0;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../engine/Projectile.h"
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 //constructor
 MyGame::MyGame() : AbstractGame()
@@ -21,8 +22,8 @@ void MyGame::initGame()
 	//load textures
     bgTex = ResourceManager::loadTexture("res/images/bg.png", SDL_COLOR_GRAY);
 
-	//load player (FSM) and enemy textures
-    SDL_Texture* pIdle = ResourceManager::loadTexture("res/images/fin_idle.png", SDL_COLOR_WHITE);
+	//load player (FSM) and enemy textures, the idle sprite also gives the player's pixel mask
+    SDL_Texture* pIdle = ResourceManager::loadTexture("res/images/fin_idle.png", SDL_COLOR_WHITE, true);
     SDL_Texture* pDmg = ResourceManager::loadTexture("res/images/fin_damaged.png", SDL_COLOR_WHITE);
     SDL_Texture* pSht = ResourceManager::loadTexture("res/images/fin_shoot.png", SDL_COLOR_WHITE);
     SDL_Texture* eTex = ResourceManager::loadTexture("res/images/Circle_Red.png", SDL_COLOR_WHITE);
@@ -59,7 +60,12 @@ void MyGame::initGame()
 	//setup player rectangles
     restartGame();
 
-	//register physics objects
+	//register physics objects, tagged so contacts can be mapped back to entities
+    player.getPhysics()->setUserData(&player, BODY_PLAYER);
+    enemy.getPhysics()->setUserData(&enemy, BODY_ENEMY);
+    player.getPhysics()->setCollisionFilter(LAYER_PLAYER, LAYER_ENEMY | LAYER_KEY); //player projectiles never touch the player
+    player.getPhysics()->setPixelMask(ResourceManager::getPixelMask("res/images/fin_idle.png")); //most of the 128x128 box is transparent
+    enemy.getPhysics()->setCollisionFilter(LAYER_ENEMY, LAYER_PLAYER | LAYER_PROJECTILE);
     physics->registerObject(player.getPhysics());
     physics->registerObject(enemy.getPhysics());
 
@@ -83,11 +89,17 @@ void MyGame::restartGame()
     currentScene = SceneState::MENU;
 
 	//reset respawn timer and collision state
+    for (auto& k : gameKeys) physics->unregisterObject(k->physics);
     gameKeys.clear();
     for (int i = 0; i < 5; i++) {
 		//spawn collectibles at random positions
         Point2 randomPos(rand() % 700 + 50, rand() % 500 + 50);
-        gameKeys.push_back(std::make_shared<GameKey>(randomPos));
+        auto key = std::make_shared<GameKey>(randomPos);
+        key->physics->setUserData(key.get(), BODY_KEY);
+        key->physics->setCollisionFilter(LAYER_KEY, LAYER_PLAYER); //only the player picks keys up
+        key->physics->setMotionType(MOTION_STATIC); //keys never move, they stay out of the per tick broadphase
+        physics->registerObject(key->physics);
+        gameKeys.push_back(key);
     }
 }
 
@@ -127,10 +139,17 @@ void MyGame::updateGame()
 
 	respawnTimer += 0.016f; //increment respawn timer for enemy and collectibles
 
-	bool isColliding = player.getPhysics()->isColliding(*enemy.getPhysics()); //check collision between player and enemy
+	//contacts come from the physics broadphase run at the end of the previous frame
+	//so only a new player/enemy touch (enter event) deals damage
+	bool enemyTouchStarted = false;
+	for (const ContactEvent& e : physics->getContactEvents())
+	{
+		if (e.type == CONTACT_ENTER && e.getOther(player.getPhysics().get()) == enemy.getPhysics().get())
+			enemyTouchStarted = true;
+	}
 
     //collision enter logic for player damage
-    if (isColliding && !wasCollidingWithEnemy)
+    if (enemyTouchStarted)
     {
 		if (enemy.isAlive()) //only apply damage if enemy is alive
         {
@@ -147,7 +166,6 @@ void MyGame::updateGame()
             }
         }
     }
-	wasCollidingWithEnemy = isColliding; //update collision state for next frame
 
     //spawn projectile with offset to avoid self collision
     if (eventSystem->isPressed(Mouse::BTN_LEFT) && player.canShoot())
@@ -163,42 +181,54 @@ void MyGame::updateGame()
         //offset spawn point by 50 units to clear player hitbox
         Point2 fireOrigin{ (int)(center.x + unitDir.x * 50.0f), (int)(center.y + unitDir.y * 50.0f) };
 
-		//create and add new projectile to the list using shared pointer for memory management
-        projectiles.push_back(std::make_shared<Projectile>(fireOrigin, unitDir));
-
-		//play shooting sound and update player state
-        mySystem->Play("sfx", "res/sounds/shoot.wav");
-		//request shooting state change
-        player.onShoot();
+		//take a projectile from the pool, skip the shot if every one is in flight
+        Projectile* projectile = projectiles.get(projectiles.acquire());
+        if (projectile)
+        {
+            projectile->launch(fireOrigin, unitDir);
+            projectile->getPhysics()->setUserData(projectile, BODY_PROJECTILE);
+            projectile->getPhysics()->setCollisionFilter(LAYER_PROJECTILE, LAYER_ENEMY);
+            physics->registerObject(projectile->getPhysics());
+
+            //play shooting sound and update player state
+            mySystem->Play("sfx", "res/sounds/shoot.wav");
+            //request shooting state change
+            player.onShoot();
+        }
     }
 
-    //collectible pickup detection
-    for (auto& k : gameKeys)
+    //collectible pickup detection from the player's contacts
+    contactScratch.clear();
+    physics->getContacts(player.getPhysics().get(), contactScratch);
+    for (PhysicsObject* other : contactScratch)
     {
+		//only collectibles are picked up
+        if (other->getUserType() != BODY_KEY) continue;
+        GameKey* k = static_cast<GameKey*>(other->getUserData());
+
 		//skip if collectible is not alive
         if (!k->isAlive) continue;
 
-		//check collision between player and collectible
-        if (player.getPhysics()->isColliding(*k->physics))
-        {
-			//collect the key
-            k->isAlive = false;
-			//increase score and play sounds
-            score += 100;
-            mySystem->Play("sfx", "res/sounds/beep.wav");
-            mySystem->Play("sfx", "res/sounds/collect.wav");
-        }
+		//collect the key
+        k->isAlive = false;
+		//increase score and play sounds
+        score += 100;
+        mySystem->Play("sfx", "res/sounds/beep.wav");
+        mySystem->Play("sfx", "res/sounds/collect.wav");
     }
 
-    //projectile movement and enemy collision
-    for (auto& p : projectiles) {
+    //projectile hits from the enemy's contacts, layers keep them off the player
+    contactScratch.clear();
+    physics->getContacts(enemy.getPhysics().get(), contactScratch);
+    for (PhysicsObject* other : contactScratch) {
+		//only projectiles damage the enemy
+        if (other->getUserType() != BODY_PROJECTILE) continue;
+        Projectile* p = static_cast<Projectile*>(other->getUserData());
+
 		//skip dead projectiles
         if (!p->isAlive()) continue;
-		//update projectile position
-        p->update(0.016f);
 
-		//check collision with enemy because player projectiles don't hit player
-        if (enemy.isAlive() && p->getPhysics()->isColliding(*enemy.getPhysics())) {
+        if (enemy.isAlive()) {
 			//apply damage to enemy
             if (enemy.getDamage().applyDamage()) {
 				//also increase score on hit
@@ -213,12 +243,20 @@ void MyGame::updateGame()
         }
     }
 
-    //remove dead projectile entities
-    projectiles.erase(
-        std::remove_if(projectiles.begin(), projectiles.end(),
-            [](const std::shared_ptr<Projectile>& p) { return !p->isAlive(); }),
-        projectiles.end()
-    );
+    //projectile movement
+    projectiles.forEach([](Projectile& p) {
+		//skip dead projectiles
+        if (!p.isAlive()) return;
+		//update projectile position
+        p.update(0.016f);
+    });
+
+    //return dead projectiles to the pool, their bodies leave the physics engine until the next shot
+    projectiles.releaseIf([this](Projectile& p) {
+        if (p.isAlive()) return false;
+        physics->unregisterObject(p.getPhysics());
+        return true;
+    });
 
     //enemy respawn timer check
 	if (!enemy.isAlive() && respawnTimer >= RESPAWN_DELAY) //respawn enemy after RESPAWN_DELAY
@@ -245,6 +283,11 @@ void MyGame::updateGame()
 	//reset timer if everything is alive
     if (allAlive) respawnTimer = 0.0f;
 
+	//report live entity count to the engine overlay (player + enemy + projectiles + keys)
+	int entityCount = 1 + (enemy.isAlive() ? 1 : 0) + projectiles.getCount();
+	for (auto& k : gameKeys) if (k->isAlive) entityCount++;
+	overlay->setEntityCount(entityCount);
+
 	//win condition check
     if (score >= 3000)
     {
@@ -260,8 +303,8 @@ void MyGame::render()
 	//safety check for initialisation
     if (!initialised) return;
 
-	//clear screen before rendering because double buffering
-    gfx->clearScreen();
+	//screen is cleared and presented by the engine main loop
+	//so engine overlays (F3) can draw on top of the scene
 
 	//scene rendering with different UI elements
     if (currentScene == SceneState::MENU)
@@ -288,11 +331,9 @@ void MyGame::render()
         if (enemy.isAlive()) enemy.render(gfx.get());
 
         gfx->setDrawColor(SDL_COLOR_WHITE);
-        for (auto& p : projectiles)
-        {
-            if (!p->isAlive()) continue;
-            p->render(gfx.get());
-        }
+        projectiles.forEach([this](Projectile& p) {
+            if (p.isAlive()) p.render(gfx.get());
+        });
 
         gfx->setDrawColor(SDL_COLOR_WHITE);
         gfx->drawText("Score: " + std::to_string(score), 20, 20);
@@ -319,10 +360,6 @@ void MyGame::render()
 
     //render debug overlays on top of scene
     renderAudioDebug();
-
-
-	//present rendered frame to screen
-    gfx->showScreen();
 }
 
 //input event dispatcher
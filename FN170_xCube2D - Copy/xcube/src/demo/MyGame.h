@@ -6,6 +6,8 @@
 #include "../engine/PlayerEntity.h"
 #include "../engine/EnemyEntity.h"
 #include "../engine/PhysicsEngine.h"
+#include "../engine/ObjectPool.h"
+#include "../engine/Projectile.h"
 #include <vector>
 #include <memory>
 #include <SDL_ttf.h>
@@ -20,11 +22,10 @@ struct GameKey
         : physics(std::make_shared<PhysicsObject>(p, 20.0f, 20.0f)),
         isAlive(true)
     {
+        physics->setShape(CollisionShape::circle(10.0f)); //round pickup radius
     }
 };
 
-class Projectile; //forward declaration to avoid circular include
-
 class MyGame : public AbstractGame
 {
 private:
@@ -47,11 +48,29 @@ private:
     PlayerEntity player;
     EnemyEntity enemy;
 
+    //physics body tags for mapping contacts back to entities
+    enum BodyType
+    {
+        BODY_PLAYER,
+        BODY_ENEMY,
+        BODY_KEY,
+        BODY_PROJECTILE
+    };
+
+    //collision layers, the broadphase drops pairs that can't interact before testing them
+    enum CollisionLayer : Uint32
+    {
+        LAYER_PLAYER = 1 << 0,
+        LAYER_ENEMY = 1 << 1,
+        LAYER_KEY = 1 << 2,
+        LAYER_PROJECTILE = 1 << 3
+    };
+
     //collision state tracking
-    bool wasCollidingWithEnemy = false;
+    std::vector<PhysicsObject*> contactScratch; //reused contact query buffer
 
-    //active projectile pool
-    std::vector<std::shared_ptr<Projectile>> projectiles;
+    //projectile pool, bodies are made once and reused so shooting never allocates
+    ObjectPool<Projectile> projectiles{ 64 }; //shots in flight at once, the shoot cooldown keeps it far lower
 
     //gameplay state data
     DamageSystem damage;
@@ -0,0 +1,120 @@
+#include "AABBBatch.h"
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define XCUBE_AABB_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define XCUBE_AABB_SSE
+#endif
+
+static inline bool overlapOne(float minX, float minY, float maxX, float maxY, const AABBArrays & b, int i) {
+	return b.minX[i] < maxX && minX < b.maxX[i] && b.minY[i] < maxY && minY < b.maxY[i];
+}
+
+int overlapAABBBatchScalar(float minX, float minY, float maxX, float maxY, const AABBArrays & boxes, int first, int count, int * hits) {
+	int found = 0;
+	const int end = first + count;
+	for (int i = first; i < end; ++i)
+		if (overlapOne(minX, minY, maxX, maxY, boxes, i))
+			hits[found++] = i;
+	return found;
+}
+
+int overlapAABBBatch(float minX, float minY, float maxX, float maxY, const AABBArrays & boxes, int first, int count, int * hits) {
+	int found = 0;
+	int i = first;
+	const int end = first + count;
+
+#if defined(XCUBE_AABB_AVX)
+	const __m256 qMinX = _mm256_set1_ps(minX), qMinY = _mm256_set1_ps(minY);
+	const __m256 qMaxX = _mm256_set1_ps(maxX), qMaxY = _mm256_set1_ps(maxY);
+
+	for (; i + 8 <= end; i += 8) {
+		__m256 x = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(boxes.minX + i), qMaxX, _CMP_LT_OQ),
+			_mm256_cmp_ps(qMinX, _mm256_loadu_ps(boxes.maxX + i), _CMP_LT_OQ));
+		__m256 y = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(boxes.minY + i), qMaxY, _CMP_LT_OQ),
+			_mm256_cmp_ps(qMinY, _mm256_loadu_ps(boxes.maxY + i), _CMP_LT_OQ));
+
+		int mask = _mm256_movemask_ps(_mm256_and_ps(x, y));
+		for (int bit = 0; mask != 0; ++bit, mask >>= 1)
+			if (mask & 1)
+				hits[found++] = i + bit;
+	}
+#elif defined(XCUBE_AABB_SSE)
+	const __m128 qMinX = _mm_set1_ps(minX), qMinY = _mm_set1_ps(minY);
+	const __m128 qMaxX = _mm_set1_ps(maxX), qMaxY = _mm_set1_ps(maxY);
+
+	for (; i + 4 <= end; i += 4) {
+		__m128 x = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(boxes.minX + i), qMaxX), _mm_cmplt_ps(qMinX, _mm_loadu_ps(boxes.maxX + i)));
+		__m128 y = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(boxes.minY + i), qMaxY), _mm_cmplt_ps(qMinY, _mm_loadu_ps(boxes.maxY + i)));
+
+		int mask = _mm_movemask_ps(_mm_and_ps(x, y));
+		for (int bit = 0; mask != 0; ++bit, mask >>= 1)
+			if (mask & 1)
+				hits[found++] = i + bit;
+	}
+#endif
+
+	// remainder, or everything without SIMD
+	for (; i < end; ++i)
+		if (overlapOne(minX, minY, maxX, maxY, boxes, i))
+			hits[found++] = i;
+
+	return found;
+}
+
+static inline bool overlapCircleOne(const float * dx, const float * dy, const float * radiusSum, int i) {
+	return dx[i] * dx[i] + dy[i] * dy[i] < radiusSum[i] * radiusSum[i];
+}
+
+int overlapCircleBatchScalar(const float * dx, const float * dy, const float * radiusSum, int count, int * hits) {
+	int found = 0;
+	for (int i = 0; i < count; ++i)
+		if (overlapCircleOne(dx, dy, radiusSum, i))
+			hits[found++] = i;
+	return found;
+}
+
+int overlapCircleBatch(const float * dx, const float * dy, const float * radiusSum, int count, int * hits) {
+	int found = 0;
+	int i = 0;
+
+#if defined(XCUBE_AABB_AVX)
+	for (; i + 8 <= count; i += 8) {
+		__m256 x = _mm256_loadu_ps(dx + i), y = _mm256_loadu_ps(dy + i), r = _mm256_loadu_ps(radiusSum + i);
+		__m256 distance = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_mul_ps(r, r), _CMP_LT_OQ));
+		for (int bit = 0; mask != 0; ++bit, mask >>= 1)
+			if (mask & 1)
+				hits[found++] = i + bit;
+	}
+#elif defined(XCUBE_AABB_SSE)
+	for (; i + 4 <= count; i += 4) {
+		__m128 x = _mm_loadu_ps(dx + i), y = _mm_loadu_ps(dy + i), r = _mm_loadu_ps(radiusSum + i);
+		__m128 distance = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(distance, _mm_mul_ps(r, r)));
+		for (int bit = 0; mask != 0; ++bit, mask >>= 1)
+			if (mask & 1)
+				hits[found++] = i + bit;
+	}
+#endif
+
+	for (; i < count; ++i)
+		if (overlapCircleOne(dx, dy, radiusSum, i))
+			hits[found++] = i;
+
+	return found;
+}
+
+const char * getAABBBatchPath() {
+#if defined(XCUBE_AABB_AVX)
+	return "avx";
+#elif defined(XCUBE_AABB_SSE)
+	return "sse";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,52 @@
+#ifndef __AABB_BATCH_H__
+#define __AABB_BATCH_H__
+
+/**
+ * Axis aligned boxes stored as four separate arrays (structure of arrays),
+ * so SIMD code can load the same coordinate of consecutive boxes at once
+ */
+struct AABBArrays {
+	const float * minX;
+	const float * minY;
+	const float * maxX;
+	const float * maxY;
+};
+
+/**
+ * Tests one box against count boxes starting at first and writes the indices
+ * (first + offset) of the overlapping ones to hits, in ascending order.
+ * Touching edges do not count as overlap
+ *
+ * Uses AVX (8 boxes per compare) or SSE (4 boxes per compare) when the compiler
+ * targets them, see getAABBBatchPath(), the remainder is done in scalar code
+ *
+ * @param hits - must have room for count entries
+ * @return number of indices written to hits
+ */
+int overlapAABBBatch(float minX, float minY, float maxX, float maxY, const AABBArrays & boxes, int first, int count, int * hits);
+
+/**
+ * Same as overlapAABBBatch() one box at a time, the reference for tests and benchmarks
+ */
+int overlapAABBBatchScalar(float minX, float minY, float maxX, float maxY, const AABBArrays & boxes, int first, int count, int * hits);
+
+/**
+ * Tests count circle pairs given as center offsets and radius sums, dx[i] * dx[i] + dy[i] * dy[i] < radiusSum[i] * radiusSum[i],
+ * and writes the indices of the overlapping pairs to hits, in ascending order. Same paths as overlapAABBBatch()
+ *
+ * @param hits - must have room for count entries
+ * @return number of indices written to hits
+ */
+int overlapCircleBatch(const float * dx, const float * dy, const float * radiusSum, int count, int * hits);
+
+/**
+ * Same as overlapCircleBatch() one pair at a time
+ */
+int overlapCircleBatchScalar(const float * dx, const float * dy, const float * radiusSum, int count, int * hits);
+
+/**
+ * @return "avx", "sse" or "scalar", the path compiled into overlapAABBBatch() and overlapCircleBatch()
+ */
+const char * getAABBBatchPath();
+
+#endif
@@ -0,0 +1,208 @@
+#include "AIScheduler.h"
+
+#include <algorithm>
+
+AIScheduler::AIScheduler() : running(false), view(0, 0, 0, 0), hasView(false), updateBudget(0), stretch(1), tick(0), time(0.0), lastRunCount(0) {
+	setTiers({ AITier(400.0f, 1), AITier(800.0f, 2), AITier(1600.0f, 4), AITier(0.0f, 8) });
+}
+
+void AIScheduler::setTiers(const std::vector<AITier> & newTiers) {
+	if (newTiers.empty())
+		throw EngineException("Invalid AI tiers:", "none given");
+
+	for (size_t i = 0; i < newTiers.size(); ++i) {
+		if (newTiers[i].period < 1)
+			throw EngineException("Invalid AI tier period:", std::to_string(newTiers[i].period));
+		if (i > 0 && i + 1 < newTiers.size() && newTiers[i].maxDistance < newTiers[i - 1].maxDistance)
+			throw EngineException("AI tiers out of order:", std::to_string(newTiers[i].maxDistance));
+	}
+
+	tiers.clear();
+	for (const AITier & tier : newTiers)
+		tiers.push_back(Tier(tier));
+	stretch = 1;
+
+	// deal the agents into the new tiers
+	for (size_t id = 0; id < agents.size(); ++id) {
+		if (agents[id].tier >= 0) {
+			agents[id].tier = -1;
+			moveToTier((int)id, pickTier(agents[id].position));
+		}
+	}
+}
+
+int AIScheduler::pickTier(const Vector2f & position) const {
+	if (hasView && position.x >= view.x && position.y >= view.y && position.x < view.x + view.w && position.y < view.y + view.h)
+		return 0;
+
+	const float dx = position.x - focus.x, dy = position.y - focus.y;
+	const float distance2 = dx * dx + dy * dy;
+	for (size_t i = 0; i + 1 < tiers.size(); ++i)
+		if (distance2 <= tiers[i].settings.maxDistance * tiers[i].settings.maxDistance)
+			return (int)i;
+	return (int)tiers.size() - 1;
+}
+
+void AIScheduler::moveToTier(const int & id, const int & tier) {
+	Agent & agent = agents[id];
+	if (agent.tier == tier)
+		return;
+
+	// the last agent of the bucket takes the slot, it stays in the same bucket
+	if (agent.tier >= 0) {
+		std::vector<int> & bucket = tiers[agent.tier].buckets[agent.bucket];
+		const int last = bucket.back();
+		bucket[agent.slot] = last;
+		agents[last].slot = agent.slot;
+		bucket.pop_back();
+		--tiers[agent.tier].count;
+	}
+
+	agent.tier = tier;
+	if (tier >= 0) {
+		Tier & joined = tiers[tier];
+		agent.bucket = joined.nextBucket;
+		joined.nextBucket = (joined.nextBucket + 1) % (int)joined.buckets.size();
+
+		std::vector<int> & bucket = joined.buckets[agent.bucket];
+		agent.slot = (int)bucket.size();
+		bucket.push_back(id);
+		++joined.count;
+	}
+}
+
+void AIScheduler::setPeriod(const int & tier, const int & period) {
+	Tier & changed = tiers[tier];
+	std::vector<int> dealt;
+	for (const std::vector<int> & bucket : changed.buckets)
+		dealt.insert(dealt.end(), bucket.begin(), bucket.end());
+
+	changed.buckets.assign(period, std::vector<int>());
+	changed.nextBucket = 0;
+	changed.count = 0;
+	for (int id : dealt) {
+		agents[id].tier = -1;
+		moveToTier(id, tier);
+	}
+}
+
+int AIScheduler::add(const Vector2f & position) {
+	int id;
+	if (freeIds.empty()) {
+		id = (int)agents.size();
+		agents.push_back(Agent());
+	}
+	else {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+
+	Agent & agent = agents[id];
+	agent.position = position;
+	agent.lastRun = time;
+	agent.tier = -1;
+	agent.slot = -1;
+	agent.live = true;
+	if (running)
+		pendingAdds.push_back(id);
+	else
+		moveToTier(id, pickTier(position));
+	return id;
+}
+
+void AIScheduler::remove(const int & id) {
+	if (id < 0 || id >= (int)agents.size() || !agents[id].live)
+		throw EngineException("Invalid AI agent:", std::to_string(id));
+
+	agents[id].live = false;
+	if (running) {
+		pendingRemoves.push_back(id);
+		return;
+	}
+	moveToTier(id, -1);
+	freeIds.push_back(id);
+}
+
+void AIScheduler::clear() {
+	for (Tier & tier : tiers) {
+		for (std::vector<int> & bucket : tier.buckets)
+			bucket.clear();
+		tier.nextBucket = 0;
+		tier.count = 0;
+	}
+	agents.clear();
+	freeIds.clear();
+	ran.clear();
+	pendingAdds.clear();
+	pendingRemoves.clear();
+}
+
+void AIScheduler::setView(const Rectangle2f & v) {
+	view = v;
+	hasView = true;
+}
+
+void AIScheduler::stretchTiers() {
+	int needed = 1;
+	if (updateBudget > 0) {
+		// the first tier runs at its own period whatever the budget, the others share what is left
+		int rest = 0;
+		for (size_t i = 1; i < tiers.size(); ++i)
+			rest += (tiers[i].count + tiers[i].settings.period - 1) / tiers[i].settings.period;
+
+		const int left = std::max(1, updateBudget - (tiers[0].count + getPeriod(0) - 1) / getPeriod(0));
+		needed = std::max(1, (rest + left - 1) / left);
+	}
+
+	if (needed <= stretch && needed * 2 > stretch)
+		return;
+
+	// growing leaves a quarter spare, so a growing population deals the tiers out again rarely
+	stretch = needed > stretch ? needed + needed / 4 : needed;
+	for (size_t i = 1; i < tiers.size(); ++i)
+		if (getPeriod((int)i) != tiers[i].settings.period * stretch)
+			setPeriod((int)i, tiers[i].settings.period * stretch);
+}
+
+void AIScheduler::update(const Vector2f & f, const float & dt, const std::function<void(int, float)> & run) {
+	focus = f;
+	time += dt;
+	stretchTiers();
+
+	// the buckets stay as they are during the pass, agents added or removed by run() are dealt in or out after it
+	ran.clear();
+	running = true;
+	for (size_t t = 0; t < tiers.size(); ++t) {
+		const std::vector<int> & bucket = tiers[t].buckets[(size_t)(tick % (Uint64)tiers[t].buckets.size())];
+		for (size_t i = 0; i < bucket.size(); ++i) {
+			const int id = bucket[i];
+			if (!agents[id].live)
+				continue;	// removed earlier in the pass
+
+			const float agentDt = (float)(time - agents[id].lastRun);
+			agents[id].lastRun = time;
+			ran.push_back(id);
+			run(id, agentDt);
+		}
+	}
+	running = false;
+
+	for (int id : pendingRemoves) {
+		moveToTier(id, -1);
+		freeIds.push_back(id);
+	}
+	pendingRemoves.clear();
+
+	// tiers change after the pass, so agents moving tier do not run twice in one tick
+	for (int id : ran)
+		if (agents[id].tier >= 0)
+			moveToTier(id, pickTier(agents[id].position));
+
+	for (int id : pendingAdds)
+		if (agents[id].live)
+			moveToTier(id, pickTier(agents[id].position));
+	pendingAdds.clear();
+
+	lastRunCount = (int)ran.size();
+	++tick;
+}
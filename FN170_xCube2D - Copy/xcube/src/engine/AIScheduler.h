@@ -0,0 +1,150 @@
+#ifndef __AI_SCHEDULER_H__
+#define __AI_SCHEDULER_H__
+
+#include <functional>
+#include <vector>
+
+#include "EngineCommon.h"
+#include "GameMath.h"
+
+/**
+ * Agents within maxDistance pixels of the focus (and not in a nearer tier) run every period ticks
+ */
+struct AITier {
+	float maxDistance;
+	int period;
+
+	AITier(const float & maxDistance, const int & period) : maxDistance(maxDistance), period(period) {}
+};
+
+/**
+ * Level of detail for AI: decides which agents run their logic on a tick, so enemies
+ * far from the player (or outside the view) think less often than the ones close by.
+ *
+ * Each agent is in a frequency tier by distance from the focus, agents inside the view rectangle
+ * are always in the first tier. The agents of a tier are dealt round robin into period buckets
+ * and one bucket runs per tick, so the work of a tier is spread evenly instead of landing on one tick,
+ * and an agent staying in its tier runs exactly every period ticks.
+ * An agent is handed the time since it last ran, so speeds and timers stay correct at any period.
+ *
+ * Only the agents that run are looked at, a tier is re-evaluated from the position
+ * the agent reports while running. With an update budget the periods of every tier but the first
+ * stretch by a common factor as the population grows, so the cost per tick stays flat
+ * however many agents the world holds while near agents keep their rate
+ */
+class AIScheduler {
+	private:
+		struct Agent {
+			Vector2f position;
+			double lastRun;		// time of the scheduler the agent last ran at
+			int tier;			// -1 while the id is free or the agent waits to be dealt in
+			bool live;			// from add() until remove()
+			int bucket;
+			int slot;			// index in its bucket
+		};
+
+		struct Tier {
+			AITier settings;
+			std::vector<std::vector<int>> buckets;	// one per tick of the period, bucket tick % period runs
+			int nextBucket;		// the next agent joining is dealt into this one
+			int count;
+
+			explicit Tier(const AITier & settings) : settings(settings), buckets(settings.period), nextBucket(0), count(0) {}
+		};
+
+		std::vector<Tier> tiers;
+		std::vector<Agent> agents;
+		std::vector<int> freeIds;
+		std::vector<int> ran;		// agents run this tick, re-tiered after
+		std::vector<int> pendingAdds, pendingRemoves;	// made by run() during the pass, applied after it
+		bool running;
+
+		Vector2f focus;
+		Rectangle2f view;
+		bool hasView;
+		int updateBudget;
+		int stretch;		// factor the periods of the tiers after the first run at
+		Uint64 tick;
+		double time;
+		int lastRunCount;
+
+		int pickTier(const Vector2f & position) const;
+		void moveToTier(const int & id, const int & tier);
+
+		/**
+		* Deals a tier's agents into period buckets again
+		*/
+		void setPeriod(const int & tier, const int & period);
+		void stretchTiers();
+	public:
+		/**
+		* Default tiers: every tick within 400 pixels, every 2nd within 800, every 4th within 1600, every 8th beyond
+		*/
+		AIScheduler();
+
+		/**
+		* @param tiers - ascending maxDistance, periods of at least 1, the last tier also takes every agent beyond it
+		*/
+		void setTiers(const std::vector<AITier> & tiers);
+		int getTierCount() const { return (int)tiers.size(); }
+
+		/**
+		* Moves the point distances are measured from, update() does too.
+		* Set it before adding a world's agents so they start in the right tiers
+		*/
+		void setFocus(const Vector2f & position) { focus = position; }
+
+		/**
+		* Called from run() the agent is dealt into its tier after the pass, so it does not run with a dt of 0 this tick
+		* @return id of the new agent, in the tier for the current focus, it runs at its bucket's next turn
+		*/
+		int add(const Vector2f & position);
+
+		/**
+		* Called from run() the agent does not run again, its id is freed after the pass
+		*/
+		void remove(const int & id);
+		void clear();
+
+		int getCount() const { return (int)(agents.size() - freeIds.size()); }
+
+		/**
+		* Keeps an agent's position for picking its tier, call while it runs
+		*/
+		void setPosition(const int & id, const Vector2f & position) { agents[id].position = position; }
+		int getTier(const int & id) const { return agents[id].tier; }
+
+		/**
+		* Agents inside the rectangle (e.g. the camera) run in the first tier whatever their distance
+		*/
+		void setView(const Rectangle2f & view);
+		void clearView() { hasView = false; }
+
+		/**
+		* @param agents - most agents run per tick, the tiers after the first run at multiples of their periods
+		*				to keep within it. 0 (the default) for no limit. The first tier is never stretched.
+		*				The factor grows with a quarter to spare and only shrinks once half of it would do, so a population near the limit
+		*				does not deal the tiers out again every tick
+		*/
+		void setUpdateBudget(const int & agents) { updateBudget = agents; }
+
+		/**
+		* Runs this tick's bucket of every tier
+		* @param focus - the player, distances are measured from here
+		* @param run - called as run(id, dt) with the seconds since that agent last ran
+		*/
+		void update(const Vector2f & focus, const float & dt, const std::function<void(int, float)> & run);
+
+		/**
+		* @return agents run by the last update()
+		*/
+		int getLastRunCount() const { return lastRunCount; }
+
+		/**
+		* @return the period tier i currently runs at, stretched by the budget
+		*/
+		int getPeriod(const int & i) const { return (int)tiers[i].buckets.size(); }
+		int getTierAgentCount(const int & i) const { return tiers[i].count; }
+};
+
+#endif
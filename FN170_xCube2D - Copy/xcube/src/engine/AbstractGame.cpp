@@ -1,6 +1,6 @@
 #include "AbstractGame.h"
 
-AbstractGame::AbstractGame() : running(true), paused(false), gameTime(0.0) {
+AbstractGame::AbstractGame() : overlayKeyDown(false), running(true), paused(false), gameTime(0.0) {
 	std::shared_ptr<XCube2Engine> engine = XCube2Engine::getInstance();
 
 	// engine ready, get subsystems
@@ -9,6 +9,7 @@ AbstractGame::AbstractGame() : running(true), paused(false), gameTime(0.0) {
 	eventSystem = engine->getEventEngine();
 	physics = engine->getPhysicsEngine();
     mySystem = engine->getMyEngineSystem();
+	overlay = engine->getDebugOverlay();
 
 	TTF_Font* uiFont = ResourceManager::loadFont("res/fonts/arial.ttf", 24);
 	gfx->useFont(uiFont);
@@ -23,6 +24,7 @@ AbstractGame::~AbstractGame() {
 	// kill Game class' instance pointers
 	// so that engine is isolated from the outside world
 	// before shutting down
+	overlay.reset();
 	gfx.reset();
 	eventSystem.reset();
 
@@ -31,8 +33,6 @@ AbstractGame::~AbstractGame() {
 
 #ifdef __DEBUG
 	debug("AbstractGame::~AbstractGame() finished");
-	debug("The game finished and cleaned up successfully. Press Enter to exit");
-	getchar();
 #endif
 }
 
@@ -42,28 +42,13 @@ int AbstractGame::runMainLoop() {
 #endif
 
 	while (running) {
+		Profiler::beginFrame();
 		gfx->setFrameStart();
-		eventSystem->pollEvents();
 
-		if (eventSystem->isPressed(Key::ESC) || eventSystem->isPressed(Key::QUIT))
-			running = false;
-
-		handleKeyEvents();
-		handleMouseEvents();
-
-		if (!paused) {
-			update();
-			updatePhysics();
-
-			gameTime += 0.016;	// 60 times a sec
-		}
-
-		gfx->clearScreen();
-		render();
-		renderUI();
-		gfx->showScreen();
+		runFrame();
 
 		gfx->adjustFPSDelay(16);	// atm hardcoded to ~60 FPS
+		Profiler::endFrame();
 	}
 
 #ifdef __DEBUG
@@ -73,11 +58,54 @@ int AbstractGame::runMainLoop() {
 	return 0;
 }
 
+void AbstractGame::runFrame() {
+	Profiler::begin(PROFILE_EVENTS);
+	eventSystem->pollEvents();
+
+	if (eventSystem->isPressed(Key::ESC) || eventSystem->isPressed(Key::QUIT))
+		running = false;
+
+	handleOverlayToggle();
+	handleKeyEvents();
+	handleMouseEvents();
+	Profiler::end(PROFILE_EVENTS);
+
+	if (!paused) {
+		Profiler::begin(PROFILE_UPDATE);
+		update();
+		Profiler::end(PROFILE_UPDATE);
+
+		Profiler::begin(PROFILE_PHYSICS);
+		updatePhysics();
+		Profiler::end(PROFILE_PHYSICS);
+
+		gameTime += 0.016;	// 60 times a sec
+	}
+
+	Profiler::begin(PROFILE_RENDER);
+	gfx->clearScreen();
+	render();
+	renderUI();
+	overlay->render();
+	Profiler::end(PROFILE_RENDER);
+
+	Profiler::begin(PROFILE_PRESENT);
+	gfx->showScreen();
+	Profiler::end(PROFILE_PRESENT);
+}
+
 void AbstractGame::handleMouseEvents() {
 	if (eventSystem->isPressed(Mouse::BTN_LEFT)) onLeftMouseButton();
 	if (eventSystem->isPressed(Mouse::BTN_RIGHT)) onRightMouseButton();
 }
 
+void AbstractGame::handleOverlayToggle() {
+	bool down = eventSystem->isPressed(Key::F3);
+	if (down && !overlayKeyDown)
+		overlay->toggle();
+	overlayKeyDown = down;
+}
+
 void AbstractGame::updatePhysics() {
 	physics->update();
 }
@@ -6,8 +6,11 @@
 class AbstractGame {
 	private:
 		void handleMouseEvents();
+		void handleOverlayToggle();
 		void updatePhysics();
 
+		bool overlayKeyDown;	// F3 is toggled on press, not while held
+
 	protected:
 		AbstractGame();
 		virtual ~AbstractGame();
@@ -18,6 +21,7 @@ class AbstractGame {
 		std::shared_ptr<EventEngine> eventSystem;
 		std::shared_ptr<PhysicsEngine> physics;
         std::shared_ptr<MyEngineSystem> mySystem;
+		std::shared_ptr<DebugOverlay> overlay;
 
 		/* Main loop control */
 		bool running;
@@ -38,6 +42,14 @@ class AbstractGame {
 		void resume() { paused = false; }
 	public:
 		int runMainLoop();
+
+		/**
+		* Runs a single frame (input, update, physics, render, present)
+		* without any frame rate limiting, runMainLoop() calls this every frame.
+		* Useful to drive the game from tools, e.g. replaying recorded input
+		*/
+		void runFrame();
+		bool isRunning() { return running; }
 };
 
 #endif
\ No newline at end of file
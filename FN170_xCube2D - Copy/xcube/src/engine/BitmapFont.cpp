@@ -0,0 +1,89 @@
+#include "BitmapFont.h"
+#include "GraphicsEngine.h"
+
+BitmapFont::BitmapFont() : atlas(nullptr), cellW(0), cellH(0), columns(16) {}
+
+BitmapFont::~BitmapFont() {
+	if (atlas)
+		SDL_DestroyTexture(atlas);
+}
+
+bool BitmapFont::build(TTF_Font * font) {
+	if (nullptr == font) {
+#ifdef __DEBUG
+		debug("BitmapFont::build()", "font is null");
+#endif
+		return false;
+	}
+
+	// monospace the atlas on the widest glyph so lookups are a multiply
+	cellW = 0;
+	cellH = TTF_FontHeight(font);
+	for (int c = BITMAP_FONT_FIRST_CHAR; c <= BITMAP_FONT_LAST_CHAR; ++c) {
+		int minX, maxX, minY, maxY, advance;
+		if (TTF_GlyphMetrics(font, (Uint16)c, &minX, &maxX, &minY, &maxY, &advance) == 0 && advance > cellW)
+			cellW = advance;
+	}
+
+	int rows = (BITMAP_FONT_CHAR_COUNT + columns - 1) / columns;
+	SDL_Surface * surf = SDL_CreateRGBSurfaceWithFormat(0, cellW * columns, cellH * rows, 32, SDL_PIXELFORMAT_RGBA32);
+	if (nullptr == surf) {
+		std::cout << "Failed to create font atlas: " << SDL_GetError() << std::endl;
+		return false;
+	}
+	SDL_FillRect(surf, nullptr, SDL_MapRGBA(surf->format, 0, 0, 0, 0));
+
+	// glyphs are baked white so any color can be applied with SDL_SetTextureColorMod()
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	for (int i = 0; i < BITMAP_FONT_CHAR_COUNT; ++i) {
+		SDL_Surface * glyph = TTF_RenderGlyph_Blended(font, (Uint16)(BITMAP_FONT_FIRST_CHAR + i), white);
+		if (nullptr == glyph)
+			continue;
+
+		SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);	// copy alpha as is
+		SDL_Rect dst = { (i % columns) * cellW, (i / columns) * cellH, cellW, cellH };
+		SDL_BlitSurface(glyph, nullptr, surf, &dst);
+		SDL_FreeSurface(glyph);
+	}
+
+	if (atlas)
+		SDL_DestroyTexture(atlas);
+
+	atlas = GraphicsEngine::createTextureFromSurface(surf);
+	SDL_FreeSurface(surf);
+
+	if (nullptr == atlas) {
+		std::cout << "Failed to upload font atlas: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+	return true;
+}
+
+void BitmapFont::draw(GraphicsEngine * gfx, const char * text, const int & x, const int & y, const SDL_Color & color) {
+	if (nullptr == atlas || nullptr == text)
+		return;
+
+	SDL_SetTextureColorMod(atlas, color.r, color.g, color.b);
+
+	SDL_Rect src = { 0, 0, cellW, cellH };
+	SDL_Rect dst = { x, y, cellW, cellH };
+
+	for (const char * c = text; *c != '\0'; ++c) {
+		if (*c == '\n') {
+			dst.x = x;
+			dst.y += cellH;
+			continue;
+		}
+
+		int index = *c - BITMAP_FONT_FIRST_CHAR;
+		if (index > 0 && index < BITMAP_FONT_CHAR_COUNT) {	// index 0 is space, nothing to draw
+			src.x = (index % columns) * cellW;
+			src.y = (index / columns) * cellH;
+			gfx->drawTexture(atlas, &src, &dst);
+		}
+
+		dst.x += cellW;
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef __BITMAP_FONT_H__
+#define __BITMAP_FONT_H__
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "EngineCommon.h"
+
+class GraphicsEngine;
+
+static const int BITMAP_FONT_FIRST_CHAR = 32;	// ' '
+static const int BITMAP_FONT_LAST_CHAR = 126;	// '~'
+static const int BITMAP_FONT_CHAR_COUNT = BITMAP_FONT_LAST_CHAR - BITMAP_FONT_FIRST_CHAR + 1;
+
+/**
+ * Monospaced glyph atlas baked once from a TTF font
+ *
+ * Unlike GraphicsEngine::drawText(), which renders and uploads a new texture
+ * on every call, drawing with a BitmapFont only copies cells out of a single
+ * texture, so it is cheap enough to use every frame (e.g. debug overlays)
+ */
+class BitmapFont {
+	private:
+		SDL_Texture * atlas;
+		int cellW, cellH;
+		int columns;
+
+	public:
+		BitmapFont();
+		~BitmapFont();
+
+		/**
+		* Bakes printable ASCII glyphs of the given font into the atlas
+		* The font may be closed afterwards
+		*
+		* @return true if the atlas was created
+		*/
+		bool build(TTF_Font * font);
+		bool isReady() const { return atlas != nullptr; }
+
+		int getCharWidth() const { return cellW; }
+		int getLineHeight() const { return cellH; }
+
+		/**
+		* Draws text using the atlas, '\n' starts a new line
+		* Characters outside printable ASCII are skipped
+		*/
+		void draw(GraphicsEngine * gfx, const char * text, const int & x, const int & y, const SDL_Color & color);
+};
+
+#endif
@@ -0,0 +1,414 @@
+#include "CollisionShapes.h"
+#include "EngineCommon.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* SHAPES */
+
+CollisionShape CollisionShape::circle(const float & radius) {
+	if (radius <= 0.0f)
+		throw EngineException("Invalid circle radius:", std::to_string(radius));
+
+	CollisionShape shape;
+	shape.type = SHAPE_CIRCLE;
+	shape.radius = radius;
+	return shape;
+}
+
+CollisionShape CollisionShape::capsule(const float & radius, const Vector2f & halfSegment) {
+	if (radius <= 0.0f)
+		throw EngineException("Invalid capsule radius:", std::to_string(radius));
+
+	CollisionShape shape;
+	shape.type = SHAPE_CAPSULE;
+	shape.radius = radius;
+	shape.segment = PhysicsVector(halfSegment);
+	return shape;
+}
+
+Vector2f CollisionShape::getHalfExtents() const {
+	float r = (float)radius;
+	switch (type) {
+		case SHAPE_CIRCLE:
+			return Vector2f(r, r);
+		case SHAPE_CAPSULE:
+			return Vector2f(std::fabs((float)segment.x) + r, std::fabs((float)segment.y) + r);
+		case SHAPE_POLYGON: {
+			Vector2f half(0.0f, 0.0f);
+			for (int i = 0; i < vertexCount; ++i) {
+				half.x = std::max(half.x, std::fabs((float)vertices[i].x));
+				half.y = std::max(half.y, std::fabs((float)vertices[i].y));
+			}
+			return half;
+		}
+		default:
+			return Vector2f(0.0f, 0.0f);
+	}
+}
+
+/* VECTOR HELPERS */
+
+typedef PhysicsVector Vec;
+typedef PhysicsReal Real;
+
+static Vec add(const Vec & a, const Vec & b) { return Vec(a.x + b.x, a.y + b.y); }
+static Vec sub(const Vec & a, const Vec & b) { return Vec(a.x - b.x, a.y - b.y); }
+static Vec negate(const Vec & v) { return Vec(-v.x, -v.y); }
+static Vec scale(const Vec & v, const Real & s) { return Vec(v.x * s, v.y * s); }
+
+// projection on a unit axis, stays in range
+static Real dot(const Vec & a, const Vec & b) { return a.x * b.x + a.y * b.y; }
+
+// squared lengths and cross products of two positions can leave the Q16.16 range,
+// the Fixed overloads work them out exactly in 64 bit (Q32.32), the float ones are the plain formulas
+
+static Sint64 wideDot(const Vector2x & a, const Vector2x & b) { return (Sint64)a.x.raw * b.x.raw + (Sint64)a.y.raw * b.y.raw; }
+static Sint64 wideCross(const Vector2x & a, const Vector2x & b) { return (Sint64)a.x.raw * b.y.raw - (Sint64)a.y.raw * b.x.raw; }
+
+static Uint64 isqrt(Uint64 value) {
+	// bit by bit, exact and the same everywhere
+	Uint64 root = 0, bit = (Uint64)1 << 62;
+	while (bit > value)
+		bit >>= 2;
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+static Fixed length(const Vector2x & v) {
+	// the square root of a Q32.32 value is its root in Q16.16
+	Uint64 root = isqrt((Uint64)wideDot(v, v));
+	return Fixed::fromRaw((Sint32)std::min<Uint64>(root, (Uint64)SDL_MAX_SINT32));
+}
+
+static bool shorterThan(const Vector2x & v, const Fixed & r) { return wideDot(v, v) < (Sint64)r.raw * r.raw; }
+static bool shorter(const Vector2x & a, const Vector2x & b) { return wideDot(a, a) < wideDot(b, b); }
+static int crossSign(const Vector2x & a, const Vector2x & b) { Sint64 c = wideCross(a, b); return (c > 0) - (c < 0); }
+
+static Fixed segmentParam(const Vector2x & p, const Vector2x & d) {
+	Sint64 num = wideDot(p, d), den = wideDot(d, d);
+	if (num <= 0 || den == 0)
+		return 0;
+	if (num >= den)
+		return 1;
+
+	// num < den, scaled down until num * FIXED_ONE fits
+	while (den >= ((Sint64)1 << 46)) {
+		num >>= 1;
+		den >>= 1;
+	}
+	return Fixed::fromRaw((Sint32)(num * FIXED_ONE / den));
+}
+
+// length(Vector2f) comes from GameMath.h
+static bool shorterThan(const Vector2f & v, const float & r) { return v.x * v.x + v.y * v.y < r * r; }
+static bool shorter(const Vector2f & a, const Vector2f & b) { return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y; }
+static int crossSign(const Vector2f & a, const Vector2f & b) { float c = a.x * b.y - a.y * b.x; return (c > 0.0f) - (c < 0.0f); }
+
+static float segmentParam(const Vector2f & p, const Vector2f & d) {
+	float den = d.x * d.x + d.y * d.y;
+	if (den <= 0.0f)
+		return 0.0f;
+	return std::max(0.0f, std::min(1.0f, (p.x * d.x + p.y * d.y) / den));
+}
+
+static Vector2x normalize(const Vector2x & v) {
+	Sint64 x = v.x.raw, y = v.y.raw;
+	if (x == 0 && y == 0)
+		return Vector2x(0, 1);
+
+	// scaled up first, a vector a few raw units long still has an exact direction
+	while (std::max(std::abs(x), std::abs(y)) < ((Sint64)1 << 28)) {
+		x *= 2;
+		y *= 2;
+	}
+	Vector2x scaled(Fixed::fromRaw((Sint32)x), Fixed::fromRaw((Sint32)y));
+	Fixed len = length(scaled);
+	return Vector2x(scaled.x / len, scaled.y / len);
+}
+
+static Vector2f normalize(const Vector2f & v) {
+	float len = length(v);
+	return len == 0.0f ? Vector2f(0.0f, 1.0f) : Vector2f(v.x / len, v.y / len);
+}
+
+// twice the signed area, exact in 64 bit for Fixed
+static int windingSign(const Vector2x * v, const int & count) {
+	Sint64 area = 0;
+	for (int i = 0; i < count; ++i)
+		area += wideCross(v[i], v[(i + 1) % count]);
+	return (area > 0) - (area < 0);
+}
+
+static int windingSign(const Vector2f * v, const int & count) {
+	float area = 0.0f;
+	for (int i = 0; i < count; ++i)
+		area += v[i].x * v[(i + 1) % count].y - v[i].y * v[(i + 1) % count].x;
+	return (area > 0.0f) - (area < 0.0f);
+}
+
+/* POLYGON */
+
+CollisionShape CollisionShape::polygon(const Vector2f * vertices, const int & count) {
+	if (count < 3 || count > MAX_POLYGON_VERTICES)
+		throw EngineException("Invalid polygon vertex count:", std::to_string(count));
+
+	// converted first, the winding, convexity and normals are then worked out in PhysicsReal
+	// so a fixed point build gets the same shape on every compiler
+	Vec converted[MAX_POLYGON_VERTICES];
+	for (int i = 0; i < count; ++i)
+		converted[i] = Vec(vertices[i]);
+
+	const int winding = windingSign(converted, count);
+	if (winding == 0)
+		throw EngineException("Invalid polygon:", "no area");
+
+	// counter clockwise so the right hand normal of every edge points outwards
+	CollisionShape shape;
+	shape.type = SHAPE_POLYGON;
+	shape.vertexCount = count;
+	for (int i = 0; i < count; ++i)
+		shape.vertices[i] = winding > 0 ? converted[i] : converted[count - 1 - i];
+
+	for (int i = 0; i < count; ++i) {
+		const Vec & p = shape.vertices[i], & q = shape.vertices[(i + 1) % count], & r = shape.vertices[(i + 2) % count];
+		const Vec edge = sub(q, p);
+		if (crossSign(edge, sub(r, q)) <= 0)
+			throw EngineException("Invalid polygon:", "not convex");
+
+		shape.normals[i] = normalize(Vec(edge.y, -edge.x));
+	}
+	return shape;
+}
+
+static bool isZero(const Vec & v) { return v.x == Real(0) && v.y == Real(0); }
+
+/* SEGMENTS */
+
+// closest point to p on the segment from a to a + d
+static Vec closestOnSegment(const Vec & p, const Vec & a, const Vec & d) {
+	return add(a, scale(d, segmentParam(sub(p, a), d)));
+}
+
+/**
+ * Closest points of segments p0-p1 and q0-q1, either may have zero length
+ * @return true if they cross, cp and cq are not set then
+ */
+static bool closestPoints(const Vec & p0, const Vec & p1, const Vec & q0, const Vec & q1, Vec & cp, Vec & cq) {
+	Vec r = sub(p1, p0), s = sub(q1, q0);
+	if (crossSign(r, sub(q0, p0)) * crossSign(r, sub(q1, p0)) < 0 && crossSign(s, sub(p0, q0)) * crossSign(s, sub(p1, q0)) < 0)
+		return true;
+
+	// apart, so one of the four end points is closest to the other segment
+	cp = p0;
+	cq = closestOnSegment(p0, q0, s);
+
+	Vec p = p1, q = closestOnSegment(p1, q0, s);
+	if (shorter(sub(q, p), sub(cq, cp))) { cp = p; cq = q; }
+
+	q = q0; p = closestOnSegment(q0, p0, r);
+	if (shorter(sub(q, p), sub(cq, cp))) { cp = p; cq = q; }
+
+	q = q1; p = closestOnSegment(q1, p0, r);
+	if (shorter(sub(q, p), sub(cq, cp))) { cp = p; cq = q; }
+
+	return false;
+}
+
+/* PAIR TESTS */
+
+// a polygon view of a box or polygon pose, relative to the pose's position
+static int polygonOf(const ShapePose & pose, Vec * vertices, Vec * normals) {
+	if (pose.shape->type == SHAPE_POLYGON) {
+		std::copy(pose.shape->vertices, pose.shape->vertices + pose.shape->vertexCount, vertices);
+		std::copy(pose.shape->normals, pose.shape->normals + pose.shape->vertexCount, normals);
+		return pose.shape->vertexCount;
+	}
+
+	const Real hx = pose.half.x, hy = pose.half.y;
+	vertices[0] = Vec(-hx, -hy); vertices[1] = Vec(hx, -hy); vertices[2] = Vec(hx, hy); vertices[3] = Vec(-hx, hy);
+	normals[0] = Vec(0, -1); normals[1] = Vec(1, 0); normals[2] = Vec(0, 1); normals[3] = Vec(-1, 0);
+	return 4;
+}
+
+static void project(const Vec * vertices, const int & count, const Vec & axis, Real & low, Real & high) {
+	low = high = dot(vertices[0], axis);
+	for (int i = 1; i < count; ++i) {
+		Real d = dot(vertices[i], axis);
+		low = std::min(low, d);
+		high = std::max(high, d);
+	}
+}
+
+// separating axis test over both polygons' edge normals, boxes included
+static bool testPolygonPolygon(const ShapePose & a, const ShapePose & b, ShapeContact & contact) {
+	Vec av[MAX_POLYGON_VERTICES], an[MAX_POLYGON_VERTICES], bv[MAX_POLYGON_VERTICES], bn[MAX_POLYGON_VERTICES];
+	const int ac = polygonOf(a, av, an), bc = polygonOf(b, bv, bn);
+
+	// b in a's frame
+	const Vec offset = sub(b.position, a.position);
+	for (int k = 0; k < bc; ++k)
+		bv[k] = add(bv[k], offset);
+
+	bool found = false;
+	for (int side = 0; side < 2; ++side) {
+		const Vec * normals = side == 0 ? an : bn;
+		const int count = side == 0 ? ac : bc;
+
+		for (int i = 0; i < count; ++i) {
+			Real aLow, aHigh, bLow, bHigh;
+			project(av, ac, normals[i], aLow, aHigh);
+			project(bv, bc, normals[i], bLow, bHigh);
+
+			// a's normals point from a to b, b's from b to a
+			Real depth = side == 0 ? aHigh - bLow : bHigh - aLow;
+			if (depth <= Real(0))
+				return false;
+
+			if (!found || depth < contact.depth) {
+				found = true;
+				contact.depth = depth;
+				contact.normal = side == 0 ? normals[i] : negate(normals[i]);
+			}
+		}
+	}
+	return true;
+}
+
+// circles and capsules are segments grown by a radius, a circle's segment has zero length
+static bool testRoundRound(const ShapePose & a, const ShapePose & b, ShapeContact & contact) {
+	const Vec offset = sub(b.position, a.position);
+	const Vec & as = a.shape->segment, & bs = b.shape->segment;
+	const Real radius = a.shape->radius + b.shape->radius;
+
+	const Vec aCore[2] = { negate(as), as }, bCore[2] = { sub(offset, bs), add(offset, bs) };
+	Vec cp, cq;
+	if (closestPoints(aCore[0], aCore[1], bCore[0], bCore[1], cp, cq)) {
+		// the cores cross, the shortest way out is along one of their normals
+		const Vec axes[2] = { normalize(Vec(as.y, -as.x)), normalize(Vec(bs.y, -bs.x)) };
+		for (int i = 0; i < 2; ++i) {
+			Real aLow, aHigh, bLow, bHigh;
+			project(aCore, 2, axes[i], aLow, aHigh);
+			project(bCore, 2, axes[i], bLow, bHigh);
+
+			Real up = aHigh - bLow, down = bHigh - aLow;
+			if (i == 0 || up < contact.depth) { contact.depth = up; contact.normal = axes[i]; }
+			if (down < contact.depth) { contact.depth = down; contact.normal = negate(axes[i]); }
+		}
+		contact.depth = contact.depth + radius;
+		return true;
+	}
+
+	Vec d = sub(cq, cp);
+	if (isZero(d)) {
+		// cores touch, push apart along the centers
+		contact.normal = normalize(offset);
+		contact.depth = radius;
+		return true;
+	}
+
+	if (!shorterThan(d, radius))
+		return false;
+
+	Real len = length(d);
+	contact.normal = normalize(d);
+	contact.depth = radius - len;
+	return true;
+}
+
+static bool testPolygonRound(const ShapePose & a, const ShapePose & b, ShapeContact & contact) {
+	Vec av[MAX_POLYGON_VERTICES], an[MAX_POLYGON_VERTICES];
+	const int ac = polygonOf(a, av, an);
+
+	const Vec offset = sub(b.position, a.position);
+	const Vec & seg = b.shape->segment;
+	const Vec q0 = sub(offset, seg), q1 = add(offset, seg);
+	const Real radius = b.shape->radius;
+
+	// separating axes of the polygon and the bare segment
+	bool separated = false;
+	Vec apart;
+	contact.depth = 0;
+	for (int i = 0; i < ac && !separated; ++i) {
+		Real aLow, aHigh;
+		project(av, ac, an[i], aLow, aHigh);
+		Real depth = aHigh - std::min(dot(q0, an[i]), dot(q1, an[i]));
+		if (depth <= Real(0)) {
+			separated = true;
+			apart = an[i];
+		}
+		else if (i == 0 || depth < contact.depth) {
+			contact.depth = depth;
+			contact.normal = an[i];
+		}
+	}
+
+	if (!separated && !isZero(seg)) {
+		Vec axis = normalize(Vec(seg.y, -seg.x));
+		Real aLow, aHigh;
+		project(av, ac, axis, aLow, aHigh);
+
+		Real s = dot(q0, axis), up = aHigh - s, down = s - aLow;
+		if (up <= Real(0) || down <= Real(0)) {
+			separated = true;
+			apart = up <= Real(0) ? axis : negate(axis);
+		}
+		else {
+			if (up < contact.depth) { contact.depth = up; contact.normal = axis; }
+			if (down < contact.depth) { contact.depth = down; contact.normal = negate(axis); }
+		}
+	}
+
+	if (!separated) {
+		contact.depth = contact.depth + radius;
+		return true;
+	}
+
+	// the cores are apart, the radius has to bridge the gap to the nearest edge
+	Vec cp, cq, bestP, bestQ;
+	for (int i = 0; i < ac; ++i) {
+		closestPoints(av[i], av[(i + 1) % ac], q0, q1, cp, cq);
+		if (i == 0 || shorter(sub(cq, cp), sub(bestQ, bestP))) {
+			bestP = cp;
+			bestQ = cq;
+		}
+	}
+
+	Vec d = sub(bestQ, bestP);
+	if (!shorterThan(d, radius))
+		return false;
+
+	contact.normal = isZero(d) ? apart : normalize(d);
+	contact.depth = radius - length(d);
+	return true;
+}
+
+// the same tests with the shapes the other way round, the normal still points from a to b
+template <ShapeTest test>
+static bool flipped(const ShapePose & a, const ShapePose & b, ShapeContact & contact) {
+	if (!test(b, a, contact))
+		return false;
+	contact.normal = negate(contact.normal);
+	return true;
+}
+
+static const ShapeTest SHAPE_TESTS[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT] = {
+	// b:	box								circle						capsule						polygon
+	{		testPolygonPolygon,				testPolygonRound,			testPolygonRound,			testPolygonPolygon },	// a: box
+	{		flipped<testPolygonRound>,		testRoundRound,				testRoundRound,				flipped<testPolygonRound> },	// a: circle
+	{		flipped<testPolygonRound>,		testRoundRound,				testRoundRound,				flipped<testPolygonRound> },	// a: capsule
+	{		testPolygonPolygon,				testPolygonRound,			testPolygonRound,			testPolygonPolygon }	// a: polygon
+};
+
+bool overlapShapes(const ShapePose & a, const ShapePose & b, ShapeContact & contact) {
+	return SHAPE_TESTS[a.shape->type][b.shape->type](a, b, contact);
+}
@@ -0,0 +1,85 @@
+#ifndef __COLLISION_SHAPES_H__
+#define __COLLISION_SHAPES_H__
+
+#include "GameMath.h"
+
+/**
+ * Scalar of the simulation state. Building with XCUBE_FIXED_POINT switches the body store,
+ * integrator, contact solver and shape tests to Q16.16, so the same inputs give bit identical results on
+ * every compiler and platform (replays, lockstep networking), at the cost of a +-32767 pixel world
+ * and 1/65536 pixel resolution. The API stays in float either way
+ */
+#ifdef XCUBE_FIXED_POINT
+typedef Fixed PhysicsReal;
+#else
+typedef float PhysicsReal;
+#endif
+typedef Vector2T<PhysicsReal> PhysicsVector;
+
+enum ShapeType {
+	SHAPE_BOX,		// the body's axis aligned box, the default
+	SHAPE_CIRCLE,
+	SHAPE_CAPSULE,	// a segment grown by a radius
+	SHAPE_POLYGON,	// convex, up to MAX_POLYGON_VERTICES
+	SHAPE_TYPE_COUNT
+};
+
+static const int MAX_POLYGON_VERTICES = 8;
+
+/**
+ * Collision geometry relative to a body's position, boxes take their size from the body
+ */
+struct CollisionShape {
+	ShapeType type;
+	PhysicsReal radius;		// circle and capsule
+	PhysicsVector segment;	// capsule, the core segment runs from -segment to +segment
+	int vertexCount;		// polygon
+	PhysicsVector vertices[MAX_POLYGON_VERTICES];	// counter clockwise (y up), i.e. clockwise on screen
+	PhysicsVector normals[MAX_POLYGON_VERTICES];	// unit, outwards, of the edge from vertices[i] to vertices[i + 1]
+
+	CollisionShape() : type(SHAPE_BOX), radius(0), vertexCount(0) {}
+
+	static CollisionShape circle(const float & radius);
+	static CollisionShape capsule(const float & radius, const Vector2f & halfSegment);
+
+	/**
+	* Vertices may wind either way, they are stored counter clockwise
+	* @param count - 3 to MAX_POLYGON_VERTICES, the polygon must be convex
+	*/
+	static CollisionShape polygon(const Vector2f * vertices, const int & count);
+
+	/**
+	* @return half size of the axis aligned box around the shape, centered on the body
+	*/
+	Vector2f getHalfExtents() const;
+};
+
+/**
+ * A shape placed in the world, what the pair tests work on
+ */
+struct ShapePose {
+	const CollisionShape * shape;
+	PhysicsVector position;
+	PhysicsVector half;		// box half size, unused by other shapes
+
+	ShapePose(const CollisionShape * shape, const PhysicsVector & position, const PhysicsVector & half)
+		: shape(shape), position(position), half(half) {}
+};
+
+/**
+ * How far two overlapping shapes are inside each other
+ */
+struct ShapeContact {
+	PhysicsVector normal;	// unit, from a towards b
+	PhysicsReal depth;		// distance along normal that separates them
+};
+
+typedef bool (*ShapeTest)(const ShapePose & a, const ShapePose & b, ShapeContact & contact);
+
+/**
+ * Exact overlap of any two shapes, through a table indexed by both shape types.
+ * Touching edges do not count, as with boxes
+ */
+bool overlapShapes(const ShapePose & a, const ShapePose & b, ShapeContact & contact);
+
+#endif
@@ -0,0 +1,152 @@
+#include "Crowd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+static const float CROWD_GOLDEN_ANGLE = 2.39996323f;	// spreads agents sitting exactly on top of each other
+
+// the agent's own cell first, so a packed crowd fills maxNeighbours with the closest agents
+static const int CROWD_CELL_DX[9] = { 0, -1, 1, 0, 0, -1, 1, -1, 1 };
+static const int CROWD_CELL_DY[9] = { 0, 0, 0, -1, 1, -1, -1, 1, 1 };
+
+Crowd::Crowd(const CrowdSettings & s) : invCellSize(1.0f), bucketMask(0) {
+	setSettings(s);
+}
+
+void Crowd::setSettings(const CrowdSettings & s) {
+	if (s.neighbourRadius <= 0 || s.separationRadius <= 0 || s.separationRadius > s.neighbourRadius || s.maxNeighbours < 1)
+		throw EngineException("Invalid crowd settings:", "radius " + std::to_string(s.neighbourRadius) + ", separation radius "
+			+ std::to_string(s.separationRadius) + ", neighbours " + std::to_string(s.maxNeighbours));
+
+	settings = s;
+	invCellSize = 1.0f / s.neighbourRadius;
+}
+
+void Crowd::setThreadCount(const int & count) {
+	if (count < 0)
+		throw EngineException("Invalid crowd thread count:", std::to_string(count));
+
+	int threads = count > 0 ? count : (int)std::thread::hardware_concurrency();
+	if (threads <= 1)
+		jobs.reset();
+	else if (!jobs || jobs->getThreadCount() != threads)
+		jobs.reset(new JobSystem(threads));
+}
+
+Uint32 Crowd::getBucket(const int & cellX, const int & cellY) const {
+	return ((Uint32)cellX * 73856093u ^ (Uint32)cellY * 19349663u) & bucketMask;
+}
+
+void Crowd::buildHash(const float * x, const float * y, const float * vx, const float * vy, const int & count) {
+	// about two buckets per agent, so few cells share a bucket
+	Uint32 buckets = 64;
+	while (buckets < (Uint32)count * 2)
+		buckets <<= 1;
+	bucketMask = buckets - 1;
+
+	bucketStart.assign(buckets + 1, 0);
+	agentBucket.resize(count);
+	for (int i = 0; i < count; ++i) {
+		const Uint32 bucket = getBucket((int)std::floor(x[i] * invCellSize), (int)std::floor(y[i] * invCellSize));
+		agentBucket[i] = bucket;
+		++bucketStart[bucket + 1];
+	}
+	for (Uint32 b = 0; b < buckets; ++b)
+		bucketStart[b + 1] += bucketStart[b];
+
+	// counting sort, bucketStart[b] is the next free slot of bucket b while filling and the start of b + 1 after
+	sortedAgent.resize(count);
+	sortedX.resize(count); sortedY.resize(count);
+	sortedVX.resize(count); sortedVY.resize(count);
+	for (int i = 0; i < count; ++i) {
+		const int slot = bucketStart[agentBucket[i]]++;
+		sortedAgent[slot] = i;
+		sortedX[slot] = x[i]; sortedY[slot] = y[i];
+		sortedVX[slot] = vx[i]; sortedVY[slot] = vy[i];
+	}
+	for (Uint32 b = buckets; b > 0; --b)
+		bucketStart[b] = bucketStart[b - 1];
+	bucketStart[0] = 0;
+}
+
+void Crowd::computeRange(const int & begin, const int & end) {
+	const float radius2 = settings.neighbourRadius * settings.neighbourRadius;
+	const float separationRadius2 = settings.separationRadius * settings.separationRadius;
+	const float invSeparationRadius = 1.0f / settings.separationRadius;
+
+	for (int s = begin; s < end; ++s) {
+		const float px = sortedX[s], py = sortedY[s];
+		const int cellX = (int)std::floor(px * invCellSize), cellY = (int)std::floor(py * invCellSize);
+
+		float pushX = 0, pushY = 0, sumX = 0, sumY = 0, sumVX = 0, sumVY = 0;
+		int neighbours = 0;
+
+		// two of the 9 cells can share a bucket, each bucket is only walked once
+		Uint32 visited[9];
+		int visitedCount = 0;
+		for (int c = 0; c < 9 && neighbours < settings.maxNeighbours; ++c) {
+			const Uint32 bucket = getBucket(cellX + CROWD_CELL_DX[c], cellY + CROWD_CELL_DY[c]);
+			if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount)
+				continue;
+			visited[visitedCount++] = bucket;
+
+			for (int j = bucketStart[bucket]; j < bucketStart[bucket + 1]; ++j) {
+				const float dx = px - sortedX[j], dy = py - sortedY[j];
+				const float d2 = dx * dx + dy * dy;
+				if (j == s || d2 >= radius2)
+					continue;
+
+				sumX += sortedX[j]; sumY += sortedY[j];
+				sumVX += sortedVX[j]; sumVY += sortedVY[j];
+
+				if (d2 < separationRadius2) {
+					if (d2 > 1e-6f) {
+						const float d = std::sqrt(d2);
+						const float strength = (1.0f - d * invSeparationRadius) / d;
+						pushX += dx * strength;
+						pushY += dy * strength;
+					}
+					else {
+						const float angle = sortedAgent[s] * CROWD_GOLDEN_ANGLE;
+						pushX += std::cos(angle);
+						pushY += std::sin(angle);
+					}
+				}
+
+				if (++neighbours == settings.maxNeighbours)
+					break;
+			}
+		}
+
+		float fx = pushX * settings.separation, fy = pushY * settings.separation;
+		if (neighbours > 0) {
+			const float inv = 1.0f / neighbours;
+			fx += (sumVX * inv - sortedVX[s]) * settings.alignment + (sumX * inv - px) * settings.cohesion;
+			fy += (sumVY * inv - sortedVY[s]) * settings.alignment + (sumY * inv - py) * settings.cohesion;
+		}
+		forceX[sortedAgent[s]] = fx;
+		forceY[sortedAgent[s]] = fy;
+	}
+}
+
+void Crowd::update(const float * x, const float * y, const float * vx, const float * vy, const int & count) {
+	forceX.resize(count);
+	forceY.resize(count);
+	if (count <= 0)
+		return;
+
+	buildHash(x, y, vx, vy, count);
+
+	const int chunks = (count + CROWD_JOB_CHUNK - 1) / CROWD_JOB_CHUNK;
+	if (!jobs || chunks == 1) {
+		computeRange(0, count);
+		return;
+	}
+
+	// every agent only writes its own force, neighbours are read from the sorted copies
+	jobs->parallelFor(chunks, [this, count](int chunk) {
+		int begin = chunk * CROWD_JOB_CHUNK;
+		computeRange(begin, std::min(count, begin + CROWD_JOB_CHUNK));
+	});
+}
@@ -0,0 +1,85 @@
+#ifndef __CROWD_H__
+#define __CROWD_H__
+
+#include <memory>
+#include <vector>
+
+#include "EngineCommon.h"
+#include "GameMath.h"
+#include "JobSystem.h"
+
+static const int CROWD_JOB_CHUNK = 2048;	// agents per job when the forces are split over threads
+
+/**
+ * How strongly agents of a crowd react to the neighbours within neighbourRadius
+ */
+struct CrowdSettings {
+	float neighbourRadius;	// pixels, also the size of a spatial hash cell
+	float separationRadius;	// pixels, agents closer than this push each other apart, at most neighbourRadius
+	float separation;		// pixels per second squared of push between two agents on top of each other, fading to 0 at separationRadius
+	float alignment;		// per second, how fast an agent matches its neighbours' average velocity
+	float cohesion;			// per second squared, pull towards its neighbours' average position
+	int maxNeighbours;		// neighbours counted per agent, bounds the cost in a packed crowd
+
+	CrowdSettings() : neighbourRadius(32.0f), separationRadius(16.0f), separation(3000.0f),
+		alignment(1.0f), cohesion(0.2f), maxNeighbours(16) {}
+};
+
+/**
+ * Separation, alignment and cohesion (flocking) forces for many agents, e.g. an EnemySwarm,
+ * so agents seeking the same point spread around it instead of piling onto one pixel.
+ *
+ * Every update() sorts the agents into a spatial hash of neighbourRadius sized cells
+ * (a counting sort, linear in the agents) and each agent only looks at the 3x3 cells around it,
+ * stopping after maxNeighbours. The cost grows linearly with the agents rather than with
+ * their square, and the forces are computed in parallel on the job system
+ */
+class Crowd {
+	private:
+		CrowdSettings settings;
+		std::unique_ptr<JobSystem> jobs;	// nullptr while single threaded
+
+		// spatial hash, agents sorted by bucket with their positions and velocities copied in that order
+		float invCellSize;
+		Uint32 bucketMask;
+		std::vector<int> bucketStart;		// bucketMask + 2 entries, agents of bucket b are [bucketStart[b], bucketStart[b + 1])
+		std::vector<Uint32> agentBucket;
+		std::vector<int> sortedAgent;
+		std::vector<float> sortedX, sortedY, sortedVX, sortedVY;
+
+		std::vector<float> forceX, forceY;
+
+		Uint32 getBucket(const int & cellX, const int & cellY) const;
+		void buildHash(const float * x, const float * y, const float * vx, const float * vy, const int & count);
+		void computeRange(const int & begin, const int & end);
+	public:
+		explicit Crowd(const CrowdSettings & settings = CrowdSettings());
+
+		const CrowdSettings & getSettings() const { return settings; }
+
+		/**
+		* Throws if a radius is not positive, separationRadius is above neighbourRadius
+		* (only neighbours are pushed apart) or maxNeighbours is below 1
+		*/
+		void setSettings(const CrowdSettings & s);
+
+		/**
+		* @param count - threads sharing update(), including the caller. 0 picks the number of hardware threads
+		*/
+		void setThreadCount(const int & count);
+		int getThreadCount() const { return jobs ? jobs->getThreadCount() : 1; }
+
+		/**
+		* Computes the force on each of count agents, given as separate arrays of positions and velocities
+		*/
+		void update(const float * x, const float * y, const float * vx, const float * vy, const int & count);
+
+		/**
+		* @return accelerations in pixels per second squared of the last update(), one per agent in the order given
+		*/
+		const float * getForcesX() const { return forceX.data(); }
+		const float * getForcesY() const { return forceY.data(); }
+		Vector2f getForce(const int & i) const { return Vector2f(forceX[i], forceY[i]); }
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "DebugOverlay.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+	#include <psapi.h>
+	#pragma comment(lib, "psapi.lib")
+#elif defined(__APPLE__)
+	#include <mach/mach.h>
+#elif defined(__linux__)
+	#include <unistd.h>
+#endif
+
+static const char * OVERLAY_FONT_FILE = "res/fonts/arial.ttf";
+static const int OVERLAY_FONT_SIZE = 12;
+
+static const int OVERLAY_WIDTH = 260;
+static const int OVERLAY_PADDING = 6;
+static const int OVERLAY_GRAPH_HEIGHT = 48;
+static const int OVERLAY_GRAPH_BAR_WIDTH = 2;
+static const float OVERLAY_GRAPH_MAX_MS = 33.3f;	// top of the graph, two 60Hz frames
+static const float OVERLAY_FRAME_BUDGET_MS = 16.67f;
+static const int OVERLAY_BAR_WIDTH = 110;		// width of a full frame budget in section bars
+static const int OVERLAY_BAR_X = 64;			// section bars start this far right of the names
+static const int OVERLAY_SAMPLE_FRAMES = 30;		// frames between stats samples, and text layer redraws
+
+static const SDL_Color OVERLAY_COLOR_BG = { 0x10, 0x10, 0x10, 0xFF };
+
+DebugOverlay::DebugOverlay(std::shared_ptr<GraphicsEngine> gfx, std::shared_ptr<PhysicsEngine> physics)
+	: gfx(gfx), physics(physics), fontLoaded(false), visible(false), entityCount(0), memoryBytes(0), sampleCountdown(0), textLayer(nullptr) {}
+
+DebugOverlay::~DebugOverlay() {
+	if (textLayer)
+		SDL_DestroyTexture(textLayer);
+}
+
+void DebugOverlay::loadFont() {
+	fontLoaded = true;	// only try once, the overlay is optional
+
+	// the font is only needed while baking the atlas, so it is not cached by ResourceManager
+	TTF_Font * ttf = TTF_OpenFont(OVERLAY_FONT_FILE, OVERLAY_FONT_SIZE);
+	if (nullptr == ttf) {
+		std::cout << "DebugOverlay: failed to load font " << OVERLAY_FONT_FILE << " " << TTF_GetError() << std::endl;
+		return;
+	}
+
+	font.build(ttf);
+	TTF_CloseFont(ttf);
+
+	if (font.isReady())
+		textLayer = GFX::createTargetTexture(OVERLAY_WIDTH - OVERLAY_PADDING * 2, getPanelHeight() - OVERLAY_PADDING * 2);
+}
+
+int DebugOverlay::getPanelHeight() const {
+	int lineH = font.isReady() ? font.getLineHeight() : 14;
+	return OVERLAY_PADDING * 2 + lineH * (5 + PROFILE_LAST) + OVERLAY_GRAPH_HEIGHT + OVERLAY_PADDING;
+}
+
+void DebugOverlay::render() {
+	if (!visible)
+		return;
+
+	if (!fontLoaded)
+		loadFont();
+
+	// read before drawing anything so the overlay does not count itself
+	Uint32 sceneDrawCalls = gfx->getDrawCallCount();
+
+	bool sample = --sampleCountdown <= 0;
+	if (sample) {
+		memoryBytes = getProcessMemoryUsage();
+		sampleCountdown = OVERLAY_SAMPLE_FRAMES;
+	}
+
+	int lineH = font.isReady() ? font.getLineHeight() : 14;
+	int panelH = getPanelHeight();
+	int x = 10;
+	int y = gfx->getCurrentWindowSize().h - panelH - 10;
+
+	SDL_Rect panel = { x, y, OVERLAY_WIDTH, panelH };
+	gfx->setDrawColor(OVERLAY_COLOR_BG);
+	gfx->fillRect(&panel);
+
+	x += OVERLAY_PADDING;
+	y += OVERLAY_PADDING;
+
+	// redrawn whole on every sample, which also restores it if the renderer lost its targets
+	if (sample && textLayer) {
+		if (gfx->setRenderTarget(textLayer)) {
+			renderText(0, 0, sceneDrawCalls);
+			gfx->setRenderTarget(nullptr);
+		}
+		else {
+			SDL_DestroyTexture(textLayer);
+			textLayer = nullptr;
+		}
+	}
+
+	int graphY = y + lineH * 2;
+	renderFrameGraph(x, graphY);
+
+	// per section bars follow every frame, a full bar is one 60Hz frame
+	int barY = graphY + OVERLAY_GRAPH_HEIGHT + OVERLAY_PADDING;
+	for (int i = 0; i < PROFILE_LAST; ++i) {
+		float ms = Profiler::getSectionMs((ProfileSection)i);
+
+		int barW = (int)(OVERLAY_BAR_WIDTH * ms / OVERLAY_FRAME_BUDGET_MS);
+		if (barW > OVERLAY_BAR_WIDTH) barW = OVERLAY_BAR_WIDTH;
+		if (barW < 1) barW = 1;
+
+		SDL_Rect bar = { x + OVERLAY_BAR_X, barY + lineH * i + 3, barW, lineH - 6 };
+		gfx->setDrawColor(ms > OVERLAY_FRAME_BUDGET_MS * 0.5f ? SDL_COLOR_ORANGE : SDL_COLOR_AQUA);
+		gfx->fillRect(&bar);
+	}
+
+	if (textLayer) {
+		SDL_Rect dst = { x, y, OVERLAY_WIDTH - OVERLAY_PADDING * 2, panelH - OVERLAY_PADDING * 2 };
+		gfx->drawTexture(textLayer, &dst);
+	}
+	else {
+		renderText(x, y, sceneDrawCalls);
+	}
+}
+
+void DebugOverlay::renderText(const int & x, const int & top, const Uint32 & sceneDrawCalls) {
+	if (!font.isReady())
+		return;
+
+	int lineH = font.getLineHeight();
+	int y = top;
+
+	char line[96];
+	float frameMs = Profiler::getFrameMs();
+	snprintf(line, sizeof(line), "FRAME %5.2f ms  FPS %u", frameMs, gfx->getAverageFPS());
+	font.draw(gfx.get(), line, x, y, SDL_COLOR_WHITE);
+	y += lineH;
+
+	const StatsSummary & frameStats = Profiler::getFrameStats();
+	snprintf(line, sizeof(line), "p50 %5.2f  p95 %5.2f  p99 %5.2f", frameStats.p50, frameStats.p95, frameStats.p99);
+	font.draw(gfx.get(), line, x, y, SDL_COLOR_WHITE);
+	y += lineH;
+
+	// the graph sits here, drawn by render()
+	y += OVERLAY_GRAPH_HEIGHT + OVERLAY_PADDING;
+
+	// section names left of the bars, times right of a full bar
+	for (int i = 0; i < PROFILE_LAST; ++i) {
+		ProfileSection section = (ProfileSection)i;
+		font.draw(gfx.get(), Profiler::getSectionName(section), x, y, SDL_COLOR_WHITE);
+		snprintf(line, sizeof(line), "%6.2f ms", Profiler::getSectionMs(section));
+		font.draw(gfx.get(), line, x + OVERLAY_BAR_X + OVERLAY_BAR_WIDTH + 4, y, SDL_COLOR_WHITE);
+		y += lineH;
+	}
+
+	snprintf(line, sizeof(line), "draw calls %u (last frame %u)", sceneDrawCalls, gfx->getLastDrawCallCount());
+	font.draw(gfx.get(), line, x, y, SDL_COLOR_WHITE);
+	y += lineH;
+
+	snprintf(line, sizeof(line), "entities %d  bodies %d (%d awake)", entityCount, physics->getObjectCount(), physics->getAwakeCount());
+	font.draw(gfx.get(), line, x, y, SDL_COLOR_WHITE);
+	y += lineH;
+
+	if (memoryBytes > 0)
+		snprintf(line, sizeof(line), "memory %.1f MB", memoryBytes / (1024.0 * 1024.0));
+	else
+		snprintf(line, sizeof(line), "memory n/a");
+	font.draw(gfx.get(), line, x, y, SDL_COLOR_WHITE);
+}
+
+void DebugOverlay::renderFrameGraph(const int & x, const int & y) {
+	// split bars by color so each color is a single batched fill
+	SDL_Rect okBars[PROFILE_HISTORY];
+	SDL_Rect slowBars[PROFILE_HISTORY];
+	int okCount = 0, slowCount = 0;
+
+	int graphBottom = y + OVERLAY_GRAPH_HEIGHT;
+	for (int i = 0; i < PROFILE_HISTORY; ++i) {
+		// oldest frame on the left
+		float ms = Profiler::getFrameHistory(PROFILE_HISTORY - 1 - i);
+		int h = (int)(OVERLAY_GRAPH_HEIGHT * ms / OVERLAY_GRAPH_MAX_MS);
+		if (h > OVERLAY_GRAPH_HEIGHT) h = OVERLAY_GRAPH_HEIGHT;
+		if (h < 1) h = 1;
+
+		SDL_Rect bar = { x + i * OVERLAY_GRAPH_BAR_WIDTH, graphBottom - h, OVERLAY_GRAPH_BAR_WIDTH, h };
+		if (ms > OVERLAY_FRAME_BUDGET_MS + 1.0f)	// allow for SDL_Delay() granularity
+			slowBars[slowCount++] = bar;
+		else
+			okBars[okCount++] = bar;
+	}
+
+	gfx->setDrawColor(SDL_COLOR_GREEN);
+	if (okCount > 0) gfx->fillRects(okBars, okCount);
+	gfx->setDrawColor(SDL_COLOR_RED);
+	if (slowCount > 0) gfx->fillRects(slowBars, slowCount);
+
+	// frame budget marker
+	int budgetY = graphBottom - (int)(OVERLAY_GRAPH_HEIGHT * OVERLAY_FRAME_BUDGET_MS / OVERLAY_GRAPH_MAX_MS);
+	gfx->setDrawColor(SDL_COLOR_YELLOW);
+	gfx->drawLine(Point2(x, budgetY), Point2(x + PROFILE_HISTORY * OVERLAY_GRAPH_BAR_WIDTH, budgetY));
+}
+
+size_t DebugOverlay::getProcessMemoryUsage() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return (size_t)counters.WorkingSetSize;
+	return 0;
+#elif defined(__APPLE__)
+	mach_task_basic_info info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+		return (size_t)info.resident_size;
+	return 0;
+#elif defined(__linux__)
+	long pages = 0, resident = 0;
+	FILE * statm = fopen("/proc/self/statm", "r");
+	if (nullptr == statm)
+		return 0;
+	if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+		resident = 0;
+	fclose(statm);
+	return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+#else
+	return 0;
+#endif
+}
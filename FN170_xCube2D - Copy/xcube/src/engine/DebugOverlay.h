@@ -0,0 +1,73 @@
+#ifndef __DEBUG_OVERLAY_H__
+#define __DEBUG_OVERLAY_H__
+
+#include <memory>
+
+#include "GraphicsEngine.h"
+#include "PhysicsEngine.h"
+#include "BitmapFont.h"
+#include "Profiler.h"
+
+/**
+ * Engine performance overlay, toggled with F3
+ *
+ * Shows frame time graph, per section profiler times, draw calls,
+ * entity / physics body counts and process memory.
+ * All text goes through a BitmapFont into one texture, redrawn when the stats are sampled
+ * (every 30 frames), so in between the text costs a single texture copy.
+ * SDL 2.0.9 does not batch render copies, drawing the glyphs every frame would be one copy each
+ */
+class DebugOverlay {
+	friend class XCube2Engine;
+	private:
+		std::shared_ptr<GraphicsEngine> gfx;
+		std::shared_ptr<PhysicsEngine> physics;
+
+		BitmapFont font;
+		bool fontLoaded;
+		bool visible;
+
+		int entityCount;
+
+		// the stats are sampled, memory is not free to read on all platforms and
+		// the text is drawn into textLayer only then, so it costs one texture copy in between
+		size_t memoryBytes;
+		int sampleCountdown;
+		SDL_Texture * textLayer;	// nullptr if the renderer cannot draw into textures, the text is then drawn every frame
+
+		DebugOverlay(std::shared_ptr<GraphicsEngine> gfx, std::shared_ptr<PhysicsEngine> physics);
+
+		void loadFont();
+		int getPanelHeight() const;
+		void renderText(const int & x, const int & top, const Uint32 & sceneDrawCalls);
+		void renderFrameGraph(const int & x, const int & y);
+	public:
+		~DebugOverlay();
+
+		void toggle() { setVisible(!visible); }
+		void setVisible(bool b) {
+			if (b && !visible)
+				sampleCountdown = 0;	// the text layer is stale
+			visible = b;
+		}
+		bool isVisible() { return visible; }
+
+		/**
+		* Games report how many entities they are simulating
+		* the engine does not own entities so cannot count them itself
+		*/
+		void setEntityCount(const int & count) { entityCount = count; }
+
+		/**
+		* Draws the overlay if visible
+		* Call after the scene has been drawn, before GraphicsEngine::showScreen()
+		*/
+		void render();
+
+		/**
+		* @return resident memory of this process in bytes, 0 if unknown
+		*/
+		static size_t getProcessMemoryUsage();
+};
+
+#endif
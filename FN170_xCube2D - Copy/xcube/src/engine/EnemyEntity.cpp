@@ -11,6 +11,7 @@ EnemyEntity::EnemyEntity()
         Point2{ position.x, position.y },
         48.0f, 48.0f
     );
+    physics->setShape(CollisionShape::circle(24.0f)); //enemy sprite is round, corners shouldn't count as hits
 
     //initial render dimensions
     dest = { 0, 0, 48, 48 };
@@ -48,9 +49,9 @@ void EnemyEntity::update(float, const Point2& playerPos)
     dest.x = (int)position.x;
     dest.y = (int)position.y;
 
-    //sync physics body with logical position
+    //sync physics body with the sprite center, position is the top left corner
     if (physics)
-        physics->setCenter(position);
+        physics->setCenter(Point2(position.x + dest.w / 2, position.y + dest.h / 2));
 }
 
 //render enemy sprite if active
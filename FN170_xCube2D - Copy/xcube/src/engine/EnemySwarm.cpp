@@ -0,0 +1,244 @@
+#include "EnemySwarm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define XCUBE_SWARM_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define XCUBE_SWARM_SSE
+#endif
+
+EnemySwarm::EnemySwarm(const SwarmSettings & settings) : settings(settings) {}
+
+int EnemySwarm::add(const Vector2f & position, const Vector2f & velocity) {
+	posX.push_back(position.x);
+	posY.push_back(position.y);
+	velX.push_back(velocity.x);
+	velY.push_back(velocity.y);
+	return (int)posX.size() - 1;
+}
+
+void EnemySwarm::remove(const int & i) {
+	posX[i] = posX.back(); posX.pop_back();
+	posY[i] = posY.back(); posY.pop_back();
+	velX[i] = velX.back(); velX.pop_back();
+	velY[i] = velY.back(); velY.pop_back();
+}
+
+void EnemySwarm::clear() {
+	posX.clear(); posY.clear();
+	velX.clear(); velY.clear();
+}
+
+void EnemySwarm::reserve(const int & count) {
+	posX.reserve(count); posY.reserve(count);
+	velX.reserve(count); velY.reserve(count);
+}
+
+void EnemySwarm::setThreadCount(const int & count) {
+	if (count < 0)
+		throw EngineException("Invalid swarm thread count:", std::to_string(count));
+
+	int threads = count > 0 ? count : (int)std::thread::hardware_concurrency();
+	if (threads <= 1)
+		jobs.reset();
+	else if (!jobs || jobs->getThreadCount() != threads)
+		jobs.reset(new JobSystem(threads));
+}
+
+/* STEERING */
+
+// everything one pass needs, the same for every enemy
+struct SteerParams {
+	float targetX, targetY;
+	float maxSpeed;
+	float arriveRadius;
+	float arriveSlope;	// maxSpeed / arriveRadius
+	float maxStep;		// largest velocity change this update
+	float dt;
+};
+
+// the SIMD paths below do the same operations in the same order, so all paths agree
+static inline void steerOne(const SteerParams & p, const float & tx, const float & ty, float & x, float & y, float & vx, float & vy) {
+	float dx = tx - x, dy = ty - y;
+	float dist = std::sqrt(dx * dx + dy * dy);
+	float speed = dist < p.arriveRadius ? dist * p.arriveSlope : p.maxSpeed;
+	float scale = dist > 0.0f ? speed / dist : 0.0f;
+
+	float sx = dx * scale - vx, sy = dy * scale - vy;
+	float len = std::sqrt(sx * sx + sy * sy);
+	float clamp = len > p.maxStep ? p.maxStep / len : 1.0f;
+
+	vx += sx * clamp;
+	vy += sy * clamp;
+	x += vx * p.dt;
+	y += vy * p.dt;
+}
+
+// PER_ENEMY reads a target per enemy from targetX / targetY, otherwise everyone steers to p's target
+template <bool PER_ENEMY>
+static void steerRange(const SteerParams & p, const float * targetX, const float * targetY, float * x, float * y, float * vx, float * vy, int i, const int & end) {
+#if defined(XCUBE_SWARM_AVX)
+	const __m256 tx = _mm256_set1_ps(p.targetX), ty = _mm256_set1_ps(p.targetY);
+	const __m256 maxSpeed = _mm256_set1_ps(p.maxSpeed), arriveRadius = _mm256_set1_ps(p.arriveRadius);
+	const __m256 arriveSlope = _mm256_set1_ps(p.arriveSlope), maxStep = _mm256_set1_ps(p.maxStep);
+	const __m256 dt = _mm256_set1_ps(p.dt), zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+	for (; i + 8 <= end; i += 8) {
+		__m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i);
+		__m256 pvx = _mm256_loadu_ps(vx + i), pvy = _mm256_loadu_ps(vy + i);
+
+		__m256 dx = _mm256_sub_ps(PER_ENEMY ? _mm256_loadu_ps(targetX + i) : tx, px);
+		__m256 dy = _mm256_sub_ps(PER_ENEMY ? _mm256_loadu_ps(targetY + i) : ty, py);
+		__m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		__m256 speed = _mm256_blendv_ps(maxSpeed, _mm256_mul_ps(dist, arriveSlope), _mm256_cmp_ps(dist, arriveRadius, _CMP_LT_OQ));
+		__m256 scale = _mm256_and_ps(_mm256_div_ps(speed, dist), _mm256_cmp_ps(dist, zero, _CMP_GT_OQ));
+
+		__m256 sx = _mm256_sub_ps(_mm256_mul_ps(dx, scale), pvx), sy = _mm256_sub_ps(_mm256_mul_ps(dy, scale), pvy);
+		__m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy)));
+		__m256 clamp = _mm256_blendv_ps(one, _mm256_div_ps(maxStep, len), _mm256_cmp_ps(len, maxStep, _CMP_GT_OQ));
+
+		pvx = _mm256_add_ps(pvx, _mm256_mul_ps(sx, clamp));
+		pvy = _mm256_add_ps(pvy, _mm256_mul_ps(sy, clamp));
+		_mm256_storeu_ps(vx + i, pvx);
+		_mm256_storeu_ps(vy + i, pvy);
+		_mm256_storeu_ps(x + i, _mm256_add_ps(px, _mm256_mul_ps(pvx, dt)));
+		_mm256_storeu_ps(y + i, _mm256_add_ps(py, _mm256_mul_ps(pvy, dt)));
+	}
+#elif defined(XCUBE_SWARM_SSE)
+	const __m128 tx = _mm_set1_ps(p.targetX), ty = _mm_set1_ps(p.targetY);
+	const __m128 maxSpeed = _mm_set1_ps(p.maxSpeed), arriveRadius = _mm_set1_ps(p.arriveRadius);
+	const __m128 arriveSlope = _mm_set1_ps(p.arriveSlope), maxStep = _mm_set1_ps(p.maxStep);
+	const __m128 dt = _mm_set1_ps(p.dt), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+
+	for (; i + 4 <= end; i += 4) {
+		__m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+		__m128 pvx = _mm_loadu_ps(vx + i), pvy = _mm_loadu_ps(vy + i);
+
+		__m128 dx = _mm_sub_ps(PER_ENEMY ? _mm_loadu_ps(targetX + i) : tx, px);
+		__m128 dy = _mm_sub_ps(PER_ENEMY ? _mm_loadu_ps(targetY + i) : ty, py);
+		__m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+		// SSE has no blend, masks pick the lanes
+		__m128 arriving = _mm_cmplt_ps(dist, arriveRadius);
+		__m128 speed = _mm_or_ps(_mm_and_ps(arriving, _mm_mul_ps(dist, arriveSlope)), _mm_andnot_ps(arriving, maxSpeed));
+		__m128 scale = _mm_and_ps(_mm_div_ps(speed, dist), _mm_cmpgt_ps(dist, zero));
+
+		__m128 sx = _mm_sub_ps(_mm_mul_ps(dx, scale), pvx), sy = _mm_sub_ps(_mm_mul_ps(dy, scale), pvy);
+		__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)));
+		__m128 limited = _mm_cmpgt_ps(len, maxStep);
+		__m128 clamp = _mm_or_ps(_mm_and_ps(limited, _mm_div_ps(maxStep, len)), _mm_andnot_ps(limited, one));
+
+		pvx = _mm_add_ps(pvx, _mm_mul_ps(sx, clamp));
+		pvy = _mm_add_ps(pvy, _mm_mul_ps(sy, clamp));
+		_mm_storeu_ps(vx + i, pvx);
+		_mm_storeu_ps(vy + i, pvy);
+		_mm_storeu_ps(x + i, _mm_add_ps(px, _mm_mul_ps(pvx, dt)));
+		_mm_storeu_ps(y + i, _mm_add_ps(py, _mm_mul_ps(pvy, dt)));
+	}
+#endif
+
+	// remainder, or everything without SIMD
+	for (; i < end; ++i)
+		steerOne(p, PER_ENEMY ? targetX[i] : p.targetX, PER_ENEMY ? targetY[i] : p.targetY, x[i], y[i], vx[i], vy[i]);
+}
+
+static SteerParams makeParams(const SwarmSettings & s, const Vector2f & target, const float & dt) {
+	SteerParams p;
+	p.targetX = target.x;
+	p.targetY = target.y;
+	p.maxSpeed = s.maxSpeed;
+	p.arriveRadius = s.arriveRadius;
+	p.arriveSlope = s.arriveRadius > 0.0f ? s.maxSpeed / s.arriveRadius : 0.0f;
+	p.maxStep = s.maxAcceleration * dt;
+	p.dt = dt;
+	return p;
+}
+
+void EnemySwarm::update(const Vector2f & target, const float & dt) {
+	const SteerParams p = makeParams(settings, target, dt);
+	const int count = getCount();
+	const int chunks = (count + SWARM_JOB_CHUNK - 1) / SWARM_JOB_CHUNK;
+
+	if (!jobs || chunks < 2) {
+		steerRange<false>(p, nullptr, nullptr, posX.data(), posY.data(), velX.data(), velY.data(), 0, count);
+		return;
+	}
+
+	// every enemy only touches its own slots, so chunks need no merging
+	jobs->parallelFor(chunks, [this, &p, count](int chunk) {
+		int begin = chunk * SWARM_JOB_CHUNK;
+		steerRange<false>(p, nullptr, nullptr, posX.data(), posY.data(), velX.data(), velY.data(), begin, std::min(count, begin + SWARM_JOB_CHUNK));
+	});
+}
+
+void EnemySwarm::updateScalar(const Vector2f & target, const float & dt) {
+	const SteerParams p = makeParams(settings, target, dt);
+	for (int i = 0; i < getCount(); ++i)
+		steerOne(p, p.targetX, p.targetY, posX[i], posY[i], velX[i], velY[i]);
+}
+
+void EnemySwarm::flowTargets(const FlowField & field, const Vector2f & target, const int & begin, const int & end) {
+	// a point ahead along the cell's direction, further than arriveRadius so the enemy keeps full speed
+	const float ahead = settings.arriveRadius + field.getCellSize();
+	for (int i = begin; i < end; ++i) {
+		Vector2f d = field.getDirection(Vector2f(posX[i], posY[i]));
+		if (d.x == 0 && d.y == 0) {
+			targetX[i] = target.x;
+			targetY[i] = target.y;
+		}
+		else {
+			targetX[i] = posX[i] + d.x * ahead;
+			targetY[i] = posY[i] + d.y * ahead;
+		}
+	}
+}
+
+void EnemySwarm::update(const FlowField & field, const Vector2f & target, const float & dt) {
+	const SteerParams p = makeParams(settings, target, dt);
+	const int count = getCount();
+	const int chunks = (count + SWARM_JOB_CHUNK - 1) / SWARM_JOB_CHUNK;
+	targetX.resize(count);
+	targetY.resize(count);
+
+	if (!jobs || chunks < 2) {
+		flowTargets(field, target, 0, count);
+		steerRange<true>(p, targetX.data(), targetY.data(), posX.data(), posY.data(), velX.data(), velY.data(), 0, count);
+		return;
+	}
+
+	jobs->parallelFor(chunks, [this, &p, &field, &target, count](int chunk) {
+		int begin = chunk * SWARM_JOB_CHUNK, end = std::min(count, begin + SWARM_JOB_CHUNK);
+		flowTargets(field, target, begin, end);
+		steerRange<true>(p, targetX.data(), targetY.data(), posX.data(), posY.data(), velX.data(), velY.data(), begin, end);
+	});
+}
+
+void EnemySwarm::applyForces(const float * forceX, const float * forceY, const float & dt) {
+	const float maxSpeed2 = settings.maxSpeed * settings.maxSpeed;
+	for (int i = 0; i < getCount(); ++i) {
+		float vx = velX[i] + forceX[i] * dt, vy = velY[i] + forceY[i] * dt;
+		const float speed2 = vx * vx + vy * vy;
+		if (speed2 > maxSpeed2) {
+			const float scale = settings.maxSpeed / std::sqrt(speed2);
+			vx *= scale;
+			vy *= scale;
+		}
+		velX[i] = vx;
+		velY[i] = vy;
+	}
+}
+
+const char * getSwarmPath() {
+#if defined(XCUBE_SWARM_AVX)
+	return "avx";
+#elif defined(XCUBE_SWARM_SSE)
+	return "sse";
+#else
+	return "scalar";
+#endif
+}
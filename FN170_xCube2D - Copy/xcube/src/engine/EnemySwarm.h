@@ -0,0 +1,108 @@
+#ifndef __ENEMY_SWARM_H__
+#define __ENEMY_SWARM_H__
+
+#include <memory>
+#include <vector>
+
+#include "EngineCommon.h"
+#include "GameMath.h"
+#include "FlowField.h"
+#include "JobSystem.h"
+
+static const int SWARM_JOB_CHUNK = 4096;	// enemies per job when the update is split over threads
+
+/**
+ * Steering parameters shared by every enemy of a swarm
+ */
+struct SwarmSettings {
+	float maxSpeed;			// pixels per second
+	float maxAcceleration;	// pixels per second squared, how fast an enemy turns
+	float arriveRadius;		// enemies slow down linearly inside this distance of the target
+
+	SwarmSettings() : maxSpeed(90.0f), maxAcceleration(360.0f), arriveRadius(32.0f) {}
+};
+
+/**
+ * Positions and velocities of many enemies stored as separate arrays (structure of arrays),
+ * so one update steers all of them towards the target with SIMD, 4 (SSE) or 8 (AVX) at a time.
+ *
+ * Steering is seek with arrive: the desired velocity points at the target at maxSpeed,
+ * scaled down inside arriveRadius, and the velocity turns towards it by at most maxAcceleration * dt.
+ * Enemies are points, collision and rendering are up to the caller
+ */
+class EnemySwarm {
+	private:
+		std::vector<float> posX, posY;
+		std::vector<float> velX, velY;
+		std::vector<float> targetX, targetY;	// per enemy steering targets of a flow field update
+		SwarmSettings settings;
+		std::unique_ptr<JobSystem> jobs;	// nullptr while single threaded
+
+		void flowTargets(const FlowField & field, const Vector2f & target, const int & begin, const int & end);
+	public:
+		explicit EnemySwarm(const SwarmSettings & settings = SwarmSettings());
+
+		/**
+		* @return index of the new enemy
+		*/
+		int add(const Vector2f & position, const Vector2f & velocity = Vector2f(0, 0));
+
+		/**
+		* Removes enemy i, the last enemy takes index i
+		*/
+		void remove(const int & i);
+		void clear();
+		void reserve(const int & count);
+
+		int getCount() const { return (int)posX.size(); }
+
+		Vector2f getPosition(const int & i) const { return Vector2f(posX[i], posY[i]); }
+		void setPosition(const int & i, const Vector2f & p) { posX[i] = p.x; posY[i] = p.y; }
+		Vector2f getVelocity(const int & i) const { return Vector2f(velX[i], velY[i]); }
+		void setVelocity(const int & i, const Vector2f & v) { velX[i] = v.x; velY[i] = v.y; }
+
+		const float * getPositionsX() const { return posX.data(); }
+		const float * getPositionsY() const { return posY.data(); }
+		const float * getVelocitiesX() const { return velX.data(); }
+		const float * getVelocitiesY() const { return velY.data(); }
+
+		const SwarmSettings & getSettings() const { return settings; }
+		void setSettings(const SwarmSettings & s) { settings = s; }
+
+		/**
+		* @param count - threads sharing update(), including the caller. 0 picks the number of hardware threads
+		*/
+		void setThreadCount(const int & count);
+		int getThreadCount() const { return jobs ? jobs->getThreadCount() : 1; }
+
+		/**
+		* Steers every enemy towards target and moves it by its new velocity
+		*/
+		void update(const Vector2f & target, const float & dt);
+
+		/**
+		* Steers every enemy along the flow field's direction at its cell, so enemies find their way
+		* around obstacles. Enemies in the target's cell, or where the field has no direction, seek target directly
+		*/
+		void update(const FlowField & field, const Vector2f & target, const float & dt);
+
+		/**
+		* Adds accelerations, e.g. Crowd::getForcesX() / Y(), to the velocities, keeping them within maxSpeed.
+		* Call before update(), which then steers from the pushed velocities and moves the enemies
+		* @param forceX, forceY - pixels per second squared, one per enemy
+		*/
+		void applyForces(const float * forceX, const float * forceY, const float & dt);
+
+		/**
+		* Same as update() one enemy at a time on the calling thread, gives the same results.
+		* The reference for tests and benchmarks
+		*/
+		void updateScalar(const Vector2f & target, const float & dt);
+};
+
+/**
+ * @return "avx", "sse" or "scalar", the path compiled into EnemySwarm::update()
+ */
+const char * getSwarmPath();
+
+#endif
@@ -0,0 +1,113 @@
+#include "EntityComponents.h"
+
+#include <cmath>
+
+EntityId spawnPlayer(EntityWorld & world, const Vector2f & center, SDL_Texture * texture, const int & width, const int & height) {
+	std::shared_ptr<PhysicsObject> physics = std::make_shared<PhysicsObject>(Point2((int)center.x, (int)center.y), 128.0f, 128.0f);
+	physics->setPosition(center);
+	return world.create(Transform(center), Sprite(texture, width, height), Health(3, 10), Body(physics), PlayerTag());
+}
+
+EntityId spawnEnemy(EntityWorld & world, const Vector2f & center, SDL_Texture * texture, const EntityId & target) {
+	std::shared_ptr<PhysicsObject> physics = std::make_shared<PhysicsObject>(Point2((int)center.x, (int)center.y), 48.0f, 48.0f);
+	physics->setPosition(center);
+	physics->setShape(CollisionShape::circle(24.0f));
+	return world.create(Transform(center), Sprite(texture, 48, 48), Health(3, 10), Body(physics), Chase(target, 1.4f), EnemyTag());
+}
+
+EntityId spawnProjectile(EntityWorld & world, const Vector2f & start, const Vector2f & direction, const float & screenWidth, const float & screenHeight) {
+	std::shared_ptr<PhysicsObject> physics = std::make_shared<PhysicsObject>(Point2((int)start.x, (int)start.y), 16.0f, 16.0f);
+	physics->setPosition(start);
+	physics->setBullet(true);
+	physics->setShape(CollisionShape::circle(8.0f));
+	return world.create(Transform(start), Velocity(normalise(direction) * 400.0f), CircleSprite(4, SDL_COLOR_WHITE),
+		Body(physics), Offscreen(screenWidth, screenHeight), ProjectileTag());
+}
+
+// a system's query, rebuilt only when the system runs on a different world
+template <class... C>
+struct SystemQuery {
+	EntityWorld * world;
+	EntityQuery<C...> query;
+
+	SystemQuery() : world(nullptr) {}
+
+	EntityQuery<C...> & get(EntityWorld & w) {
+		if (world != &w) {
+			world = &w;
+			query = w.query<C...>();
+		}
+		return query;
+	}
+};
+
+void addDefaultSystems(SystemScheduler & scheduler) {
+	SystemQuery<Health> health;
+	scheduler.add("health", [health](EntityWorld & world, const float &) mutable {
+		health.get(world).forEachEntity([&world](const EntityId & id, Health & h) {
+			h.damage.update();
+			if (h.damage.isDead())
+				world.destroyDeferred(id);
+		});
+	}).writes<Health>();
+
+	// moves like EnemyEntity::update(), a fixed step per update towards the target
+	SystemQuery<Transform, Chase> chase;
+	scheduler.add("chase", [chase](EntityWorld & world, const float &) mutable {
+		chase.get(world).forEach([&world](Transform & t, Chase & c) {
+			const Transform * target = world.get<Transform>(c.target);
+			if (nullptr == target)
+				return;
+
+			float dx = target->position.x - t.position.x;
+			float dy = target->position.y - t.position.y;
+			float len = std::sqrt(dx * dx + dy * dy);
+			if (len > 0.01f) {
+				t.position.x += dx / len * c.speed;
+				t.position.y += dy / len * c.speed;
+			}
+		});
+	}).reads<Chase>().writes<Transform>();
+
+	// plain arrays, so the loop over a chunk can be vectorised
+	SystemQuery<Transform, Velocity> velocity;
+	scheduler.add("velocity", [velocity](EntityWorld & world, const float & dt) mutable {
+		velocity.get(world).forEachChunk([dt](int count, const EntityId *, Transform * t, Velocity * v) {
+			for (int i = 0; i < count; ++i) {
+				t[i].position.x += v[i].value.x * dt;
+				t[i].position.y += v[i].value.y * dt;
+			}
+		});
+	}).reads<Velocity>().writes<Transform>();
+
+	SystemQuery<Transform, Offscreen> offscreen;
+	scheduler.add("offscreen", [offscreen](EntityWorld & world, const float &) mutable {
+		offscreen.get(world).forEachEntity([&world](const EntityId & id, const Transform & t, const Offscreen & o) {
+			if (t.position.x < 0 || t.position.x > o.width || t.position.y < 0 || t.position.y > o.height)
+				world.destroyDeferred(id);
+		});
+	}).reads<Transform, Offscreen>();
+
+	SystemQuery<Transform, Body> bodies;
+	scheduler.add("bodies", [bodies](EntityWorld & world, const float &) mutable {
+		bodies.get(world).forEach([](const Transform & t, Body & b) {
+			if (b.physics)
+				b.physics->setPosition(t.position);
+		});
+	}).reads<Transform>().writes<Body>();
+}
+
+void renderEntities(EntityWorld & world, GraphicsEngine * gfx) {
+	world.query<Transform, Sprite>().forEach([gfx](const Transform & t, Sprite & s) {
+		if (nullptr == s.texture)
+			return;
+
+		SDL_Rect dest = { (int)(t.position.x - s.width * 0.5f), (int)(t.position.y - s.height * 0.5f), s.width, s.height };
+		gfx->drawTexture(s.texture, s.src.w > 0 ? &s.src : nullptr, &dest, (double)t.angle);
+	});
+
+	world.query<Transform, CircleSprite>().forEach([gfx](const Transform & t, const CircleSprite & c) {
+		gfx->setDrawColor(c.color);
+		gfx->drawCircle(Point2((int)t.position.x, (int)t.position.y), c.radius);
+	});
+}
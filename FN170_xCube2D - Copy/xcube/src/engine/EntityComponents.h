@@ -0,0 +1,116 @@
+#ifndef __ENTITY_COMPONENTS_H__
+#define __ENTITY_COMPONENTS_H__
+
+#include <memory>
+
+#include <SDL.h>
+
+#include "GameMath.h"
+#include "GraphicsEngine.h"
+#include "DamageSystem.h"
+#include "PhysicsEngine.h"
+#include "EntityWorld.h"
+#include "SystemScheduler.h"
+
+/**
+ * Components the demo entity types are built from, so PlayerEntity, EnemyEntity
+ * and Projectile can live in an EntityWorld:
+ *
+ * player		Transform, Sprite, Health, Body, PlayerTag
+ * enemy		Transform, Sprite, Health, Body, Chase, EnemyTag
+ * projectile	Transform, Velocity, CircleSprite, Body, Offscreen, ProjectileTag
+ */
+
+struct Transform {
+	Vector2f position;	// center, in pixels
+	float angle;		// degrees, clockwise like SDL
+
+	Transform() : angle(0) {}
+	explicit Transform(const Vector2f & position, const float & angle = 0) : position(position), angle(angle) {}
+};
+
+struct Velocity {
+	Vector2f value;		// pixels per second
+
+	Velocity() {}
+	explicit Velocity(const Vector2f & value) : value(value) {}
+};
+
+struct Sprite {
+	SDL_Texture * texture;
+	SDL_Rect src;		// empty for the whole texture
+	int width, height;	// drawn size, centered on the transform
+
+	Sprite() : texture(nullptr), src{ 0, 0, 0, 0 }, width(0), height(0) {}
+	Sprite(SDL_Texture * texture, const int & width, const int & height) : texture(texture), src{ 0, 0, 0, 0 }, width(width), height(height) {}
+};
+
+struct CircleSprite {
+	float radius;
+	SDL_Color color;
+
+	CircleSprite() : radius(1), color(SDL_COLOR_WHITE) {}
+	CircleSprite(const float & radius, const SDL_Color & color) : radius(radius), color(color) {}
+};
+
+struct Health {
+	DamageSystem damage;
+
+	Health() {}
+	Health(const int & lives, const int & cooldownFrames) : damage(lives, cooldownFrames) {}
+};
+
+/**
+ * Physics body kept on the transform's position every update
+ */
+struct Body {
+	std::shared_ptr<PhysicsObject> physics;
+
+	Body() {}
+	explicit Body(const std::shared_ptr<PhysicsObject> & physics) : physics(physics) {}
+};
+
+/**
+ * Moves straight towards the target entity, stays put once the target is gone
+ */
+struct Chase {
+	EntityId target;
+	float speed;	// pixels per update, like EnemyEntity
+
+	Chase() : speed(0) {}
+	Chase(const EntityId & target, const float & speed) : target(target), speed(speed) {}
+};
+
+/**
+ * Destroys the entity once its transform leaves [0, width] x [0, height]
+ */
+struct Offscreen {
+	float width, height;
+
+	Offscreen() : width(0), height(0) {}
+	Offscreen(const float & width, const float & height) : width(width), height(height) {}
+};
+
+struct PlayerTag {};
+struct EnemyTag {};
+struct ProjectileTag {};
+
+/**
+ * Spawn helpers with the same sizes and bodies as the entity classes,
+ * a body is not added to any PhysicsEngine, that is up to the caller
+ */
+EntityId spawnPlayer(EntityWorld & world, const Vector2f & center, SDL_Texture * texture, const int & width, const int & height);
+EntityId spawnEnemy(EntityWorld & world, const Vector2f & center, SDL_Texture * texture, const EntityId & target);
+EntityId spawnProjectile(EntityWorld & world, const Vector2f & start, const Vector2f & direction, const float & screenWidth, const float & screenHeight);
+
+/**
+ * Adds the update systems of the components above, in order: health, chase, velocity, offscreen, bodies
+ */
+void addDefaultSystems(SystemScheduler & scheduler);
+
+/**
+ * Draws every Sprite and CircleSprite entity at its transform
+ */
+void renderEntities(EntityWorld & world, GraphicsEngine * gfx);
+
+#endif
@@ -0,0 +1,258 @@
+#include "EntityWorld.h"
+
+#include <string>
+
+/* COMPONENT REGISTRY */
+
+ComponentInfo ComponentRegistry::infos[MAX_COMPONENT_TYPES];
+std::atomic<int> ComponentRegistry::count(0);
+std::mutex ComponentRegistry::mutex;
+
+int ComponentRegistry::add(const ComponentInfo & info) {
+	// chunks are only aligned for fundamental types
+	if (info.align > alignof(std::max_align_t))
+		throw EngineException("Cannot register component:", "alignment above " + std::to_string(alignof(std::max_align_t)));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	int id = count;
+	if (id >= MAX_COMPONENT_TYPES)
+		throw EngineException("Too many component types:", std::to_string(MAX_COMPONENT_TYPES));
+
+	infos[id] = info;
+	count = id + 1;
+	return id;
+}
+
+/* ARCHETYPE */
+
+static size_t alignUp(const size_t & value, const size_t & align) {
+	return (value + align - 1) / align * align;
+}
+
+// places the id array and then each component's array, returns the bytes one chunk needs
+static size_t layoutChunk(const std::vector<int> & components, const int & capacity, std::vector<size_t> & offsets) {
+	offsets.clear();
+	size_t bytes = sizeof(EntityId) * capacity;
+	for (size_t c = 0; c < components.size(); ++c) {
+		const ComponentInfo & info = ComponentRegistry::get(components[c]);
+		bytes = alignUp(bytes, info.align);
+		offsets.push_back(bytes);
+		bytes += info.size * capacity;
+	}
+	return bytes;
+}
+
+Archetype::Archetype(const ComponentMask & m) : mask(m), capacity(1), chunkBytes(0), count(0) {
+	size_t bytesPerEntity = sizeof(EntityId);
+	for (int id = 0; id < MAX_COMPONENT_TYPES; ++id) {
+		column[id] = addEdge[id] = removeEdge[id] = -1;
+		if (m & ((ComponentMask)1 << id)) {
+			column[id] = (int)components.size();
+			components.push_back(id);
+			sizes.push_back(ComponentRegistry::get(id).size);
+			bytesPerEntity += sizes.back();
+		}
+	}
+
+	// as many entities as fit, alignment padding may take a few off.
+	// an entity larger than a chunk gets a chunk of its own
+	capacity = std::max(1, (int)(ENTITY_CHUNK_BYTES / bytesPerEntity));
+	while ((chunkBytes = layoutChunk(components, capacity, offsets)) > (size_t)ENTITY_CHUNK_BYTES && capacity > 1)
+		--capacity;
+}
+
+/* ENTITY WORLD */
+
+EntityWorld::EntityWorld() : entityCount(0), iterating(0) {
+	findArchetype(0);
+}
+
+EntityWorld::~EntityWorld() {
+	for (size_t a = 0; a < archetypes.size(); ++a) {
+		Archetype & archetype = *archetypes[a];
+		for (int i = 0; i < archetype.count; ++i)
+			for (size_t c = 0; c < archetype.components.size(); ++c)
+				ComponentRegistry::get(archetype.components[c]).destroy(archetype.getComponent((int)c, i));
+	}
+}
+
+void EntityWorld::checkUnlocked() const {
+	if (iterating > 0)
+		throw EngineException("Cannot change entities while a query runs:", "use EntityWorld::defer()");
+}
+
+EntityWorld::EntityRecord & EntityWorld::getRecord(const EntityId & entity) {
+	if (!isAlive(entity))
+		throw EngineException("Invalid entity:", std::to_string(entity.index) + " generation " + std::to_string(entity.generation));
+	return records[entity.index];
+}
+
+bool EntityWorld::isAlive(const EntityId & entity) const {
+	return entity.index < records.size() && records[entity.index].archetype >= 0 && records[entity.index].generation == entity.generation;
+}
+
+int EntityWorld::findArchetype(const ComponentMask & mask) {
+	std::unordered_map<ComponentMask, int>::const_iterator found = archetypeIndex.find(mask);
+	if (found != archetypeIndex.end())
+		return found->second;
+
+	archetypes.push_back(std::unique_ptr<Archetype>(new Archetype(mask)));
+	archetypeIndex[mask] = (int)archetypes.size() - 1;
+	return (int)archetypes.size() - 1;
+}
+
+int EntityWorld::getEdge(const int & from, const int & component, const bool & adding) {
+	// archetypes are heap allocated, the edge stays put if a new one is created
+	Archetype & source = *archetypes[from];
+	int & edge = adding ? source.addEdge[component] : source.removeEdge[component];
+	if (edge < 0) {
+		ComponentMask bit = (ComponentMask)1 << component;
+		edge = findArchetype(adding ? source.mask | bit : source.mask & ~bit);
+	}
+	return edge;
+}
+
+int EntityWorld::appendRow(Archetype & archetype) {
+	if (archetype.count == (int)archetype.chunks.size() * archetype.capacity) {
+		archetype.chunks.push_back(Archetype::Chunk());
+		archetype.chunks.back().memory.resize((archetype.chunkBytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+	}
+	return archetype.count++;
+}
+
+EntityId EntityWorld::allocate(const int & archetype) {
+	Uint32 index;
+	if (!freeIndices.empty()) {
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else {
+		index = (Uint32)records.size();
+		EntityRecord record = { 0, -1, 0 };
+		records.push_back(record);
+	}
+
+	EntityRecord & record = records[index];
+	Archetype & a = *archetypes[archetype];
+	record.archetype = archetype;
+	record.index = appendRow(a);
+
+	EntityId entity(index, record.generation);
+	a.getEntity(record.index) = entity;
+	++entityCount;
+	return entity;
+}
+
+void EntityWorld::moveEntity(EntityRecord & record, const int & to) {
+	Archetype & from = *archetypes[record.archetype];
+	Archetype & target = *archetypes[to];
+	const int fromIndex = record.index;
+	const int toIndex = appendRow(target);
+	target.getEntity(toIndex) = from.getEntity(fromIndex);
+
+	// shared components move over, the rest of the old row is destroyed.
+	// a component only the target has is constructed by the caller
+	for (size_t c = 0; c < from.components.size(); ++c) {
+		const int id = from.components[c];
+		const ComponentInfo & info = ComponentRegistry::get(id);
+		void * source = from.getComponent((int)c, fromIndex);
+		if (target.column[id] >= 0)
+			info.move(target.getComponent(target.column[id], toIndex), source);
+		info.destroy(source);
+	}
+
+	removeRow(from, fromIndex);
+	record.archetype = to;
+	record.index = toIndex;
+}
+
+void EntityWorld::removeRow(Archetype & archetype, const int & index) {
+	// the row's components are already destroyed, the last row moves into the hole
+	const int last = archetype.count - 1;
+	if (index != last) {
+		for (size_t c = 0; c < archetype.components.size(); ++c) {
+			const ComponentInfo & info = ComponentRegistry::get(archetype.components[c]);
+			void * source = archetype.getComponent((int)c, last);
+			info.move(archetype.getComponent((int)c, index), source);
+			info.destroy(source);
+		}
+
+		EntityId moved = archetype.getEntity(last);
+		archetype.getEntity(index) = moved;
+		records[moved.index].index = index;
+	}
+	--archetype.count;
+}
+
+EntityId EntityWorld::create() {
+	checkUnlocked();
+	return allocate(findArchetype(0));
+}
+
+void EntityWorld::destroy(const EntityId & entity) {
+	checkUnlocked();
+	EntityRecord & record = getRecord(entity);
+	Archetype & a = *archetypes[record.archetype];
+	for (size_t c = 0; c < a.components.size(); ++c)
+		ComponentRegistry::get(a.components[c]).destroy(a.getComponent((int)c, record.index));
+	removeRow(a, record.index);
+
+	record.archetype = -1;
+	++record.generation;
+	freeIndices.push_back(entity.index);
+	--entityCount;
+}
+
+void EntityWorld::defer(const std::function<void(EntityWorld &)> & command) {
+	std::lock_guard<std::mutex> lock(deferredMutex);
+	deferred.push_back(command);
+}
+
+void EntityWorld::destroyDeferred(const EntityId & entity) {
+	defer([entity](EntityWorld & world) {
+		if (world.isAlive(entity))
+			world.destroy(entity);
+	});
+}
+
+void EntityWorld::flushDeferred() {
+	// commands may queue more commands, those run in the same flush.
+	// the vectors swap back and forth so their storage is reused
+	std::vector<std::function<void(EntityWorld &)>> commands;
+	for (;;) {
+		{
+			std::lock_guard<std::mutex> lock(deferredMutex);
+			commands.swap(deferred);
+		}
+		if (commands.empty())
+			break;
+
+		for (size_t i = 0; i < commands.size(); ++i)
+			commands[i](*this);
+		commands.clear();
+	}
+}
+
+void EntityWorld::clear() {
+	checkUnlocked();
+	for (size_t a = 0; a < archetypes.size(); ++a) {
+		Archetype & archetype = *archetypes[a];
+		for (int i = 0; i < archetype.count; ++i)
+			for (size_t c = 0; c < archetype.components.size(); ++c)
+				ComponentRegistry::get(archetype.components[c]).destroy(archetype.getComponent((int)c, i));
+		archetype.count = 0;
+	}
+
+	freeIndices.clear();
+	for (size_t i = 0; i < records.size(); ++i) {
+		if (records[i].archetype >= 0) {
+			records[i].archetype = -1;
+			++records[i].generation;
+		}
+		freeIndices.push_back((Uint32)i);
+	}
+	entityCount = 0;
+
+	std::lock_guard<std::mutex> lock(deferredMutex);
+	deferred.clear();
+}
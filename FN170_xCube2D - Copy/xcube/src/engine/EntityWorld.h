@@ -0,0 +1,407 @@
+#ifndef __ENTITY_WORLD_H__
+#define __ENTITY_WORLD_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <SDL_stdinc.h>
+
+#include "EngineCommon.h"
+
+static const int MAX_COMPONENT_TYPES = 64;			// one bit each in an archetype's mask
+static const int ENTITY_CHUNK_BYTES = 16 * 1024;	// one chunk of an archetype, small enough for a query to walk it in L1 / L2
+
+typedef Uint64 ComponentMask;
+
+/**
+ * Refers to an entity without owning it,
+ * stays safe to use after the entity is destroyed (the generation no longer matches)
+ */
+struct EntityId {
+	Uint32 index;
+	Uint32 generation;
+
+	EntityId() : index(0xFFFFFFFF), generation(0) {}
+	EntityId(Uint32 index, Uint32 generation) : index(index), generation(generation) {}
+
+	bool operator==(const EntityId & other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const EntityId & other) const { return !(*this == other); }
+};
+
+/**
+ * What the world needs to move a component type around in raw chunk memory
+ */
+struct ComponentInfo {
+	size_t size, align;
+	void (*move)(void * to, void * from);	// move constructs into uninitialised memory
+	void (*destroy)(void * component);
+};
+
+/**
+ * Every component type gets an id (its bit in archetype masks) the first time it is used
+ */
+class ComponentRegistry {
+	template <class T> friend struct ComponentType;
+	private:
+		static ComponentInfo infos[MAX_COMPONENT_TYPES];
+		static std::atomic<int> count;
+		static std::mutex mutex;
+
+		/**
+		* @throws EngineException once MAX_COMPONENT_TYPES are registered, or for over aligned types
+		*/
+		static int add(const ComponentInfo & info);
+	public:
+		static const ComponentInfo & get(const int & id) { return infos[id]; }
+		static int getCount() { return count; }
+};
+
+template <class T>
+struct ComponentType {
+	static int id() {
+		static const int value = ComponentRegistry::add(info());
+		return value;
+	}
+
+	static ComponentMask bit() { return (ComponentMask)1 << id(); }
+
+	static void move(void * to, void * from) { new (to) T(std::move(*static_cast<T *>(from))); }
+	static void destroy(void * component) { static_cast<T *>(component)->~T(); }
+
+	static ComponentInfo info() {
+		ComponentInfo i = { sizeof(T), alignof(T), &ComponentType<T>::move, &ComponentType<T>::destroy };
+		return i;
+	}
+};
+
+/**
+ * @return the mask of all the given component types
+ */
+template <class... C>
+ComponentMask componentMask() {
+	ComponentMask mask = 0;
+	int expand[] = { 0, (mask |= ComponentType<C>::bit(), 0)... };
+	(void)expand;
+	return mask;
+}
+
+/**
+ * All entities with exactly the same component types. Their components are stored
+ * in fixed size chunks, each chunk holding one array per component type (structure of arrays)
+ * and the entity ids. Entities are packed, chunk k holds entities [k * capacity, (k + 1) * capacity)
+ */
+class Archetype {
+	friend class EntityWorld;
+	private:
+		struct Chunk {
+			std::vector<std::max_align_t> memory;	// aligned for any component that registered
+			Uint8 * data() { return reinterpret_cast<Uint8 *>(memory.data()); }
+			const Uint8 * data() const { return reinterpret_cast<const Uint8 *>(memory.data()); }
+		};
+
+		ComponentMask mask;
+		std::vector<int> components;	// ids, ascending
+		std::vector<size_t> offsets;	// of each component's array in a chunk, same order
+		std::vector<size_t> sizes;		// of one component, same order
+		int column[MAX_COMPONENT_TYPES];	// component id to position in components, -1 if absent
+		int addEdge[MAX_COMPONENT_TYPES];	// archetype reached by adding / removing a component, -1 until first needed
+		int removeEdge[MAX_COMPONENT_TYPES];
+		int capacity;		// entities per chunk
+		size_t chunkBytes;
+		int count;
+		std::vector<Chunk> chunks;	// kept when emptied, reused by the next entities
+
+		explicit Archetype(const ComponentMask & mask);
+
+		void * getComponent(const int & columnIndex, const int & index) {
+			return chunks[index / capacity].data() + offsets[columnIndex] + (size_t)(index % capacity) * sizes[columnIndex];
+		}
+
+		EntityId & getEntity(const int & index) {
+			return reinterpret_cast<EntityId *>(chunks[index / capacity].data())[index % capacity];
+		}
+	public:
+		ComponentMask getMask() const { return mask; }
+		int getCount() const { return count; }
+		int getCapacity() const { return capacity; }
+
+		int getChunkCount() const { return (count + capacity - 1) / capacity; }
+		int getChunkSize(const int & chunk) const { return std::min(capacity, count - chunk * capacity); }
+
+		const EntityId * getEntities(const int & chunk) const {
+			return reinterpret_cast<const EntityId *>(chunks[chunk].data());
+		}
+
+		/**
+		* @return the chunk's array of T, nullptr if the archetype does not have T
+		*/
+		template <class T>
+		T * getArray(const int & chunk) {
+			int c = column[ComponentType<T>::id()];
+			return c < 0 ? nullptr : reinterpret_cast<T *>(chunks[chunk].data() + offsets[c]);
+		}
+};
+
+template <class... C> class EntityQuery;
+
+/**
+ * Archetype based entity component system. An entity is only an id, its data are components,
+ * plain structs of any type. Entities with the same set of component types share an archetype,
+ * so a query for some component types walks contiguous arrays chunk by chunk
+ * instead of chasing pointers and calling virtual functions per entity.
+ *
+ * Adding or removing a component moves the entity to another archetype, so it costs a copy
+ * of the entity's components. Pointers and references to components are only valid until the next
+ * create, destroy, add or remove. Those are not allowed while a query runs, see defer()
+ */
+class EntityWorld {
+	template <class... C> friend class EntityQuery;
+	private:
+		struct EntityRecord {
+			Uint32 generation;
+			int archetype;	// -1 while the index is free
+			int index;		// in the archetype
+		};
+
+		std::vector<EntityRecord> records;
+		std::vector<Uint32> freeIndices;
+		std::vector<std::unique_ptr<Archetype>> archetypes;	// never removed, so queries only ever see new ones
+		std::unordered_map<ComponentMask, int> archetypeIndex;
+		int entityCount;
+
+		std::atomic<int> iterating;	// queries running, structural changes throw meanwhile
+		std::mutex deferredMutex;
+		std::vector<std::function<void(EntityWorld &)>> deferred;
+
+		// held by a running query
+		struct IterationLock {
+			EntityWorld & world;
+			explicit IterationLock(EntityWorld & world) : world(world) { ++world.iterating; }
+			~IterationLock() { --world.iterating; }
+		};
+
+		void checkUnlocked() const;
+		EntityRecord & getRecord(const EntityId & entity);
+		int findArchetype(const ComponentMask & mask);
+		int getEdge(const int & from, const int & component, const bool & adding);
+		int appendRow(Archetype & archetype);
+		EntityId allocate(const int & archetype);
+		void moveEntity(EntityRecord & record, const int & to);
+		void removeRow(Archetype & archetype, const int & index);
+
+		template <class T>
+		void construct(const EntityRecord & record, const T & component) {
+			Archetype & a = *archetypes[record.archetype];
+			new (a.getComponent(a.column[ComponentType<T>::id()], record.index)) T(component);
+		}
+	public:
+		EntityWorld();
+		~EntityWorld();
+
+		EntityWorld(const EntityWorld &) = delete;
+		EntityWorld & operator=(const EntityWorld &) = delete;
+
+		/**
+		* @return a new entity without components
+		*/
+		EntityId create();
+
+		/**
+		* @return a new entity with a copy of each component, placed straight into its archetype
+		* @throws EngineException if a component type is given twice
+		*/
+		template <class... C>
+		EntityId create(const C &... components) {
+			checkUnlocked();
+			ComponentMask mask = componentMask<C...>();
+
+			// each type sets one bit, fewer bits than types means a type came twice
+			int bits = 0;
+			for (ComponentMask m = mask; m != 0; m &= m - 1)
+				++bits;
+			if (bits != (int)sizeof...(C))
+				throw EngineException("Cannot create entity:", "component type given twice");
+
+			EntityId entity = allocate(findArchetype(mask));
+			const EntityRecord & record = records[entity.index];
+			int expand[] = { 0, (construct(record, components), 0)... };
+			(void)expand;
+			return entity;
+		}
+
+		/**
+		* Destroys the entity's components, the id becomes stale
+		* @throws EngineException if the entity was already destroyed
+		*/
+		void destroy(const EntityId & entity);
+
+		bool isAlive(const EntityId & entity) const;
+
+		/**
+		* Adds a copy of component, or overwrites the entity's T if it has one already
+		* @return the component in its new place
+		*/
+		template <class T>
+		T & add(const EntityId & entity, const T & component = T()) {
+			checkUnlocked();
+			EntityRecord & record = getRecord(entity);
+			const int id = ComponentType<T>::id();
+			Archetype * a = archetypes[record.archetype].get();
+			if (a->column[id] >= 0)
+				return *static_cast<T *>(a->getComponent(a->column[id], record.index)) = component;
+
+			// component may live in this world and move below
+			T copy(component);
+			moveEntity(record, getEdge(record.archetype, id, true));
+			a = archetypes[record.archetype].get();
+			return *new (a->getComponent(a->column[id], record.index)) T(std::move(copy));
+		}
+
+		/**
+		* Does nothing if the entity has no T
+		*/
+		template <class T>
+		void remove(const EntityId & entity) {
+			checkUnlocked();
+			EntityRecord & record = getRecord(entity);
+			const int id = ComponentType<T>::id();
+			if (archetypes[record.archetype]->column[id] >= 0)
+				moveEntity(record, getEdge(record.archetype, id, false));
+		}
+
+		/**
+		* @return the entity's T, nullptr if it has none or the id is stale
+		*/
+		template <class T>
+		T * get(const EntityId & entity) {
+			if (!isAlive(entity))
+				return nullptr;
+			const EntityRecord & record = records[entity.index];
+			Archetype & a = *archetypes[record.archetype];
+			int c = a.column[ComponentType<T>::id()];
+			return c < 0 ? nullptr : static_cast<T *>(a.getComponent(c, record.index));
+		}
+
+		template <class T>
+		bool has(const EntityId & entity) const {
+			return isAlive(entity) && archetypes[records[entity.index].archetype]->column[ComponentType<T>::id()] >= 0;
+		}
+
+		int getEntityCount() const { return entityCount; }
+		int getArchetypeCount() const { return (int)archetypes.size(); }
+		Archetype & getArchetype(const int & i) { return *archetypes[i]; }
+
+		/**
+		* @return a query over the entities having all of C, keep it to reuse its cached archetype list
+		*/
+		template <class... C>
+		EntityQuery<C...> query() { return EntityQuery<C...>(this); }
+
+		/**
+		* Queues a structural change for flushDeferred(), e.g. destroying or spawning from inside a query.
+		* Safe to call from several threads
+		*/
+		void defer(const std::function<void(EntityWorld &)> & command);
+		void destroyDeferred(const EntityId & entity);
+
+		/**
+		* Runs the queued commands in the order they were queued, ids that went stale meanwhile are skipped
+		*/
+		void flushDeferred();
+
+		/**
+		* Destroys every entity, archetypes and their chunks are kept for reuse
+		*/
+		void clear();
+};
+
+/**
+ * Entities having all of C (and none of the excluded types). Matching archetypes are
+ * cached in the query and only archetypes created since the last run are checked again,
+ * so a query kept between frames costs nothing to set up
+ */
+template <class... C>
+class EntityQuery {
+	private:
+		EntityWorld * world;
+		ComponentMask required, excluded;
+		std::vector<int> matches;
+		size_t checked;	// archetypes of the world looked at so far
+
+		void refresh() {
+			for (; checked < world->archetypes.size(); ++checked) {
+				ComponentMask mask = world->archetypes[checked]->getMask();
+				if ((mask & required) == required && (mask & excluded) == 0)
+					matches.push_back((int)checked);
+			}
+		}
+	public:
+		EntityQuery() : world(nullptr), required(0), excluded(0), checked(0) {}
+		explicit EntityQuery(EntityWorld * world) : world(world), required(componentMask<C...>()), excluded(0), checked(0) {}
+
+		/**
+		* Leaves out entities having any of X, e.g. query<Transform>().without<Dead>()
+		*/
+		template <class... X>
+		EntityQuery & without() {
+			excluded |= componentMask<X...>();
+			matches.clear();
+			checked = 0;
+			return *this;
+		}
+
+		/**
+		* Calls f(count, ids, arrays of C...) per chunk, for loops the compiler can vectorise
+		*/
+		template <class F>
+		void forEachChunk(F f) {
+			refresh();
+			EntityWorld::IterationLock lock(*world);
+			for (size_t m = 0; m < matches.size(); ++m) {
+				Archetype & a = *world->archetypes[matches[m]];
+				const int chunks = a.getChunkCount();
+				for (int c = 0; c < chunks; ++c)
+					f(a.getChunkSize(c), a.getEntities(c), a.template getArray<C>(c)...);
+			}
+		}
+
+		/**
+		* Calls f(C &...) for every matching entity
+		*/
+		template <class F>
+		void forEach(F f) {
+			forEachChunk([&f](int count, const EntityId *, C *... arrays) {
+				for (int i = 0; i < count; ++i)
+					f(arrays[i]...);
+			});
+		}
+
+		/**
+		* Calls f(id, C &...) for every matching entity
+		*/
+		template <class F>
+		void forEachEntity(F f) {
+			forEachChunk([&f](int count, const EntityId * ids, C *... arrays) {
+				for (int i = 0; i < count; ++i)
+					f(ids[i], arrays[i]...);
+			});
+		}
+
+		int count() {
+			refresh();
+			int total = 0;
+			for (size_t m = 0; m < matches.size(); ++m)
+				total += world->archetypes[matches[m]]->getCount();
+			return total;
+		}
+};
+
+#endif
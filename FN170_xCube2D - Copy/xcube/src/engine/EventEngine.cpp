@@ -1,6 +1,6 @@
 #include "EventEngine.h"
 
-EventEngine::EventEngine() : running(true) {
+EventEngine::EventEngine() : running(true), emulated(false) {
 	for (int i = 0; i < Key::LAST; ++i) {
 		keys[i] = false;
 	}
@@ -13,14 +13,17 @@ EventEngine::~EventEngine() {}
 
 void EventEngine::pollEvents() {
 	while (SDL_PollEvent(&event)) {
-		if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && event.key.repeat == 0) {
-			updateKeys(event.key.keysym.sym, event.type == SDL_KEYDOWN);
-		}
-
 		if (event.type == SDL_QUIT) {
 			keys[QUIT] = true;
 		}
 
+		if (emulated)
+			continue;
+
+		if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && event.key.repeat == 0) {
+			updateKeys(event.key.keysym.sym, event.type == SDL_KEYDOWN);
+		}
+
 		buttons[Mouse::BTN_LEFT]  = (SDL_GetMouseState(NULL, NULL) & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
 		buttons[Mouse::BTN_RIGHT] = (SDL_GetMouseState(NULL, NULL) & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
 	}
@@ -45,6 +48,7 @@ void EventEngine::updateKeys(const SDL_Keycode &key, bool keyDown) {
 		case SDLK_r:       index = Key::R; break;
 		case SDLK_e:       index = Key::E; break;
 		case SDLK_f:       index = Key::F; break;
+		case SDLK_F3:      index = Key::F3; break;
 
 
 		default:
@@ -62,6 +66,22 @@ void EventEngine::setPressed(Mouse btn) {
     buttons[btn] = true;
 }
 
+void EventEngine::setReleased(Key key) {
+	keys[key] = false;
+}
+
+void EventEngine::setReleased(Mouse btn) {
+	buttons[btn] = false;
+}
+
+void EventEngine::setEmulatedInput(bool b) {
+	emulated = b;
+}
+
+void EventEngine::setMousePos(const Point2 & pos) {
+	emulatedMousePos = pos;
+}
+
 bool EventEngine::isPressed(Key key) {
 	return keys[key];
 }
@@ -85,6 +105,9 @@ Point2 EventEngine::getMouseDPos() {
 }
 
 Point2 EventEngine::getMousePos() {
+	if (emulated)
+		return emulatedMousePos;
+
 	Point2 pos;
 	SDL_GetMouseState(&pos.x, &pos.y);
 	return pos;
@@ -10,7 +10,7 @@
 #include "GameMath.h"
 
 enum Key {
-	W, S, A, D, E, F, R, ESC, SPACE, UP, DOWN, LEFT, RIGHT, QUIT, LAST, F3
+	W, S, A, D, E, F, R, ESC, SPACE, UP, DOWN, LEFT, RIGHT, QUIT, F3, LAST
 };
 
 enum Mouse {
@@ -25,6 +25,9 @@ class EventEngine {
 		bool keys[Key::LAST];
 		bool buttons[Mouse::BTN_LAST];
 
+		bool emulated;			// input comes from setPressed / setReleased only
+		Point2 emulatedMousePos;
+
 		void updateKeys(const SDL_Keycode &, bool);
 
 		EventEngine();
@@ -44,6 +47,17 @@ class EventEngine {
          */
         void setPressed(Key);
         void setPressed(Mouse);
+        void setReleased(Key);
+        void setReleased(Mouse);
+
+		/**
+		* When enabled, real keyboard / mouse input is ignored (window events such as
+		* QUIT still arrive) and the state is driven entirely by setPressed(),
+		* setReleased() and setMousePos(). Used to replay recorded input
+		*/
+		void setEmulatedInput(bool);
+		bool isEmulatedInput() { return emulated; }
+		void setMousePos(const Point2 &);
 	
 		void setMouseRelative(bool);
 
@@ -0,0 +1,108 @@
+#ifndef __FIXED_H__
+#define __FIXED_H__
+
+#include <cmath>
+#include <cstring>
+#include <SDL_stdinc.h>
+
+static const int FIXED_FRACTION_BITS = 16;
+static const Sint32 FIXED_ONE = 1 << FIXED_FRACTION_BITS;
+
+/**
+ * Q16.16 fixed point number, 16 integer bits (about +-32767) and 16 fraction bits.
+ *
+ * Integer arithmetic gives the same bits with every compiler, optimisation level and CPU,
+ * which float does not guarantee (x87 precision, FMA contraction, reordering).
+ * Results out of range saturate instead of wrapping, division by zero is left to the caller as with int.
+ *
+ * Converts implicitly from float and int so code written for float compiles as is,
+ * going back to float has to be asked for with a cast
+ */
+struct Fixed {
+	Sint32 raw;
+
+	Fixed() : raw(0) {}
+	Fixed(int value) : raw(saturate((Sint64)value * FIXED_ONE)) {}
+
+	// through double, where the scaling by a power of two and the rounding are exact
+	Fixed(float value) : raw(saturate((Sint64)std::floor((double)value * FIXED_ONE + 0.5))) {}
+	Fixed(double value) : raw(saturate((Sint64)std::floor(value * FIXED_ONE + 0.5))) {}
+
+	static Fixed fromRaw(const Sint32 & raw) {
+		Fixed f;
+		f.raw = raw;
+		return f;
+	}
+
+	static Sint32 saturate(const Sint64 & value) {
+		return value > SDL_MAX_SINT32 ? SDL_MAX_SINT32 : (value < SDL_MIN_SINT32 ? SDL_MIN_SINT32 : (Sint32)value);
+	}
+
+	explicit operator float() const { return (float)((double)raw / FIXED_ONE); }
+	explicit operator double() const { return (double)raw / FIXED_ONE; }
+
+	/**
+	* @return the nearest float not above / not below the exact value, for conservative bounds
+	*/
+	float toFloatDown() const;
+	float toFloatUp() const;
+
+	Fixed operator-() const { return fromRaw(saturate(-(Sint64)raw)); }
+
+	Fixed & operator+=(const Fixed & b) { raw = saturate((Sint64)raw + b.raw); return *this; }
+	Fixed & operator-=(const Fixed & b) { raw = saturate((Sint64)raw - b.raw); return *this; }
+	Fixed & operator*=(const Fixed & b) { raw = saturate(((Sint64)raw * b.raw) >> FIXED_FRACTION_BITS); return *this; }
+	Fixed & operator/=(const Fixed & b) { raw = saturate((Sint64)raw * FIXED_ONE / b.raw); return *this; }
+
+	// free functions so a float or int converts on either side
+	friend Fixed operator+(Fixed a, const Fixed & b) { return a += b; }
+	friend Fixed operator-(Fixed a, const Fixed & b) { return a -= b; }
+	friend Fixed operator*(Fixed a, const Fixed & b) { return a *= b; }
+	friend Fixed operator/(Fixed a, const Fixed & b) { return a /= b; }
+
+	friend bool operator==(const Fixed & a, const Fixed & b) { return a.raw == b.raw; }
+	friend bool operator!=(const Fixed & a, const Fixed & b) { return a.raw != b.raw; }
+	friend bool operator<(const Fixed & a, const Fixed & b) { return a.raw < b.raw; }
+	friend bool operator>(const Fixed & a, const Fixed & b) { return a.raw > b.raw; }
+	friend bool operator<=(const Fixed & a, const Fixed & b) { return a.raw <= b.raw; }
+	friend bool operator>=(const Fixed & a, const Fixed & b) { return a.raw >= b.raw; }
+};
+
+inline float Fixed::toFloatDown() const {
+	double exact = (double)raw / FIXED_ONE;
+	float f = (float)exact;
+	return f > exact ? std::nextafter(f, -HUGE_VALF) : f;
+}
+
+inline float Fixed::toFloatUp() const {
+	double exact = (double)raw / FIXED_ONE;
+	float f = (float)exact;
+	return f < exact ? std::nextafter(f, HUGE_VALF) : f;
+}
+
+inline Fixed abs(const Fixed & f) {
+	return f.raw < 0 ? -f : f;
+}
+
+/**
+ * Bits identifying a value exactly, for checksums. Overloaded so generic code can hash either scalar
+ */
+inline Uint32 rawBits(const Fixed & f) {
+	return (Uint32)f.raw;
+}
+
+inline Uint32 rawBits(const float & f) {
+	Uint32 bits;
+	std::memcpy(&bits, &f, sizeof(bits));
+	return bits;
+}
+
+/**
+ * float versions of Fixed::toFloatDown() / toFloatUp(), so generic code can use either scalar
+ */
+inline float toFloatDown(const Fixed & f) { return f.toFloatDown(); }
+inline float toFloatUp(const Fixed & f) { return f.toFloatUp(); }
+inline float toFloatDown(const float & f) { return f; }
+inline float toFloatUp(const float & f) { return f; }
+
+#endif
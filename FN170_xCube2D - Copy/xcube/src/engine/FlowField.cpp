@@ -0,0 +1,222 @@
+#include "FlowField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// clockwise from +x in screen coordinates, odd codes are diagonal
+static const int FLOW_DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int FLOW_DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const float FLOW_DIAGONAL = 0.70710678f;
+static const Vector2f FLOW_VECTORS[FLOW_NONE + 1] = {
+	Vector2f(1, 0), Vector2f(FLOW_DIAGONAL, FLOW_DIAGONAL), Vector2f(0, 1), Vector2f(-FLOW_DIAGONAL, FLOW_DIAGONAL),
+	Vector2f(-1, 0), Vector2f(-FLOW_DIAGONAL, -FLOW_DIAGONAL), Vector2f(0, -1), Vector2f(FLOW_DIAGONAL, -FLOW_DIAGONAL),
+	Vector2f(0, 0)
+};
+
+FlowField::FlowField(const int & w, const int & h, const float & size) : width(w), height(h), cellSize(size), invCellSize(1.0f / size), front(0),
+	building(false), dirty(false), target(-1), phase(0), cursor(0), cellBudget(0), lastWork(0) {
+	if (w <= 0 || h <= 0 || size <= 0)
+		throw EngineException("Invalid flow field size:", std::to_string(w) + "x" + std::to_string(h) + " cells of " + std::to_string(size));
+
+	blocked.assign((size_t)w * h, 0);
+	for (int f = 0; f < 2; ++f) {
+		fields[f].cost.assign(blocked.size(), FLOW_UNREACHABLE);
+		fields[f].direction.assign(blocked.size(), FLOW_NONE);
+		fields[f].target = -1;
+	}
+}
+
+bool FlowField::toCell(const Vector2f & position, int & x, int & y) const {
+	x = (int)std::floor(position.x / cellSize);
+	y = (int)std::floor(position.y / cellSize);
+	return x >= 0 && y >= 0 && x < width && y < height;
+}
+
+Vector2f FlowField::getCellCenter(const int & x, const int & y) const {
+	return Vector2f((x + 0.5f) * cellSize, (y + 0.5f) * cellSize);
+}
+
+void FlowField::setBlocked(const int & x, const int & y, const bool & isBlocked) {
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return;
+
+	Uint8 & cell = blocked[y * width + x];
+	if (cell != (isBlocked ? 1 : 0)) {
+		cell = isBlocked ? 1 : 0;
+		dirty = true;
+	}
+}
+
+void FlowField::setBlockedRect(const SDL_Rect & rect, const bool & isBlocked) {
+	if (rect.w <= 0 || rect.h <= 0)
+		return;
+
+	int minX = std::max(0, (int)std::floor(rect.x / cellSize)), minY = std::max(0, (int)std::floor(rect.y / cellSize));
+	int maxX = std::min(width - 1, (int)std::floor((rect.x + rect.w - 1) / cellSize));
+	int maxY = std::min(height - 1, (int)std::floor((rect.y + rect.h - 1) / cellSize));
+	for (int y = minY; y <= maxY; ++y)
+		for (int x = minX; x <= maxX; ++x)
+			setBlocked(x, y, isBlocked);
+}
+
+bool FlowField::isBlocked(const int & x, const int & y) const {
+	return x < 0 || y < 0 || x >= width || y >= height || blocked[y * width + x] != 0;
+}
+
+void FlowField::setTarget(const Vector2f & position) {
+	int x, y;
+	int cell = toCell(position, x, y) ? y * width + x : -1;
+	if (cell != target) {
+		target = cell;
+		dirty = true;
+	}
+}
+
+bool FlowField::canStep(const int & x, const int & y, const int & direction) const {
+	const int dx = FLOW_DX[direction], dy = FLOW_DY[direction];
+	if (isBlocked(x + dx, y + dy))
+		return false;
+
+	// diagonal steps may not cut a blocked corner
+	return (direction & 1) == 0 || (!isBlocked(x + dx, y) && !isBlocked(x, y + dy));
+}
+
+void FlowField::startBuild() {
+	Field & back = fields[1 - front];
+	std::fill(back.cost.begin(), back.cost.end(), FLOW_UNREACHABLE);
+	back.target = target;
+
+	open.clear();
+	if (target >= 0 && !blocked[target]) {
+		back.cost[target] = 0;
+		open.push_back((Uint64)target);
+	}
+
+	phase = 0;
+	cursor = 0;
+	building = true;
+	dirty = false;
+}
+
+int FlowField::search(Field & field, const int & budget) {
+	int work = 0;
+	while (!open.empty() && (budget <= 0 || work < budget)) {
+		std::pop_heap(open.begin(), open.end(), std::greater<Uint64>());
+		const Uint64 entry = open.back();
+		open.pop_back();
+
+		// cells are queued again when a cheaper way is found, the old entries are skipped
+		const int cell = (int)(entry & 0xFFFFFFFF);
+		const Uint32 cost = (Uint32)(entry >> 32);
+		if (cost > field.cost[cell])
+			continue;
+		++work;
+
+		const int x = cell % width, y = cell / width;
+		for (int d = 0; d < 8; ++d) {
+			if (!canStep(x, y, d))
+				continue;
+
+			const int next = cell + FLOW_DY[d] * width + FLOW_DX[d];
+			const Uint32 nextCost = cost + ((d & 1) ? FLOW_DIAGONAL_COST : FLOW_STRAIGHT_COST);
+			if (nextCost < field.cost[next]) {
+				field.cost[next] = nextCost;
+				open.push_back(((Uint64)nextCost << 32) | (Uint64)next);
+				std::push_heap(open.begin(), open.end(), std::greater<Uint64>());
+			}
+		}
+	}
+	return work;
+}
+
+int FlowField::pointDirections(Field & field, const int & budget) {
+	const int count = width * height;
+	int work = 0;
+	for (; cursor < count && (budget <= 0 || work < budget); ++cursor, ++work) {
+		Uint8 best = FLOW_NONE;
+		Uint32 bestCost = field.cost[cursor];
+		if (cursor != field.target && bestCost != FLOW_UNREACHABLE) {
+			const int x = cursor % width, y = cursor / width;
+			for (int d = 0; d < 8; ++d) {
+				if (!canStep(x, y, d))
+					continue;
+
+				const Uint32 cost = field.cost[cursor + FLOW_DY[d] * width + FLOW_DX[d]];
+				if (cost < bestCost) {
+					bestCost = cost;
+					best = (Uint8)d;
+				}
+			}
+		}
+		field.direction[cursor] = best;
+	}
+	return work;
+}
+
+int FlowField::work(const int & budget) {
+	Field & back = fields[1 - front];
+	int done = 0;
+
+	if (phase == 0) {
+		done += search(back, budget);
+		if (!open.empty())
+			return done;
+		phase = 1;
+	}
+
+	if (budget > 0 && done >= budget)
+		return done;
+
+	done += pointDirections(back, budget > 0 ? budget - done : 0);
+	if (cursor == width * height) {
+		front = 1 - front;
+		building = false;
+	}
+	return done;
+}
+
+void FlowField::update() {
+	lastWork = 0;
+	if (!building) {
+		if (!dirty)
+			return;
+		startBuild();
+	}
+	lastWork = work(cellBudget);
+}
+
+void FlowField::rebuild() {
+	if (!building || dirty)
+		startBuild();
+	lastWork = work(0);
+}
+
+Vector2f FlowField::getDirection(const Vector2f & position) const {
+	// called per enemy per update, negatives are ruled out first so truncating is flooring
+	if (position.x < 0 || position.y < 0)
+		return FLOW_VECTORS[FLOW_NONE];
+
+	const int x = (int)(position.x * invCellSize), y = (int)(position.y * invCellSize);
+	if (x >= width || y >= height)
+		return FLOW_VECTORS[FLOW_NONE];
+	return FLOW_VECTORS[fields[front].direction[y * width + x]];
+}
+
+float FlowField::getDistance(const Vector2f & position) const {
+	int x, y;
+	if (!toCell(position, x, y))
+		return -1.0f;
+
+	Uint32 cost = fields[front].cost[y * width + x];
+	return cost == FLOW_UNREACHABLE ? -1.0f : cost * cellSize / FLOW_STRAIGHT_COST;
+}
+
+bool FlowField::getFieldTarget(Vector2f & center) const {
+	const int cell = fields[front].target;
+	if (cell < 0)
+		return false;
+
+	center = getCellCenter(cell % width, cell / width);
+	return true;
+}
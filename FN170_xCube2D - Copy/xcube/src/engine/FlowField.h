@@ -0,0 +1,136 @@
+#ifndef __FLOW_FIELD_H__
+#define __FLOW_FIELD_H__
+
+#include <vector>
+
+#include <SDL.h>
+
+#include "EngineCommon.h"
+#include "GameMath.h"
+
+static const Uint32 FLOW_UNREACHABLE = 0xFFFFFFFF;
+static const Uint8 FLOW_NONE = 8;			// direction of the target cell and of cells that cannot reach it
+static const Uint32 FLOW_STRAIGHT_COST = 10;	// cost of a step to a side neighbour, a diagonal step costs 14
+static const Uint32 FLOW_DIAGONAL_COST = 14;
+
+/**
+ * Grid of directions leading to one target, e.g. the player, around blocked cells.
+ * One Dijkstra search from the target serves any number of enemies, each one
+ * looks up the direction of the cell it is in, so following the field costs O(1) per enemy.
+ *
+ * The field is double buffered: lookups read the last finished field while the next one
+ * is built in the background buffer, a limited number of cells per update() if a budget is set.
+ * A new field is only built when the target moves to another cell or obstacles change
+ */
+class FlowField {
+	private:
+		struct Field {
+			std::vector<Uint32> cost;		// FLOW_STRAIGHT_COST per step to the target, FLOW_UNREACHABLE if blocked off
+			std::vector<Uint8> direction;	// 0 - 7 towards the cheapest neighbour, see getDirection()
+			int target;						// cell index, -1 before the first build
+		};
+
+		int width, height;
+		float cellSize, invCellSize;
+		std::vector<Uint8> blocked;
+
+		Field fields[2];
+		int front;		// field lookups read
+
+		// build of the back field
+		bool building;
+		bool dirty;		// target cell or obstacles changed since the back field was started
+		int target;		// cell of the latest setTarget(), -1 outside the grid
+		int phase;		// 0 search, 1 directions
+		int cursor;		// next cell of the directions phase
+		std::vector<Uint64> open;	// (cost << 32) | cell, a min heap
+		int cellBudget;
+		int lastWork;
+
+		void startBuild();
+		bool canStep(const int & x, const int & y, const int & direction) const;
+
+		/**
+		* Each returns the cells it processed, stopping at budget (0 for no limit)
+		*/
+		int search(Field & field, const int & budget);
+		int pointDirections(Field & field, const int & budget);
+		int work(const int & budget);
+	public:
+		/**
+		* @param width, height - in cells
+		* @param cellSize - in pixels, the grid starts at pixel (0, 0)
+		*/
+		FlowField(const int & width, const int & height, const float & cellSize);
+
+		int getWidth() const { return width; }
+		int getHeight() const { return height; }
+		float getCellSize() const { return cellSize; }
+
+		/**
+		* @return false outside the grid
+		*/
+		bool toCell(const Vector2f & position, int & x, int & y) const;
+		Vector2f getCellCenter(const int & x, const int & y) const;
+
+		void setBlocked(const int & x, const int & y, const bool & isBlocked);
+
+		/**
+		* Blocks or clears every cell the pixel rectangle touches
+		*/
+		void setBlockedRect(const SDL_Rect & rect, const bool & isBlocked);
+		bool isBlocked(const int & x, const int & y) const;
+
+		/**
+		* Moves the target, a new field is only built if it moved to another cell
+		*/
+		void setTarget(const Vector2f & position);
+
+		/**
+		* @param cells - cells searched or pointed per update(), 0 (the default) builds a whole field in one update().
+		*				A field takes about twice its cell count in total
+		*/
+		void setCellBudget(const int & cells) { cellBudget = cells; }
+
+		/**
+		* Works on the next field if the target or obstacles changed, swaps it in when it is complete.
+		* Changes made while a field is being built are picked up by the field after it,
+		* so a target moving every update still gets fields, each a little behind
+		*/
+		void update();
+
+		/**
+		* Builds a field for the current target and obstacles to the end now, e.g. when a level loads
+		*/
+		void rebuild();
+
+		bool isBuilding() const { return building; }
+
+		/**
+		* @return cells processed by the last update()
+		*/
+		int getLastWork() const { return lastWork; }
+
+		/**
+		* @return unit vector towards the target from the cell holding position,
+		*		 zero in the target's cell, in blocked or unreachable cells and outside the grid
+		*/
+		Vector2f getDirection(const Vector2f & position) const;
+
+		/**
+		* @return direction code of a cell, 0 - 7 clockwise from +x (pixel y grows down), FLOW_NONE if none
+		*/
+		Uint8 getDirectionCode(const int & x, const int & y) const { return fields[front].direction[y * width + x]; }
+
+		/**
+		* @return path length in pixels from position's cell to the target cell, negative if unreachable
+		*/
+		float getDistance(const Vector2f & position) const;
+
+		/**
+		* @return center of the target cell of the field lookups read, false before the first field is done
+		*/
+		bool getFieldTarget(Vector2f & center) const;
+};
+
+#endif
@@ -5,6 +5,8 @@
 #include <cmath>
 #include <SDL_rect.h>
 
+#include "Fixed.h"
+
 static const float PI_OVER_180 = (float)(3.14159265358979323846 / 180.0f);
 static const float _180_OVER_PI = (float)(180.0f / 3.14159265358979323846);
 
@@ -16,14 +18,27 @@ inline float toDegrees(float rad) {
 	return rad * _180_OVER_PI;
 }
 
-struct Vector2f {
-	float x;
-	float y;
-
-	Vector2f() : Vector2f(0.0f, 0.0f) {}
-	Vector2f(float x, float y) : x(x), y(y) {}
+/**
+ * 2D vector over any scalar, float for the game and Fixed for deterministic physics
+ */
+template <class T>
+struct Vector2T {
+	T x;
+	T y;
+
+	Vector2T() : x(0), y(0) {}
+	Vector2T(T x, T y) : x(x), y(y) {}
+
+	/**
+	* Between scalar types, e.g. a Fixed vector from a float one
+	*/
+	template <class U>
+	explicit Vector2T(const Vector2T<U> & v) : x((T)v.x), y((T)v.y) {}
 };
 
+typedef Vector2T<float> Vector2f;
+typedef Vector2T<Fixed> Vector2x;
+
 struct Vector2i {
 	int x;
 	int y;
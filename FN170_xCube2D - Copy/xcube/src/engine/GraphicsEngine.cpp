@@ -2,7 +2,7 @@
 
 SDL_Renderer * GraphicsEngine::renderer = nullptr;
 
-GraphicsEngine::GraphicsEngine() : window(nullptr), font(nullptr), fpsAverage(0), fpsPrevious(0), fpsStart(0), fpsEnd(0), drawColor(toSDLColor(0, 0, 0, 255)) {
+GraphicsEngine::GraphicsEngine() : window(nullptr), font(nullptr), fpsAverage(0), fpsPrevious(0), drawCalls(0), lastDrawCalls(0), drawColor(toSDLColor(0, 0, 0, 255)) {
 	window = SDL_CreateWindow("The X-CUBE 2D Game Engine",
 		SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
 		DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
@@ -12,6 +12,14 @@ GraphicsEngine::GraphicsEngine() : window(nullptr), font(nullptr), fpsAverage(0)
 
 	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
 
+	// e.g. headless runs with SDL_VIDEODRIVER=dummy only have the software renderer
+	if (nullptr == renderer) {
+#ifdef __DEBUG
+		debug("Accelerated renderer unavailable, falling back to software:", SDL_GetError());
+#endif
+		renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+	}
+
 	if (nullptr == renderer)
 		throw EngineException("Failed to create renderer", SDL_GetError());
 
@@ -127,6 +135,9 @@ void GraphicsEngine::clearScreen() {
 
 void GraphicsEngine::showScreen() {
 	SDL_RenderPresent(renderer);
+
+	lastDrawCalls = drawCalls;
+	drawCalls = 0;
 }
 
 void GraphicsEngine::useFont(TTF_Font * _font) {
@@ -141,16 +152,18 @@ void GraphicsEngine::useFont(TTF_Font * _font) {
 }
 
 void GraphicsEngine::setFrameStart() {
-	fpsStart = SDL_GetTicks();
+	frameTimer.measure();
 }
 
 void GraphicsEngine::adjustFPSDelay(const Uint32 &delay) {
-	fpsEnd = SDL_GetTicks() - fpsStart;
-	if (fpsEnd < delay) {
-		SDL_Delay(delay - fpsEnd);
+	Uint32 frameMs = frameTimer.getElapsed();
+	if (frameMs < delay) {
+		SDL_Delay(delay - frameMs);
 	}
 
-	Uint32 fpsCurrent = 1000 / (SDL_GetTicks() - fpsStart);
+	// sub-millisecond frames (no delay requested) would divide by zero with whole ms
+	double elapsedMs = frameTimer.getElapsedMs();
+	Uint32 fpsCurrent = elapsedMs > 0.0 ? (Uint32)(1000.0 / elapsedMs) : 0;
 	fpsAverage = (fpsCurrent + fpsPrevious + fpsAverage * 8) / 10;	// average, 10 values / 10
 	fpsPrevious = fpsCurrent;
 }
@@ -163,6 +176,16 @@ SDL_Texture * GraphicsEngine::createTextureFromSurface(SDL_Surface * surf) {
 	return SDL_CreateTextureFromSurface(renderer, surf);
 }
 
+SDL_Texture * GraphicsEngine::createTargetTexture(const int & w, const int & h) {
+	if (!SDL_RenderTargetSupported(renderer))
+		return nullptr;
+
+	SDL_Texture * texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+	if (texture != nullptr)
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	return texture;
+}
+
 SDL_Texture * GraphicsEngine::createTextureFromString(const std::string & text, TTF_Font * _font, SDL_Color color) {
 	SDL_Texture * textTexture = nullptr;
 	SDL_Surface * textSurface = TTF_RenderText_Blended(_font, text.c_str(), color);
@@ -182,52 +205,79 @@ void GraphicsEngine::setDrawScale(const Vector2f & v) {
 	SDL_RenderSetScale(renderer, v.x, v.y);
 }
 
+bool GraphicsEngine::setRenderTarget(SDL_Texture * target) {
+	if (SDL_SetRenderTarget(renderer, target) != 0)
+		return false;
+
+	if (target != nullptr) {
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+		SDL_RenderClear(renderer);
+		SDL_SetRenderDrawColor(renderer, drawColor.r, drawColor.g, drawColor.b, 255);
+	}
+	return true;
+}
+
 /* ALL DRAW FUNCTIONS */
 /* overloads explicitly call SDL funcs for better performance hopefully */
 
 void GraphicsEngine::drawRect(const Rectangle2 & rect) {
+	++drawCalls;
 	SDL_RenderDrawRect(renderer, &rect.getSDLRect());
 }
 
 void GraphicsEngine::drawRect(const Rectangle2 & rect, const SDL_Color & color) {
 	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+	++drawCalls;
 	SDL_RenderDrawRect(renderer, &rect.getSDLRect());
 	SDL_SetRenderDrawColor(renderer, drawColor.r, drawColor.g, drawColor.b, 255);
 }
 
 void GraphicsEngine::drawRect(SDL_Rect * rect, const SDL_Color & color) {
 	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+	++drawCalls;
 	SDL_RenderDrawRect(renderer, rect);
 	SDL_SetRenderDrawColor(renderer, drawColor.r, drawColor.g, drawColor.b, 255);
 }
 
 void GraphicsEngine::drawRect(SDL_Rect * rect) {
+	++drawCalls;
 	SDL_RenderDrawRect(renderer, rect);
 }
 
 void GraphicsEngine::drawRect(const int &x, const int &y, const int &w, const int &h) {
 	SDL_Rect rect = { x, y, w, h };
+	++drawCalls;
 	SDL_RenderDrawRect(renderer, &rect);
 }
 
 void GraphicsEngine::fillRect(SDL_Rect * rect) {
+	++drawCalls;
 	SDL_RenderFillRect(renderer, rect);
 }
 
 void GraphicsEngine::fillRect(const int &x, const int &y, const int &w, const int &h) {
 	SDL_Rect rect = { x, y, w, h };
+	++drawCalls;
 	SDL_RenderFillRect(renderer, &rect);
 }
 
+void GraphicsEngine::fillRects(const SDL_Rect * rects, const int & count) {
+	++drawCalls;
+	SDL_RenderFillRects(renderer, rects, count);
+}
+
 void GraphicsEngine::drawPoint(const Point2 & p) {
+	++drawCalls;
 	SDL_RenderDrawPoint(renderer, p.x, p.y);
 }
 
 void GraphicsEngine::drawLine(const Line2i & line) {
+	++drawCalls;
 	SDL_RenderDrawLine(renderer, line.start.x, line.start.y, line.end.x, line.end.y);
 }
 
 void GraphicsEngine::drawLine(const Point2 & p0, const Point2 & p1) {
+	++drawCalls;
 	SDL_RenderDrawLine(renderer, p0.x, p0.y, p1.x, p1.y);
 }
 
@@ -237,6 +287,7 @@ void GraphicsEngine::drawCircle(const Point2 & center, const float & radius) {
 		int y = (int)(center.y + radius * sin(i));
 		SDL_RenderDrawPoint(renderer, x, y);
 	}
+	drawCalls += 360;
 }
 
 void GraphicsEngine::drawEllipse(const Point2 & center, const float & radiusX, const float & radiusY) {
@@ -245,6 +296,7 @@ void GraphicsEngine::drawEllipse(const Point2 & center, const float & radiusX, c
 		int y = (int)(center.y + radiusY * sin(i));
 		SDL_RenderDrawPoint(renderer, x, y);
 	}
+	drawCalls += 360;
 }
 
 void GraphicsEngine::drawTexture(
@@ -255,6 +307,7 @@ void GraphicsEngine::drawTexture(
 	const SDL_Point* center,
 	SDL_RendererFlip flip
 ) {
+	++drawCalls;
 	if (SDL_RenderCopyEx(renderer, texture, src, dst, angle, center, flip) != 0)
 	{
 		std::cout << "SDL_RenderCopyEx FAILED (src/dst): "
@@ -278,6 +331,7 @@ void GraphicsEngine::drawTexture(
 	SDL_Rect* dst,
 	SDL_RendererFlip flip
 ) {
+	++drawCalls;
 	if (SDL_RenderCopyEx(renderer, texture, nullptr, dst, 0.0, nullptr, flip) != 0)
 	{
 		std::cout << "SDL_RenderCopyEx FAILED (dst only): "
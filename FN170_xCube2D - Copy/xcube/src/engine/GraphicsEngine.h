@@ -11,6 +11,7 @@
 
 #include "EngineCommon.h"
 #include "GameMath.h"
+#include "Timer.h"
 
 /* ENGINE DEFAULT SETTINGS */
 static const int DEFAULT_WINDOW_WIDTH = 800;
@@ -57,7 +58,10 @@ class GraphicsEngine {
 
 		TTF_Font * font;
 
-		Uint32 fpsAverage, fpsPrevious, fpsStart, fpsEnd;
+		Uint32 fpsAverage, fpsPrevious;
+		Timer frameTimer;
+
+		Uint32 drawCalls, lastDrawCalls;	// SDL_Render* submissions, current and last presented frame
 
 		GraphicsEngine();
 
@@ -88,6 +92,11 @@ class GraphicsEngine {
 		void fillRect(SDL_Rect *);
 		void fillRect(const int &x, const int &y, const int &w, const int &h);
 
+		/**
+		* Fills all rectangles with a single SDL_RenderFillRects() call
+		*/
+		void fillRects(const SDL_Rect * rects, const int & count);
+
 		void drawPoint(const Point2 &);
 		void drawLine(const Line2i &);
 		void drawLine(const Point2 & start, const Point2 & end);
@@ -100,6 +109,14 @@ class GraphicsEngine {
 		void setDrawColor(const SDL_Color &);
 		void setDrawScale(const Vector2f &);	// not tested
 
+		/**
+		* Sends the following draw calls into a texture made by createTargetTexture(), nullptr for the screen again
+		* A texture target is cleared to transparent when set
+		*
+		* @return false if the renderer could not switch to it
+		*/
+		bool setRenderTarget(SDL_Texture * target);
+
 		/**
 		* @param fileName - name of the icon file
 		*/
@@ -137,7 +154,23 @@ class GraphicsEngine {
 		void adjustFPSDelay(const Uint32 &);
 		Uint32 getAverageFPS();
 
+		/**
+		* @return number of draw submissions made to SDL so far this frame
+		*/
+		Uint32 getDrawCallCount() { return drawCalls; }
+
+		/**
+		* @return number of draw submissions made during the last presented frame
+		*/
+		Uint32 getLastDrawCallCount() { return lastDrawCalls; }
+
 		static SDL_Texture * createTextureFromSurface(SDL_Surface *);
+
+		/**
+		* @return a blended texture of the given size to draw into with setRenderTarget(),
+		*         nullptr if the renderer cannot draw into textures. The caller destroys it
+		*/
+		static SDL_Texture * createTargetTexture(const int & w, const int & h);
 		static SDL_Texture * createTextureFromString(const std::string &, TTF_Font *, SDL_Color);
 };
 
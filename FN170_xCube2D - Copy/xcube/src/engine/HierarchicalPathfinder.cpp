@@ -0,0 +1,487 @@
+#include "HierarchicalPathfinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+// same moves and costs as FlowField, clockwise from +x, odd directions are diagonal
+static const int PATH_DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int PATH_DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const Uint32 PATH_STRAIGHT_COST = 10;
+static const Uint32 PATH_DIAGONAL_COST = 14;
+static const Uint32 PATH_UNREACHABLE = 0xFFFFFFFF;
+static const int ENTRANCE_SPLIT = 6;	// runs this long or longer get a transition at each end
+
+HierarchicalPathfinder::HierarchicalPathfinder(const int & w, const int & h, const float & size, const int & cluster, const int & maxPaths)
+	: width(w), height(h), cellSize(size), clusterSize(cluster), dirty(true), version(0), paths(maxPaths),
+	searchBudget(0), lastWork(0), cacheHits(0), localSearch(0), localX0(0), localY0(0), localX1(0), localY1(0), nodeSearch(0) {
+	if (w <= 0 || h <= 0 || size <= 0 || cluster <= 0)
+		throw EngineException("Invalid path finder size:", std::to_string(w) + "x" + std::to_string(h) + " cells of "
+			+ std::to_string(size) + ", clusters of " + std::to_string(cluster));
+
+	clustersX = (w + cluster - 1) / cluster;
+	clustersY = (h + cluster - 1) / cluster;
+	blocked.assign((size_t)w * h, 0);
+
+	const size_t clusterCells = (size_t)cluster * cluster;
+	localCost.assign(clusterCells, PATH_UNREACHABLE);
+	localParent.assign(clusterCells, -1);
+	localStamp.assign(clusterCells, 0);
+}
+
+bool HierarchicalPathfinder::toCell(const Vector2f & position, int & x, int & y) const {
+	x = (int)std::floor(position.x / cellSize);
+	y = (int)std::floor(position.y / cellSize);
+	return x >= 0 && y >= 0 && x < width && y < height;
+}
+
+Vector2f HierarchicalPathfinder::getCellCenter(const int & x, const int & y) const {
+	return Vector2f((x + 0.5f) * cellSize, (y + 0.5f) * cellSize);
+}
+
+void HierarchicalPathfinder::setBlocked(const int & x, const int & y, const bool & isBlocked) {
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return;
+
+	Uint8 & cell = blocked[y * width + x];
+	if (cell != (isBlocked ? 1 : 0)) {
+		cell = isBlocked ? 1 : 0;
+		dirty = true;
+	}
+}
+
+void HierarchicalPathfinder::setBlockedRect(const SDL_Rect & rect, const bool & isBlocked) {
+	if (rect.w <= 0 || rect.h <= 0)
+		return;
+
+	int minX = std::max(0, (int)std::floor(rect.x / cellSize)), minY = std::max(0, (int)std::floor(rect.y / cellSize));
+	int maxX = std::min(width - 1, (int)std::floor((rect.x + rect.w - 1) / cellSize));
+	int maxY = std::min(height - 1, (int)std::floor((rect.y + rect.h - 1) / cellSize));
+	for (int y = minY; y <= maxY; ++y)
+		for (int x = minX; x <= maxX; ++x)
+			setBlocked(x, y, isBlocked);
+}
+
+bool HierarchicalPathfinder::isBlocked(const int & x, const int & y) const {
+	return x < 0 || y < 0 || x >= width || y >= height || blocked[y * width + x] != 0;
+}
+
+int HierarchicalPathfinder::getCluster(const int & cell) const {
+	return (cell % width) / clusterSize + (cell / width) / clusterSize * clustersX;
+}
+
+bool HierarchicalPathfinder::canStep(const int & x, const int & y, const int & direction) const {
+	const int dx = PATH_DX[direction], dy = PATH_DY[direction];
+	if (isBlocked(x + dx, y + dy))
+		return false;
+
+	// diagonal steps may not cut a blocked corner
+	return (direction & 1) == 0 || (!isBlocked(x + dx, y) && !isBlocked(x, y + dy));
+}
+
+Uint32 HierarchicalPathfinder::estimate(const int & a, const int & b) const {
+	// octile distance, never more than the real cost
+	const int dx = std::abs(a % width - b % width), dy = std::abs(a / width - b / width);
+	return PATH_STRAIGHT_COST * (Uint32)std::abs(dx - dy) + PATH_DIAGONAL_COST * (Uint32)std::min(dx, dy);
+}
+
+int HierarchicalPathfinder::addNode(const int & cell) {
+	if (cellNode[cell] >= 0)
+		return cellNode[cell];
+
+	Node node;
+	node.cell = cell;
+	node.cluster = getCluster(cell);
+	nodes.push_back(node);
+
+	const int index = (int)nodes.size() - 1;
+	cellNode[cell] = index;
+	clusterNodes[node.cluster].push_back(index);
+	return index;
+}
+
+void HierarchicalPathfinder::addEntrances(const int & a, const int & b, const int & step, const int & length) {
+	int offsets[2] = { (length - 1) / 2 * step, 0 };
+	int count = 1;
+	if (length >= ENTRANCE_SPLIT) {
+		offsets[0] = 0;
+		offsets[1] = (length - 1) * step;
+		count = 2;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		const int from = addNode(a + offsets[i]), to = addNode(b + offsets[i]);
+		nodes[from].edges.push_back(Edge{ to, PATH_STRAIGHT_COST });
+		nodes[to].edges.push_back(Edge{ from, PATH_STRAIGHT_COST });
+	}
+}
+
+void HierarchicalPathfinder::buildGraph() {
+	nodes.clear();
+	cellNode.assign(blocked.size(), -1);
+	clusterNodes.assign((size_t)clustersX * clustersY, std::vector<int>());
+
+	// entrances along the right and bottom border of every cluster
+	for (int cy = 0; cy < clustersY; ++cy) {
+		for (int cx = 0; cx < clustersX; ++cx) {
+			const int x0 = cx * clusterSize, y0 = cy * clusterSize;
+			const int x1 = std::min(x0 + clusterSize, width), y1 = std::min(y0 + clusterSize, height);
+
+			if (x1 < width) {
+				int run = 0;
+				for (int y = y0; y <= y1; ++y) {
+					const int a = y * width + x1 - 1;
+					if (y < y1 && !blocked[a] && !blocked[a + 1]) {
+						++run;
+						continue;
+					}
+					if (run > 0)
+						addEntrances(a - run * width, a - run * width + 1, width, run);
+					run = 0;
+				}
+			}
+
+			if (y1 < height) {
+				int run = 0;
+				for (int x = x0; x <= x1; ++x) {
+					const int a = (y1 - 1) * width + x;
+					if (x < x1 && !blocked[a] && !blocked[a + width]) {
+						++run;
+						continue;
+					}
+					if (run > 0)
+						addEntrances(a - run, a - run + width, 1, run);
+					run = 0;
+				}
+			}
+		}
+	}
+
+	// edges between the nodes of each cluster, costing the shortest way inside it
+	for (size_t c = 0; c < clusterNodes.size(); ++c) {
+		const std::vector<int> & members = clusterNodes[c];
+		for (size_t i = 0; i < members.size(); ++i) {
+			searchCluster(nodes[members[i]].cell, -1);
+			for (size_t j = 0; j < members.size(); ++j) {
+				const Uint32 cost = getLocalCost(nodes[members[j]].cell);
+				if (i != j && cost != PATH_UNREACHABLE)
+					nodes[members[i]].edges.push_back(Edge{ members[j], cost });
+			}
+		}
+	}
+
+	nodeCost.assign(nodes.size() + 2, PATH_UNREACHABLE);
+	nodeParent.assign(nodes.size() + 2, -1);
+	nodeStamp.assign(nodes.size() + 2, 0);
+	goalCost.assign(nodes.size(), PATH_UNREACHABLE);
+	nodeSearch = 0;
+}
+
+int HierarchicalPathfinder::searchCluster(const int & from, const int & goal) {
+	const int cluster = getCluster(from);
+	localX0 = cluster % clustersX * clusterSize;
+	localY0 = cluster / clustersX * clusterSize;
+	localX1 = std::min(localX0 + clusterSize, width);
+	localY1 = std::min(localY0 + clusterSize, height);
+
+	if (++localSearch == 0) {
+		std::fill(localStamp.begin(), localStamp.end(), 0);
+		localSearch = 1;
+	}
+
+	auto local = [this](const int & cell) { return (cell / width - localY0) * clusterSize + cell % width - localX0; };
+	auto heuristic = [this, &goal](const int & cell) { return goal >= 0 ? estimate(cell, goal) : 0; };
+
+	open.clear();
+	const int start = local(from);
+	localStamp[start] = localSearch;
+	localCost[start] = 0;
+	localParent[start] = -1;
+	open.push_back(((Uint64)heuristic(from) << 32) | (Uint64)from);
+
+	int work = 0;
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<Uint64>());
+		const Uint64 entry = open.back();
+		open.pop_back();
+
+		// cells are queued again when a cheaper way is found, the old entries are skipped
+		const int cell = (int)(entry & 0xFFFFFFFF);
+		const Uint32 cost = localCost[local(cell)];
+		if ((Uint32)(entry >> 32) > cost + heuristic(cell))
+			continue;
+		++work;
+		if (cell == goal)
+			break;
+
+		const int x = cell % width, y = cell / width;
+		for (int d = 0; d < 8; ++d) {
+			const int nx = x + PATH_DX[d], ny = y + PATH_DY[d];
+			if (nx < localX0 || ny < localY0 || nx >= localX1 || ny >= localY1 || !canStep(x, y, d))
+				continue;
+
+			const int next = ny * width + nx, l = local(next);
+			const Uint32 nextCost = cost + ((d & 1) ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST);
+			if (localStamp[l] != localSearch || nextCost < localCost[l]) {
+				localStamp[l] = localSearch;
+				localCost[l] = nextCost;
+				localParent[l] = cell;
+				open.push_back(((Uint64)(nextCost + heuristic(next)) << 32) | (Uint64)next);
+				std::push_heap(open.begin(), open.end(), std::greater<Uint64>());
+			}
+		}
+	}
+	return work;
+}
+
+Uint32 HierarchicalPathfinder::getLocalCost(const int & cell) const {
+	const int x = cell % width, y = cell / width;
+	if (x < localX0 || y < localY0 || x >= localX1 || y >= localY1)
+		return PATH_UNREACHABLE;
+
+	const int l = (y - localY0) * clusterSize + x - localX0;
+	return localStamp[l] == localSearch ? localCost[l] : PATH_UNREACHABLE;
+}
+
+int HierarchicalPathfinder::searchAbstract(Path & path) {
+	path.version = version;
+	path.waypoints.clear();
+	path.segment.clear();
+	path.nextWaypoint = 1;
+	path.nextCell = 0;
+	path.status = PATH_FAILED;
+
+	const int start = path.start, goal = path.goal;
+	if (start < 0 || goal < 0 || blocked[start] || blocked[goal])
+		return 1;
+
+	if (start == goal) {
+		path.waypoints.push_back(goal);
+		path.segment.push_back(goal);
+		path.status = PATH_FOUND;
+		return 1;
+	}
+
+	const Uint64 key = ((Uint64)start << 32) | (Uint64)goal;
+	auto cached = pathCache.find(key);
+	if (cached != pathCache.end()) {
+		path.waypoints = cached->second;
+		path.status = PATH_FOUND;
+		++cacheHits;
+		return 1;
+	}
+
+	// the goal joins the nodes of its cluster, the start the nodes of its own, neither is added to the graph
+	const int startCluster = getCluster(start), goalCluster = getCluster(goal);
+	int work = searchCluster(goal, -1);
+	for (int n : clusterNodes[goalCluster])
+		goalCost[n] = getLocalCost(nodes[n].cell);
+	const Uint32 direct = getLocalCost(start);	// moves cost the same both ways
+	work += searchCluster(start, -1);
+
+	if (++nodeSearch == 0) {
+		std::fill(nodeStamp.begin(), nodeStamp.end(), 0);
+		nodeSearch = 1;
+	}
+
+	const int startNode = (int)nodes.size(), goalNode = startNode + 1;
+	auto cellOf = [&](const int & n) { return n == startNode ? start : (n == goalNode ? goal : nodes[n].cell); };
+	auto relax = [&](const int & n, const Uint32 & cost, const int & parent) {
+		if (cost == PATH_UNREACHABLE || (nodeStamp[n] == nodeSearch && cost >= nodeCost[n]))
+			return;
+		nodeStamp[n] = nodeSearch;
+		nodeCost[n] = cost;
+		nodeParent[n] = parent;
+		open.push_back(((Uint64)(cost + estimate(cellOf(n), goal)) << 32) | (Uint64)n);
+		std::push_heap(open.begin(), open.end(), std::greater<Uint64>());
+	};
+
+	open.clear();
+	nodeStamp[startNode] = nodeSearch;
+	nodeCost[startNode] = 0;
+	nodeParent[startNode] = -1;
+	relax(goalNode, direct, startNode);
+	for (int n : clusterNodes[startCluster])
+		relax(n, getLocalCost(nodes[n].cell), startNode);
+
+	bool found = false;
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<Uint64>());
+		const Uint64 entry = open.back();
+		open.pop_back();
+
+		const int n = (int)(entry & 0xFFFFFFFF);
+		const Uint32 cost = nodeCost[n];
+		if ((Uint32)(entry >> 32) > cost + estimate(cellOf(n), goal))
+			continue;
+		++work;
+		if (n == goalNode) {
+			found = true;
+			break;
+		}
+
+		for (const Edge & edge : nodes[n].edges)
+			relax(edge.to, cost + edge.cost, n);
+		if (nodes[n].cluster == goalCluster && goalCost[n] != PATH_UNREACHABLE)
+			relax(goalNode, cost + goalCost[n], n);
+	}
+
+	if (!found)
+		return work;
+
+	for (int n = goalNode; n >= 0; n = nodeParent[n]) {
+		const int cell = cellOf(n);
+		if (path.waypoints.empty() || path.waypoints.back() != cell)
+			path.waypoints.push_back(cell);
+	}
+	std::reverse(path.waypoints.begin(), path.waypoints.end());
+	path.status = PATH_FOUND;
+
+	if (pathCache.size() >= (size_t)PATH_CACHE_SIZE)
+		pathCache.clear();
+	pathCache[key] = path.waypoints;
+	return work;
+}
+
+bool HierarchicalPathfinder::refine(const int & from, const int & to, std::vector<int> & cells) {
+	cells.clear();
+	const int x = from % width, y = from / width;
+	const int dx = to % width - x, dy = to / width - y;
+	if (dx == 0 && dy == 0)
+		return true;
+
+	// one step, e.g. across a cluster border
+	if (std::abs(dx) <= 1 && std::abs(dy) <= 1) {
+		for (int d = 0; d < 8; ++d) {
+			if (PATH_DX[d] == dx && PATH_DY[d] == dy && canStep(x, y, d)) {
+				cells.push_back(to);
+				return true;
+			}
+		}
+	}
+
+	// the cells between two nodes are the same for every path using that edge
+	const bool cacheable = cellNode[from] >= 0 && cellNode[to] >= 0;
+	const Uint64 key = ((Uint64)from << 32) | (Uint64)to;
+	if (cacheable) {
+		auto cached = segmentCache.find(key);
+		if (cached != segmentCache.end()) {
+			cells = cached->second;
+			return true;
+		}
+	}
+
+	if (getCluster(from) != getCluster(to))
+		return false;
+
+	searchCluster(from, to);
+	if (getLocalCost(to) == PATH_UNREACHABLE)
+		return false;
+
+	for (int cell = to; cell != from; cell = localParent[(cell / width - localY0) * clusterSize + cell % width - localX0])
+		cells.push_back(cell);
+	std::reverse(cells.begin(), cells.end());
+
+	if (cacheable)
+		segmentCache[key] = cells;
+	return true;
+}
+
+void HierarchicalPathfinder::rebuild() {
+	buildGraph();
+	dirty = false;
+	++version;
+	pathCache.clear();
+	segmentCache.clear();
+}
+
+PoolHandle HierarchicalPathfinder::requestPath(const Vector2f & from, const Vector2f & to) {
+	PoolHandle handle = paths.acquire();
+	Path * path = paths.get(handle);
+	if (!path)
+		return handle;
+
+	int x, y;
+	path->start = toCell(from, x, y) ? y * width + x : -1;
+	path->goal = toCell(to, x, y) ? y * width + x : -1;
+	path->status = PATH_PENDING;
+	path->version = version;
+	path->waypoints.clear();
+	path->segment.clear();
+	pending.push_back(handle);
+	return handle;
+}
+
+void HierarchicalPathfinder::releasePath(const PoolHandle & handle) {
+	paths.release(handle);		// a queued request is skipped by update()
+}
+
+PathStatus HierarchicalPathfinder::getStatus(const PoolHandle & handle) {
+	const Path * path = paths.get(handle);
+	if (!path)
+		return PATH_INVALID;
+	if (path->status != PATH_PENDING && path->version != version)
+		return PATH_INVALID;
+	return path->status;
+}
+
+bool HierarchicalPathfinder::nextWaypoint(const PoolHandle & handle, Vector2f & point) {
+	Path * path = paths.get(handle);
+	if (!path || path->status != PATH_FOUND || path->version != version)
+		return false;
+
+	while (path->nextCell >= path->segment.size()) {
+		if (path->nextWaypoint >= path->waypoints.size())
+			return false;
+
+		if (!refine(path->waypoints[path->nextWaypoint - 1], path->waypoints[path->nextWaypoint], path->segment)) {
+			path->status = PATH_FAILED;
+			return false;
+		}
+		++path->nextWaypoint;
+		path->nextCell = 0;
+	}
+
+	const int cell = path->segment[path->nextCell++];
+	point = getCellCenter(cell % width, cell / width);
+	return true;
+}
+
+void HierarchicalPathfinder::update() {
+	if (dirty)
+		rebuild();
+
+	lastWork = 0;
+	while (!pending.empty() && (searchBudget <= 0 || lastWork < searchBudget)) {
+		Path * path = paths.get(pending.front());
+		pending.pop_front();
+		if (path)
+			lastWork += searchAbstract(*path);
+	}
+}
+
+bool HierarchicalPathfinder::findPath(const Vector2f & from, const Vector2f & to, std::vector<Vector2f> & points) {
+	if (dirty)
+		rebuild();
+
+	points.clear();
+	Path path;
+	int x, y;
+	path.start = toCell(from, x, y) ? y * width + x : -1;
+	path.goal = toCell(to, x, y) ? y * width + x : -1;
+	searchAbstract(path);
+	if (path.status != PATH_FOUND)
+		return false;
+
+	points.push_back(getCellCenter(path.start % width, path.start / width));
+	for (size_t i = 1; i < path.waypoints.size(); ++i) {
+		if (!refine(path.waypoints[i - 1], path.waypoints[i], path.segment)) {
+			points.clear();
+			return false;
+		}
+		for (int cell : path.segment)
+			points.push_back(getCellCenter(cell % width, cell / width));
+	}
+	return true;
+}
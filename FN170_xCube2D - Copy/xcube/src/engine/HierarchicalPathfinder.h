@@ -0,0 +1,187 @@
+#ifndef __HIERARCHICAL_PATHFINDER_H__
+#define __HIERARCHICAL_PATHFINDER_H__
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL.h>
+
+#include "EngineCommon.h"
+#include "GameMath.h"
+#include "ObjectPool.h"
+
+static const int DEFAULT_CLUSTER_SIZE = 16;		// cells per cluster side
+static const int DEFAULT_MAX_PATHS = 1024;		// paths requested and not yet released
+static const int PATH_CACHE_SIZE = 256;			// abstract paths kept for repeated start / goal cells
+
+enum PathStatus {
+	PATH_PENDING,	// queued, update() has not searched it yet
+	PATH_FOUND,
+	PATH_FAILED,	// no path, or start / goal blocked or outside the grid
+	PATH_INVALID	// released, or obstacles changed since it was found, request a new one
+};
+
+/**
+ * Path finding for many agents with their own goals (HPA*) over a grid of free / blocked cells,
+ * moving like FlowField (8 neighbours, no cutting blocked corners).
+ *
+ * The grid is split into square clusters. Where two clusters share free border cells they get
+ * entrance nodes, and the nodes of a cluster are joined by edges costing the shortest way through it.
+ * A request only searches that small graph, plus the start and goal clusters, and the cells between
+ * two nodes are filled in when the agent walks that far (nextWaypoint()), cached per edge.
+ *
+ * Requests are queued and searched by update() within a per update budget,
+ * so hundreds of agents asking at once spread over several frames instead of one spike
+ */
+class HierarchicalPathfinder {
+	private:
+		struct Edge {
+			int to;
+			Uint32 cost;
+		};
+
+		struct Node {
+			int cell;
+			int cluster;
+			std::vector<Edge> edges;
+		};
+
+		struct Path {
+			Uint32 version;		// of the graph it was found on
+			PathStatus status;
+			int start, goal;			// cells
+			std::vector<int> waypoints;	// cells of the abstract path, start and goal included
+			size_t nextWaypoint;		// waypoint the current segment leads to
+			std::vector<int> segment;	// cells up to that waypoint, refined when reached
+			size_t nextCell;
+		};
+
+		int width, height;
+		float cellSize;
+		int clusterSize, clustersX, clustersY;
+		std::vector<Uint8> blocked;
+		bool dirty;
+		Uint32 version;
+
+		std::vector<Node> nodes;
+		std::vector<int> cellNode;		// node of each cell, -1 for most
+		std::vector<std::vector<int>> clusterNodes;
+
+		ObjectPool<Path> paths;
+		std::deque<PoolHandle> pending;
+		int searchBudget;
+		int lastWork;
+
+		std::unordered_map<Uint64, std::vector<int>> pathCache;		// (start << 32) | goal to waypoints
+		std::unordered_map<Uint64, std::vector<int>> segmentCache;	// (node cell << 32) | node cell to cells
+		int cacheHits;
+
+		// scratch of the searches, stamped instead of cleared
+		std::vector<Uint32> localCost;
+		std::vector<int> localParent;
+		std::vector<Uint32> localStamp;
+		Uint32 localSearch;
+		int localX0, localY0, localX1, localY1;	// cells of the cluster searched
+		std::vector<Uint32> nodeCost;
+		std::vector<int> nodeParent;
+		std::vector<Uint32> nodeStamp;
+		std::vector<Uint32> goalCost;
+		Uint32 nodeSearch;
+		std::vector<Uint64> open;
+
+		int getCluster(const int & cell) const;
+		bool canStep(const int & x, const int & y, const int & direction) const;
+		Uint32 estimate(const int & a, const int & b) const;
+
+		int addNode(const int & cell);
+		/**
+		* Adds the transitions of a run of free cell pairs a | b across a cluster border,
+		* one in the middle of a short run, one at each end of a long one
+		*/
+		void addEntrances(const int & a, const int & b, const int & step, const int & length);
+		void buildGraph();
+
+		/**
+		* Dijkstra (goal -1) or A* (goal a cell) from cell within its cluster, leaves costs and parents in the local scratch
+		* @return cells expanded
+		*/
+		int searchCluster(const int & from, const int & goal);
+		Uint32 getLocalCost(const int & cell) const;
+
+		/**
+		* @return search steps used
+		*/
+		int searchAbstract(Path & path);
+		bool refine(const int & from, const int & to, std::vector<int> & cells);
+	public:
+		/**
+		* @param width, height - in cells, the grid starts at pixel (0, 0)
+		* @param cellSize - in pixels
+		*/
+		HierarchicalPathfinder(const int & width, const int & height, const float & cellSize,
+			const int & clusterSize = DEFAULT_CLUSTER_SIZE, const int & maxPaths = DEFAULT_MAX_PATHS);
+
+		int getWidth() const { return width; }
+		int getHeight() const { return height; }
+
+		bool toCell(const Vector2f & position, int & x, int & y) const;
+		Vector2f getCellCenter(const int & x, const int & y) const;
+
+		/**
+		* Obstacle changes rebuild the cluster graph at the next update() and invalidate every path
+		*/
+		void setBlocked(const int & x, const int & y, const bool & isBlocked);
+		void setBlockedRect(const SDL_Rect & rect, const bool & isBlocked);
+		bool isBlocked(const int & x, const int & y) const;
+
+		/**
+		* Builds the cluster graph now instead of at the next update(), e.g. after a level loads
+		*/
+		void rebuild();
+
+		/**
+		* Queues a path from one pixel position to another
+		* @return handle for the calls below, invalid (status PATH_INVALID) if maxPaths are in use
+		*/
+		PoolHandle requestPath(const Vector2f & from, const Vector2f & to);
+
+		/**
+		* Gives the path's slot back, call once the agent is done with it
+		*/
+		void releasePath(const PoolHandle & handle);
+
+		PathStatus getStatus(const PoolHandle & handle);
+
+		/**
+		* Moves to the next cell of a found path, filling in cells between waypoints as needed
+		* @param point - center of that cell, in pixels
+		* @return false once the goal was handed out, or if the path is not PATH_FOUND
+		*/
+		bool nextWaypoint(const PoolHandle & handle, Vector2f & point);
+
+		/**
+		* @param steps - nodes and cells expanded per update() by queued searches, 0 (the default) for no limit.
+		*				A search that starts is finished, so one update can go over by one search
+		*/
+		void setSearchBudget(const int & steps) { searchBudget = steps; }
+
+		/**
+		* Rebuilds the graph if obstacles changed and searches queued requests within the budget
+		*/
+		void update();
+
+		/**
+		* Searches and refines a whole path at once, for tools and tests
+		* @param points - centers of the cells from from's to to's, both included
+		* @return false if there is none
+		*/
+		bool findPath(const Vector2f & from, const Vector2f & to, std::vector<Vector2f> & points);
+
+		int getPendingCount() const { return (int)pending.size(); }
+		int getNodeCount() const { return (int)nodes.size(); }
+		int getLastWork() const { return lastWork; }
+		int getCacheHits() const { return cacheHits; }
+};
+
+#endif
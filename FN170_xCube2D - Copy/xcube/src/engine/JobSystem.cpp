@@ -0,0 +1,73 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(const int & threadCount) : job(nullptr), chunkCount(0), nextChunk(0), busyWorkers(0), generation(0), quit(false) {
+	for (int i = 1; i < threadCount; ++i)
+		workers.push_back(std::thread(&JobSystem::workerLoop, this));
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+}
+
+void JobSystem::workerLoop() {
+	unsigned int seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen] { return quit || generation != seen; });
+			if (quit)
+				return;
+			seen = generation;
+		}
+
+		runChunks();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busyWorkers == 0)
+			done.notify_one();
+	}
+}
+
+void JobSystem::runChunks() {
+	for (;;) {
+		int chunk = nextChunk.fetch_add(1);
+		if (chunk >= chunkCount)
+			return;
+		(*job)(chunk);
+	}
+}
+
+void JobSystem::parallelFor(const int & count, const std::function<void(int)> & function) {
+	if (count <= 0)
+		return;
+
+	// not worth waking anyone
+	if (workers.empty() || count == 1) {
+		for (int chunk = 0; chunk < count; ++chunk)
+			function(chunk);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &function;
+		chunkCount = count;
+		nextChunk = 0;
+		busyWorkers = (int)workers.size();
+		++generation;
+	}
+	wake.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] { return busyWorkers == 0; });
+	job = nullptr;
+}
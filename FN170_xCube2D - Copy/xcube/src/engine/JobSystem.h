@@ -0,0 +1,52 @@
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Small fixed pool of worker threads for data parallel loops
+ *
+ * parallelFor() hands out chunk indices to the workers, the calling thread
+ * works through chunks as well and only returns once every chunk is done.
+ * Which thread runs which chunk is not fixed, so callers wanting deterministic
+ * results write each chunk's output to its own slot and merge in chunk order
+ */
+class JobSystem {
+	private:
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+
+		// current job, only changed while no worker is busy
+		const std::function<void(int)> * job;
+		int chunkCount;
+		std::atomic<int> nextChunk;
+		int busyWorkers;
+		unsigned int generation;	// bumped for every job so workers can tell a new one from a spurious wake up
+		bool quit;
+
+		void workerLoop();
+		void runChunks();
+	public:
+		/**
+		* @param threadCount - threads working on a job including the caller, i.e. threadCount - 1 workers
+		*/
+		explicit JobSystem(const int & threadCount);
+		~JobSystem();
+
+		int getThreadCount() const { return (int)workers.size() + 1; }
+
+		/**
+		* Calls job(chunk) once for every chunk in [0, chunkCount) and waits for all of them.
+		* Jobs must not throw
+		*/
+		void parallelFor(const int & chunkCount, const std::function<void(int)> & job);
+};
+
+#endif
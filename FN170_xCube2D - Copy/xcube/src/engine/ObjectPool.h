@@ -0,0 +1,144 @@
+#ifndef __OBJECT_POOL_H__
+#define __OBJECT_POOL_H__
+
+#include <vector>
+
+#include <SDL_stdinc.h>
+
+#include "EngineCommon.h"
+
+/**
+ * Refers to an object of an ObjectPool, goes stale (get() gives nullptr)
+ * once the object is released, even if its slot is reused
+ */
+struct PoolHandle {
+	Uint32 index;
+	Uint32 generation;
+
+	PoolHandle() : index(0xFFFFFFFF), generation(0) {}
+	PoolHandle(Uint32 index, Uint32 generation) : index(index), generation(generation) {}
+
+	bool operator==(const PoolHandle & other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const PoolHandle & other) const { return !(*this == other); }
+};
+
+/**
+ * Fixed number of objects constructed up front and handed out again and again,
+ * so acquiring and releasing never touch the heap. Objects keep their address for the
+ * pool's lifetime (raw pointers to them, e.g. physics user data, stay valid) and keep
+ * their state when released, acquire() gives an object for the caller to reset.
+ *
+ * The objects in use are also listed densely in the order acquired, released ones are
+ * swapped out of that list, so iterating costs the objects in use rather than the capacity
+ */
+template <class T>
+class ObjectPool {
+	private:
+		std::vector<T> objects;
+		std::vector<Uint32> generations;
+		std::vector<int> activeIndex;	// slot to position in active, -1 while free
+		std::vector<Uint32> active;		// slots in use
+		std::vector<Uint32> freeSlots;	// last released first, its object is likely still cached
+	public:
+		/**
+		* Default constructs capacity objects
+		*/
+		explicit ObjectPool(const int & capacity) : objects(capacity), generations(capacity, 1), activeIndex(capacity, -1) {
+			if (capacity <= 0)
+				throw EngineException("Invalid object pool capacity:", std::to_string(capacity));
+
+			active.reserve(capacity);
+			freeSlots.reserve(capacity);
+			for (int i = capacity - 1; i >= 0; --i)
+				freeSlots.push_back((Uint32)i);
+		}
+
+		ObjectPool(const ObjectPool &) = delete;
+		ObjectPool & operator=(const ObjectPool &) = delete;
+
+		/**
+		* @return a handle to a free object, an invalid handle (get() gives nullptr) if all are in use
+		*/
+		PoolHandle acquire() {
+			if (freeSlots.empty())
+				return PoolHandle();
+
+			Uint32 slot = freeSlots.back();
+			freeSlots.pop_back();
+			activeIndex[slot] = (int)active.size();
+			active.push_back(slot);
+			return PoolHandle(slot, generations[slot]);
+		}
+
+		/**
+		* @return false if the handle was already stale
+		*/
+		bool release(const PoolHandle & handle) {
+			if (!isValid(handle))
+				return false;
+			releaseActive(activeIndex[handle.index]);
+			return true;
+		}
+
+		/**
+		* Releases the i-th object in use, the last one in use takes its place
+		*/
+		void releaseActive(const int & i) {
+			Uint32 slot = active[i];
+			Uint32 last = active.back();
+			active[i] = last;
+			activeIndex[last] = i;
+			active.pop_back();
+
+			activeIndex[slot] = -1;
+			++generations[slot];
+			freeSlots.push_back(slot);
+		}
+
+		/**
+		* Releases every object in use for which pred(object) returns true
+		*/
+		template <class F>
+		void releaseIf(F pred) {
+			for (int i = 0; i < (int)active.size();) {
+				if (pred(objects[active[i]]))
+					releaseActive(i);	// the swapped in object is looked at next
+				else
+					++i;
+			}
+		}
+
+		void releaseAll() {
+			while (!active.empty())
+				releaseActive((int)active.size() - 1);
+		}
+
+		bool isValid(const PoolHandle & handle) const {
+			return handle.index < generations.size() && generations[handle.index] == handle.generation && activeIndex[handle.index] >= 0;
+		}
+
+		/**
+		* @return the object, nullptr if the handle is stale
+		*/
+		T * get(const PoolHandle & handle) { return isValid(handle) ? &objects[handle.index] : nullptr; }
+
+		int getCount() const { return (int)active.size(); }
+		int getCapacity() const { return (int)objects.size(); }
+
+		/**
+		* @return the i-th object in use, i in [0, getCount())
+		*/
+		T & getActive(const int & i) { return objects[active[i]]; }
+		PoolHandle getActiveHandle(const int & i) const { return PoolHandle(active[i], generations[active[i]]); }
+
+		/**
+		* Calls f(object) for every object in use
+		*/
+		template <class F>
+		void forEach(F f) {
+			for (size_t i = 0; i < active.size(); ++i)
+				f(objects[active[i]]);
+		}
+};
+
+#endif
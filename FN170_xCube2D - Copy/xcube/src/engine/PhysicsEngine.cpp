@@ -1,50 +1,1869 @@
 #include "PhysicsEngine.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const float BOUNCE_MIN_SPEED = 30.0f;	// pixels per second, slower impacts do not bounce so resting bodies settle
+
+// a body as the pixel mask test sees it, in double which holds float and Q16.16 positions exactly
+struct MaskedBody {
+	const PixelMask * mask;
+	double x, y, halfX, halfY;
+};
+
+// top left pixel of a mask centered on a body, rounded so an odd sized mask's middle pixel holds the center
+static int maskOrigin(const double & center, const int & size) {
+	return (int)std::floor(center - size * 0.5 + 0.5);
+}
+
+// called once the shapes overlap. two masks are tested against each other,
+// a single mask against the other body's bounding box, in the first mask's pixels
+static bool masksOverlap(MaskedBody a, MaskedBody b) {
+	if (nullptr == a.mask)
+		std::swap(a, b);
+	if (nullptr == a.mask)
+		return true;
+
+	int ax = maskOrigin(a.x, a.mask->getWidth()), ay = maskOrigin(a.y, a.mask->getHeight());
+	if (nullptr != b.mask)
+		return overlapPixelMasks(*a.mask, *b.mask, maskOrigin(b.x, b.mask->getWidth()) - ax, maskOrigin(b.y, b.mask->getHeight()) - ay);
+
+	// every pixel the open box reaches into
+	return overlapPixelMaskRect(*a.mask, (int)std::floor(b.x - b.halfX) - ax, (int)std::floor(b.y - b.halfY) - ay,
+		(int)std::ceil(b.x + b.halfX) - ax, (int)std::ceil(b.y + b.halfY) - ay);
+}
+
 PhysicsObject::PhysicsObject(const Point2 & center, float x, float y)
-: center(center), lX(x), lY(y), hlX(x / 2.0f), hlY(y / 2.0f), force(0.0f, 0.0f) {}
+: lX(x), lY(y), hlX(x / 2.0f), hlY(y / 2.0f), position((float)center.x, (float)center.y), velocity(0.0f, 0.0f), force(0.0f, 0.0f),
+	motion(MOTION_KINEMATIC), mass(1.0f), damping(0.0f), restitution(0.0f), sensor(false), category(COLLIDE_ALL), mask(COLLIDE_ALL),
+	owner(nullptr), engineIndex(-1), bodyId(0), bullet(false), stepFrom(position), stepTo(position), userData(nullptr), userType(0) {}
 
 bool PhysicsObject::isColliding(const PhysicsObject & other) {
-    Rectf r1 = { center.x - hlX, center.y - hlY, lX, lY };
-    Rectf r2 = { other.center.x - other.hlX, other.center.y - other.hlY, other.lX, other.lY };
+	Vector2f p = getPosition(), q = other.getPosition();
+	if (shape.type != SHAPE_BOX || other.shape.type != SHAPE_BOX) {
+		ShapeContact contact;
+		if (!overlapShapes(getPose(), other.getPose(), contact))
+			return false;
+	}
+	// compared in float, going through SDL_Rect truncated fractional sizes
+	else if (!(p.x - hlX < q.x + other.hlX && q.x - other.hlX < p.x + hlX
+		&& p.y - hlY < q.y + other.hlY && q.y - other.hlY < p.y + hlY)) {
+		return false;
+	}
+
+	Vector2f halfP = getBoundsHalf(), halfQ = other.getBoundsHalf();
+	MaskedBody a = { pixelMask.get(), p.x, p.y, halfP.x, halfP.y };
+	MaskedBody b = { other.pixelMask.get(), q.x, q.y, halfQ.x, halfQ.y };
+	return masksOverlap(a, b);
+}
+
+void PhysicsObject::setShape(const CollisionShape & newShape) {
+	shape = newShape;
+	if (nullptr == owner)
+		return;
+
+	// a sleeping body that grew has to look for what it now touches
+	owner->wakeBody(engineIndex);
+	owner->bodies.storeShape(engineIndex, *this);
+	owner->syncBounds(engineIndex);
+}
+
+void PhysicsObject::setPixelMask(const std::shared_ptr<const PixelMask> & mask) {
+	pixelMask = mask;
+
+	// contacts kept from the last update were found without this mask, have them tested again
+	if (nullptr != owner) {
+		owner->wakeBody(engineIndex);
+		owner->syncBounds(engineIndex);
+	}
+}
+
+Vector2f PhysicsObject::getBoundsHalf() const {
+	return shape.type == SHAPE_BOX ? Vector2f(hlX, hlY) : shape.getHalfExtents();
+}
+
+ShapePose PhysicsObject::getPose() const {
+	if (nullptr != owner)
+		return owner->getPose(engineIndex);
+	return ShapePose(&shape, position, PhysicsVector(getBoundsHalf()));
+}
+
+void PhysicsObject::setBullet(bool isBullet) {
+	bullet = isBullet;
+	stepFrom = stepTo = getPosition();
+	if (nullptr != owner) {
+		owner->bodies.bullet[engineIndex] = isBullet ? 1 : 0;
+		owner->bodies.sweepX[engineIndex] = stepFrom.x;
+		owner->bodies.sweepY[engineIndex] = stepFrom.y;
+		owner->syncBounds(engineIndex);
+	}
+}
+
+void PhysicsObject::setPosition(const Vector2f & p) {
+	if (nullptr == owner) {
+		position = PhysicsVector(p);
+		return;
+	}
+
+	if (owner->bodies.posX[engineIndex] == p.x && owner->bodies.posY[engineIndex] == p.y)
+		return;
 
-	return r1.intersects(r2);
+	owner->wakeBody(engineIndex);	// may move the body to another index
+	owner->bodies.posX[engineIndex] = p.x;
+	owner->bodies.posY[engineIndex] = p.y;
+	owner->syncBounds(engineIndex);
 }
 
-void PhysicsObject::applyForce(const Vector2f & v) {
-	force = v;
+Vector2f PhysicsObject::getPosition() const {
+	return nullptr != owner ? owner->getPosition(engineIndex) : Vector2f(position);
+}
+
+//sets the center point of the physics object
+void PhysicsObject::setCenter(const Point2& p)
+{
+	setPosition(Vector2f((float)p.x, (float)p.y));
+}
+//gets the center point of the physics object
+Point2 PhysicsObject::getCenter() const
+{
+	Vector2f p = getPosition();
+	return Point2((int)std::floor(p.x + 0.5f), (int)std::floor(p.y + 0.5f));
+}
+
+void PhysicsObject::setVelocity(const Vector2f & v) {
+	if (nullptr == owner) {
+		velocity = PhysicsVector(v);
+		return;
+	}
+	owner->wakeBody(engineIndex);
+	owner->bodies.velX[engineIndex] = v.x;
+	owner->bodies.velY[engineIndex] = v.y;
+}
+
+Vector2f PhysicsObject::getVelocity() const {
+	if (nullptr == owner)
+		return Vector2f(velocity);
+	return Vector2f((float)owner->bodies.velX[engineIndex], (float)owner->bodies.velY[engineIndex]);
+}
+
+void PhysicsObject::applyForce(const Vector2f & f) {
+	if (nullptr == owner) {
+		force = PhysicsVector(force.x + f.x, force.y + f.y);
+		return;
+	}
+	owner->wakeBody(engineIndex);
+	owner->bodies.forceX[engineIndex] += f.x;
+	owner->bodies.forceY[engineIndex] += f.y;
+}
+
+void PhysicsObject::applyImpulse(const Vector2f & impulse) {
+	if (motion != MOTION_DYNAMIC)
+		return;
+	Vector2f v = getVelocity();
+	setVelocity(Vector2f(v.x + impulse.x / mass, v.y + impulse.y / mass));
+}
+
+void PhysicsObject::setMotionType(MotionType type) {
+	motion = type;
+	syncMaterial();
+	if (nullptr == owner)
+		return;
+
+	if (type == MOTION_STATIC && engineIndex < owner->activeCount) {
+		owner->bodies.velX[engineIndex] = owner->bodies.velY[engineIndex] = 0.0f;
+		owner->deactivate(engineIndex);
+	}
+	else {
+		owner->wakeBody(engineIndex);
+	}
+}
+
+void PhysicsObject::wake() {
+	if (nullptr != owner)
+		owner->wakeBody(engineIndex);
+}
+
+bool PhysicsObject::isAwake() const {
+	if (nullptr == owner)
+		return motion != MOTION_STATIC;
+	return engineIndex < owner->activeCount;
+}
+
+void PhysicsObject::setMass(const float & m) {
+	if (m <= 0.0f)
+		throw EngineException("Invalid body mass:", std::to_string(m));
+	mass = m;
+	syncMaterial();
+}
+
+void PhysicsObject::setDamping(const float & d) {
+	damping = std::max(0.0f, d);
+	syncMaterial();
+}
+
+void PhysicsObject::setRestitution(const float & r) {
+	restitution = std::max(0.0f, std::min(1.0f, r));
+	syncMaterial();
+}
+
+void PhysicsObject::setSensor(bool isSensor) {
+	sensor = isSensor;
+	syncMaterial();
+}
+
+void PhysicsObject::setCollisionFilter(const Uint32 & newCategory, const Uint32 & newMask) {
+	category = newCategory;
+	mask = newMask;
+	syncMaterial();
+
+	// cached contacts were accepted under the old filter, have them tested again
+	if (nullptr != owner)
+		owner->syncBounds(engineIndex);
+}
+
+void PhysicsObject::syncMaterial() {
+	if (nullptr != owner)
+		owner->bodies.storeMaterial(engineIndex, *this);
 }
 
 void PhysicsObject::applyGravity(const PhysicsEngine & engine) {
-	center += engine.gravity;
+	Vector2f p = getPosition();
+	setPosition(Vector2f(p.x + engine.gravity.x, p.y + engine.gravity.y));
 }
 
 void PhysicsObject::applyAntiGravity(const PhysicsEngine & engine) {
-	center -= engine.gravity;
+	Vector2f p = getPosition();
+	setPosition(Vector2f(p.x - engine.gravity.x, p.y - engine.gravity.y));
+}
+
+/* BODY STORE */
+
+void PhysicsEngine::BodyStore::push(const PhysicsObject & obj) {
+	posX.push_back(obj.position.x);
+	posY.push_back(obj.position.y);
+	sweepX.push_back(obj.position.x);
+	sweepY.push_back(obj.position.y);
+	halfX.push_back(obj.hlX);
+	halfY.push_back(obj.hlY);
+	velX.push_back(obj.velocity.x);
+	velY.push_back(obj.velocity.y);
+	forceX.push_back(obj.force.x);
+	forceY.push_back(obj.force.y);
+	invMass.push_back(0.0f);
+	gravityScale.push_back(0.0f);
+	damping.push_back(0.0f);
+	restitution.push_back(0.0f);
+	minX.push_back(0.0f);
+	minY.push_back(0.0f);
+	maxX.push_back(0.0f);
+	maxY.push_back(0.0f);
+	moved.push_back(1);
+	bullet.push_back(obj.bullet ? 1 : 0);
+	sensor.push_back(0);
+	category.push_back(COLLIDE_ALL);
+	mask.push_back(COLLIDE_ALL);
+	layer.push_back(0);
+	staticBody.push_back(0);
+	sleepTime.push_back(0.0f);
+	shape.push_back(SHAPE_BOX);
+	radius.push_back(0.0f);
+	storeMaterial((int)posX.size() - 1, obj);
+	storeShape((int)posX.size() - 1, obj);
+}
+
+void PhysicsEngine::BodyStore::storeMaterial(const int & i, const PhysicsObject & obj) {
+	// kinematic and static bodies get zero inverse mass and gravity so the integrator needs no branch for them
+	bool dynamic = obj.motion == MOTION_DYNAMIC;
+	invMass[i] = dynamic ? PhysicsReal(1) / obj.mass : PhysicsReal(0);
+	gravityScale[i] = dynamic ? 1 : 0;
+	damping[i] = obj.damping;
+	restitution[i] = obj.restitution;
+	sensor[i] = obj.sensor ? 1 : 0;
+	category[i] = obj.category;
+	mask[i] = obj.mask;
+	staticBody[i] = obj.motion == MOTION_STATIC ? 1 : 0;
+
+	Uint8 lowest = 0;
+	while (lowest < MAX_COLLISION_LAYERS - 1 && !(obj.category & (1u << lowest)))
+		++lowest;
+	layer[i] = lowest;
+}
+
+void PhysicsEngine::BodyStore::storeShape(const int & i, const PhysicsObject & obj) {
+	Vector2f half = obj.getBoundsHalf();
+	halfX[i] = half.x;
+	halfY[i] = half.y;
+	shape[i] = (Uint8)obj.shape.type;
+	radius[i] = obj.shape.radius;
+}
+
+void PhysicsEngine::BodyStore::load(const int & i, PhysicsObject & obj) const {
+	obj.position = PhysicsVector(posX[i], posY[i]);
+	obj.velocity = PhysicsVector(velX[i], velY[i]);
+	obj.force = PhysicsVector(forceX[i], forceY[i]);
+}
+
+template <class T>
+static void swapPop(std::vector<T> & v, const int & i) {
+	v[i] = v.back();
+	v.pop_back();
+}
+
+void PhysicsEngine::BodyStore::swap(const int & i, const int & j) {
+	std::swap(posX[i], posX[j]); std::swap(posY[i], posY[j]);
+	std::swap(sweepX[i], sweepX[j]); std::swap(sweepY[i], sweepY[j]);
+	std::swap(halfX[i], halfX[j]); std::swap(halfY[i], halfY[j]);
+	std::swap(velX[i], velX[j]); std::swap(velY[i], velY[j]);
+	std::swap(forceX[i], forceX[j]); std::swap(forceY[i], forceY[j]);
+	std::swap(invMass[i], invMass[j]); std::swap(gravityScale[i], gravityScale[j]);
+	std::swap(damping[i], damping[j]); std::swap(restitution[i], restitution[j]);
+	std::swap(minX[i], minX[j]); std::swap(minY[i], minY[j]); std::swap(maxX[i], maxX[j]); std::swap(maxY[i], maxY[j]);
+	std::swap(moved[i], moved[j]); std::swap(bullet[i], bullet[j]); std::swap(sensor[i], sensor[j]);
+	std::swap(category[i], category[j]); std::swap(mask[i], mask[j]); std::swap(layer[i], layer[j]);
+	std::swap(staticBody[i], staticBody[j]); std::swap(sleepTime[i], sleepTime[j]);
+	std::swap(shape[i], shape[j]); std::swap(radius[i], radius[j]);
+}
+
+void PhysicsEngine::BodyStore::swapRemove(const int & i) {
+	swapPop(posX, i); swapPop(posY, i);
+	swapPop(sweepX, i); swapPop(sweepY, i);
+	swapPop(halfX, i); swapPop(halfY, i);
+	swapPop(velX, i); swapPop(velY, i);
+	swapPop(forceX, i); swapPop(forceY, i);
+	swapPop(invMass, i); swapPop(gravityScale, i);
+	swapPop(damping, i); swapPop(restitution, i);
+	swapPop(minX, i); swapPop(minY, i); swapPop(maxX, i); swapPop(maxY, i);
+	swapPop(moved, i); swapPop(bullet, i); swapPop(sensor, i);
+	swapPop(category, i); swapPop(mask, i); swapPop(layer, i);
+	swapPop(staticBody, i); swapPop(sleepTime, i);
+	swapPop(shape, i); swapPop(radius, i);
+}
+
+template <class Store, class Visitor>
+void PhysicsEngine::BodyStore::forEachArray(Store & store, Visitor & visit) {
+	visit(store.posX); visit(store.posY);
+	visit(store.sweepX); visit(store.sweepY);
+	visit(store.halfX); visit(store.halfY);
+	visit(store.velX); visit(store.velY);
+	visit(store.forceX); visit(store.forceY);
+	visit(store.invMass); visit(store.gravityScale);
+	visit(store.damping); visit(store.restitution);
+	visit(store.minX); visit(store.minY); visit(store.maxX); visit(store.maxY);
+	visit(store.moved); visit(store.bullet); visit(store.sensor);
+	visit(store.category); visit(store.mask); visit(store.layer);
+	visit(store.staticBody); visit(store.sleepTime);
+	visit(store.shape); visit(store.radius);
 }
 
 /* PHYSICS ENGINE */
 
-PhysicsEngine::PhysicsEngine() : gravity(Vector2f(0, DEFAULT_GRAVITY)) {}
+PhysicsEngine::PhysicsEngine() : gravity(Vector2f(0, DEFAULT_GRAVITY)), nextBodyId(1), activeCount(0), sleepEnabled(true),
+	gravityAcceleration(0.0f, 0.0f), timeStep(DEFAULT_TIME_STEP), substeps(DEFAULT_SUBSTEPS), broadphase(BROADPHASE_GRID),
+	cellSize(DEFAULT_CELL_SIZE), staticMoved(false), sapDirty(true), reportStay(false), pairTests(0) {}
+
+PhysicsEngine::~PhysicsEngine() {}
 
 void PhysicsEngine::setGravity(float val, float interval) {
 	gravity = Vector2f(0, val * interval);
 }
 
+void PhysicsEngine::setTimeStep(const float & seconds, const int & steps) {
+	if (seconds <= 0.0f || steps <= 0)
+		throw EngineException("Invalid physics time step:", std::to_string(seconds) + " x " + std::to_string(steps));
+	timeStep = seconds;
+	substeps = steps;
+}
+
+void PhysicsEngine::setCellSize(const int & size) {
+	if (size <= 0)
+		throw EngineException("Invalid broadphase cell size:", std::to_string(size));
+	cellSize = size;
+	activeGrid.dirty = staticGrid.dirty = true;
+}
+
+void PhysicsEngine::setSleepEnabled(bool enabled) {
+	sleepEnabled = enabled;
+	if (enabled)
+		return;
+
+	for (int i = activeCount; i < (int)objects.size(); ++i)
+		if (!bodies.staticBody[i])
+			activate(i);
+}
+
 void PhysicsEngine::registerObject(std::shared_ptr<PhysicsObject> obj) {
+	if (obj->isRegistered())
+		return;
+
+	Uint32 slot;
+	if (freeSlots.empty()) {
+		slot = (Uint32)slotGeneration.size();
+		slotGeneration.push_back(1);
+		slotObject.push_back(-1);
+	}
+	else {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+
+	int index = (int)objects.size();
+	slotObject[slot] = index;
+	objectSlot.push_back(slot);
+
+	bodies.push(*obj);
+	obj->owner = this;
+	obj->engineIndex = index;
+	obj->handle = BodyHandle(slot, slotGeneration[slot]);
+	obj->bodyId = nextBodyId++;
+	obj->stepFrom = obj->stepTo = Vector2f(obj->position);
 	objects.push_back(obj);
+
+	// appended behind the last static / sleeping body, moving bodies join the awake ones
+	if (!bodies.staticBody[index])
+		index = activate(index);
+	syncBounds(index);
+}
+
+void PhysicsEngine::unregisterObject(std::shared_ptr<PhysicsObject> obj) {
+	int index = obj->engineIndex;
+	if (obj->owner != this || index < 0 || index >= (int)objects.size() || objects[index] != obj)
+		return;
+
+	// the object keeps its state for when it is registered again
+	bodies.load(index, *obj);
+
+	// out of the awake range first, so the swap with the last body keeps the split intact
+	if (index < activeCount)
+		index = deactivate(index);
+
+	// swap with the last object, order does not matter to the broadphase
+	int last = (int)objects.size() - 1;
+	objects[index] = objects[last];
+	objects[index]->engineIndex = index;
+	objects.pop_back();
+	bodies.swapRemove(index);
+
+	Uint32 slot = objectSlot[index];
+	objectSlot[index] = objectSlot[last];
+	objectSlot.pop_back();
+	if (index != last)
+		slotObject[objectSlot[index]] = index;
+
+	slotObject[slot] = -1;
+	++slotGeneration[slot];		// invalidates outstanding handles
+	freeSlots.push_back(slot);
+
+	staticGrid.dirty = true;
+
+	obj->owner = nullptr;
+	obj->engineIndex = -1;
+	obj->handle = BodyHandle();
+
+	// contacts hold raw pointers, drop the ones that could dangle, keeping them sorted
+	PhysicsObject * raw = obj.get();
+	contacts.erase(std::remove_if(contacts.begin(), contacts.end(),
+		[raw](const ContactPair & c) { return c.a == raw || c.b == raw; }), contacts.end());
+	events.erase(std::remove_if(events.begin(), events.end(),
+		[raw](const ContactEvent & e) { return e.a == raw || e.b == raw; }), events.end());
+}
+
+bool PhysicsEngine::isValid(const BodyHandle & handle) const {
+	return handle.slot < slotGeneration.size() && slotGeneration[handle.slot] == handle.generation && slotObject[handle.slot] >= 0;
+}
+
+PhysicsObject * PhysicsEngine::getObject(const BodyHandle & handle) const {
+	return isValid(handle) ? objects[slotObject[handle.slot]].get() : nullptr;
+}
+
+void PhysicsEngine::syncBounds(const int & i) {
+	// bullets cover their whole path since the last update so the broadphase finds everything they crossed
+	PhysicsReal startX = bodies.bullet[i] ? bodies.sweepX[i] : bodies.posX[i];
+	PhysicsReal startY = bodies.bullet[i] ? bodies.sweepY[i] : bodies.posY[i];
+
+	bodies.minX[i] = toFloatDown(std::min(startX, bodies.posX[i]) - bodies.halfX[i]);
+	bodies.minY[i] = toFloatDown(std::min(startY, bodies.posY[i]) - bodies.halfY[i]);
+	bodies.maxX[i] = toFloatUp(std::max(startX, bodies.posX[i]) + bodies.halfX[i]);
+	bodies.maxY[i] = toFloatUp(std::max(startY, bodies.posY[i]) + bodies.halfY[i]);
+	bodies.moved[i] = 1;
+
+	if (i < activeCount) {
+		activeGrid.dirty = true;
+	}
+	else {
+		staticGrid.dirty = true;
+		staticMoved = true;
+	}
+}
+
+void PhysicsEngine::swapBodies(int i, int j) {
+	if (i == j)
+		return;
+
+	bodies.swap(i, j);
+	swapObjects(i, j);
+}
+
+void PhysicsEngine::swapObjects(int i, int j) {
+	std::swap(objects[i], objects[j]);
+	objects[i]->engineIndex = i;
+	objects[j]->engineIndex = j;
+
+	std::swap(objectSlot[i], objectSlot[j]);
+	slotObject[objectSlot[i]] = i;
+	slotObject[objectSlot[j]] = j;
+}
+
+int PhysicsEngine::activate(int i) {
+	int j = activeCount++;
+	swapBodies(i, j);
+	bodies.sleepTime[j] = 0.0f;
+	bodies.moved[j] = 1;	// retest against everything
+	activeGrid.dirty = staticGrid.dirty = true;
+	sapDirty = true;
+	return j;
+}
+
+int PhysicsEngine::deactivate(int i) {
+	int j = --activeCount;
+	swapBodies(i, j);
+	activeGrid.dirty = staticGrid.dirty = true;
+	sapDirty = true;
+	return j;
+}
+
+void PhysicsEngine::wakeBody(const int & i) {
+	bodies.sleepTime[i] = 0.0f;
+	if (i >= activeCount && !bodies.staticBody[i])
+		activate(i);
+}
+
+ShapePose PhysicsEngine::getPose(const int & i) const {
+	return ShapePose(&objects[i]->shape, PhysicsVector(bodies.posX[i], bodies.posY[i]), PhysicsVector(bodies.halfX[i], bodies.halfY[i]));
+}
+
+AABBArrays PhysicsEngine::getBodyArrays() const {
+	AABBArrays arrays = { bodies.minX.data(), bodies.minY.data(), bodies.maxX.data(), bodies.maxY.data() };
+	return arrays;
+}
+
+static Uint64 packCell(const int & x, const int & y) {
+	return ((Uint64)(Uint32)x << 32) | (Uint64)(Uint32)y;
+}
+
+static bool pairLess(const ContactPair & p, const ContactPair & q) {
+	return p.a->getBodyId() < q.a->getBodyId() || (p.a->getBodyId() == q.a->getBodyId() && p.b->getBodyId() < q.b->getBodyId());
+}
+
+void PhysicsEngine::buildGrid(CellGrid & grid, const int & begin, const int & end) {
+	const float invCell = 1.0f / cellSize;
+
+	grid.entries.clear();
+	grid.oversized.clear();
+	cellRanges.resize(objects.size());
+
+	for (int i = begin; i < end; ++i) {
+		CellRange & range = cellRanges[i];
+
+		range.minX = (int)std::floor(bodies.minX[i] * invCell);
+		range.minY = (int)std::floor(bodies.minY[i] * invCell);
+		range.maxX = (int)std::floor(bodies.maxX[i] * invCell);
+		range.maxY = (int)std::floor(bodies.maxY[i] * invCell);
+
+		int cells = (range.maxX - range.minX + 1) * (range.maxY - range.minY + 1);
+		range.oversized = cells > MAX_CELLS_PER_OBJECT;
+		if (range.oversized) {
+			grid.oversized.push_back(i);
+			continue;
+		}
+
+		for (int y = range.minY; y <= range.maxY; ++y)
+			for (int x = range.minX; x <= range.maxX; ++x) {
+				CellEntry entry = { packCell(x, y), i };
+				grid.entries.push_back(entry);
+			}
+	}
+
+	// objects sharing a cell end up next to each other
+	std::sort(grid.entries.begin(), grid.entries.end());
+	grid.dirty = false;
+}
+
+void PhysicsEngine::buildDirtyGrids() {
+	if (activeGrid.dirty)
+		buildGrid(activeGrid, 0, activeCount);
+	if (staticGrid.dirty)
+		buildGrid(staticGrid, activeCount, (int)objects.size());
+}
+
+void PhysicsEngine::findPairsGrid() {
+	buildGrid(activeGrid, 0, activeCount);
+
+	const std::vector<CellEntry> & cellEntries = activeGrid.entries;
+	const size_t entryCount = cellEntries.size();
+	for (size_t runStart = 0; runStart < entryCount; ) {
+		Uint64 cell = cellEntries[runStart].cell;
+		size_t runEnd = runStart + 1;
+		while (runEnd < entryCount && cellEntries[runEnd].cell == cell)
+			++runEnd;
+
+		int cellX = (int)(Uint32)(cell >> 32);
+		int cellY = (int)(Uint32)(cell & 0xFFFFFFFF);
+
+		for (size_t m = runStart; m < runEnd; ++m) {
+			int i = cellEntries[m].object;
+			const CellRange & ri = cellRanges[i];
+
+			for (size_t n = m + 1; n < runEnd; ++n) {
+				int j = cellEntries[n].object;
+				const CellRange & rj = cellRanges[j];
+
+				// a pair sharing several cells is only tested in the first cell of their overlap
+				if (std::max(ri.minX, rj.minX) != cellX || std::max(ri.minY, rj.minY) != cellY)
+					continue;
+
+				addCandidate(i, j);
+			}
+		}
+
+		runStart = runEnd;
+	}
+
+	// bodies too large for the grid are tested against every other awake body, in one batch each
+	batchHits.resize(activeCount);
+	AABBArrays arrays = getBodyArrays();
+	const std::vector<int> & oversized = activeGrid.oversized;
+	for (size_t k = 0; k < oversized.size(); ++k) {
+		int i = oversized[k];
+		int hits = overlapAABBBatch(bodies.minX[i], bodies.minY[i], bodies.maxX[i], bodies.maxY[i], arrays, 0, activeCount, batchHits.data());
+
+		for (int h = 0; h < hits; ++h) {
+			int j = batchHits[h];
+			if (j == i || (cellRanges[j].oversized && j < i))
+				continue;	// oversized pairs once only
+			addCandidate(i, j);
+		}
+	}
+}
+
+void PhysicsEngine::findPairsSAP() {
+	const int count = activeCount;
+
+	if (sapDirty) {
+		// bodies woke, slept or came and went, start from a full sort
+		sapOrder.resize(count);
+		for (int k = 0; k < count; ++k)
+			sapOrder[k] = k;
+
+		const std::vector<float> & minX = bodies.minX;
+		std::sort(sapOrder.begin(), sapOrder.end(), [&minX](const int & a, const int & b) {
+			return minX[a] < minX[b] || (minX[a] == minX[b] && a < b);
+		});
+		sapDirty = false;
+	}
+
+	// insertion sort, bodies move little between updates so the order is almost sorted already
+	for (int k = 1; k < count; ++k) {
+		int index = sapOrder[k];
+		float minX = bodies.minX[index];
+		int m = k - 1;
+		while (m >= 0 && bodies.minX[sapOrder[m]] > minX) {
+			sapOrder[m + 1] = sapOrder[m];
+			--m;
+		}
+		sapOrder[m + 1] = index;
+	}
+
+	// gather in sweep order so every candidate window is contiguous
+	sapMinX.resize(count);
+	sapMinY.resize(count);
+	sapMaxX.resize(count);
+	sapMaxY.resize(count);
+	for (int k = 0; k < count; ++k) {
+		int index = sapOrder[k];
+		sapMinX[k] = bodies.minX[index];
+		sapMinY[k] = bodies.minY[index];
+		sapMaxX[k] = bodies.maxX[index];
+		sapMaxY[k] = bodies.maxY[index];
+	}
+
+	batchHits.resize(count);
+	AABBArrays sorted = { sapMinX.data(), sapMinY.data(), sapMaxX.data(), sapMaxY.data() };
+	for (int k = 0; k < count; ++k) {
+		// everything starting before k ends along x is a candidate
+		int end = k + 1;
+		while (end < count && sapMinX[end] < sapMaxX[k])
+			++end;
+
+		int window = end - k - 1;
+		if (window == 0)
+			continue;
+
+		int hits = overlapAABBBatch(sapMinX[k], sapMinY[k], sapMaxX[k], sapMaxY[k], sorted, k + 1, window, batchHits.data());
+		for (int h = 0; h < hits; ++h)
+			addCandidate(sapOrder[k], sapOrder[batchHits[h]]);
+	}
+}
+
+void PhysicsEngine::findStaticPairs() {
+	const int count = (int)objects.size();
+	if (activeCount == 0 || activeCount == count) {
+		staticMoved = false;
+		return;
+	}
+
+	if (staticGrid.dirty)
+		buildGrid(staticGrid, activeCount, count);
+
+	// static bodies never meet each other, only awake bodies look for them.
+	// if no static body was placed, the ones still since the last update keep their contacts
+	const bool testAll = staticMoved;
+	staticMoved = false;
+
+	const float invCell = 1.0f / cellSize;
+	AABBArrays arrays = getBodyArrays();
+	batchHits.resize(count);
+
+	for (int i = 0; i < activeCount; ++i) {
+		if (!testAll && isStill(i))
+			continue;
+
+		int minCellX = (int)std::floor(bodies.minX[i] * invCell), minCellY = (int)std::floor(bodies.minY[i] * invCell);
+		int maxCellX = (int)std::floor(bodies.maxX[i] * invCell), maxCellY = (int)std::floor(bodies.maxY[i] * invCell);
+		long cells = (long)(maxCellX - minCellX + 1) * (long)(maxCellY - minCellY + 1);
+
+		if (cells > MAX_CELLS_PER_OBJECT) {
+			int hits = overlapAABBBatch(bodies.minX[i], bodies.minY[i], bodies.maxX[i], bodies.maxY[i], arrays, activeCount, count - activeCount, batchHits.data());
+			for (int h = 0; h < hits; ++h)
+				addCandidate(i, batchHits[h]);
+			continue;
+		}
+
+		for (int y = minCellY; y <= maxCellY; ++y)
+			for (int x = minCellX; x <= maxCellX; ++x) {
+				size_t begin, end;
+				if (!findCell(staticGrid, packCell(x, y), begin, end))
+					continue;
+
+				for (size_t e = begin; e < end; ++e) {
+					int j = staticGrid.entries[e].object;
+					const CellRange & rj = cellRanges[j];
+
+					// first shared cell only, as in findPairsGrid()
+					if (std::max(minCellX, rj.minX) != x || std::max(minCellY, rj.minY) != y)
+						continue;
+
+					addCandidate(i, j);
+				}
+			}
+
+		for (size_t k = 0; k < staticGrid.oversized.size(); ++k) {
+			int j = staticGrid.oversized[k];
+			if (bodies.minX[i] < bodies.maxX[j] && bodies.minX[j] < bodies.maxX[i] && bodies.minY[i] < bodies.maxY[j] && bodies.minY[j] < bodies.maxY[i])
+				addCandidate(i, j);
+		}
+	}
+
+	if (!testAll)
+		return;
+
+	// a placed static body can land on sleeping ones, which no awake body looks for
+	for (int i = activeCount; i < count; ++i) {
+		if (!bodies.staticBody[i] || !bodies.moved[i])
+			continue;
+
+		int hits = overlapAABBBatch(bodies.minX[i], bodies.minY[i], bodies.maxX[i], bodies.maxY[i], arrays, activeCount, count - activeCount, batchHits.data());
+		for (int h = 0; h < hits; ++h)
+			if (!bodies.staticBody[batchHits[h]])
+				addCandidate(i, batchHits[h]);
+	}
+}
+
+void PhysicsEngine::addCandidate(const int & i, const int & j) {
+	// neither moved, the pair is already carried over from last update by carryStillContacts()
+	if (isStill(i) && isStill(j))
+		return;
+
+	if (!acceptPair(i, j))
+		return;
+
+	CandidatePair pair = { i, j };
+	candidates.push_back(pair);
+}
+
+bool PhysicsEngine::acceptPair(const int & i, const int & j) {
+	LayerStats & si = layerStats[bodies.layer[i]];
+	LayerStats & sj = layerStats[bodies.layer[j]];
+	++si.candidates;
+	if (&si != &sj)
+		++sj.candidates;
+
+	if ((bodies.category[i] & bodies.mask[j]) && (bodies.category[j] & bodies.mask[i]))
+		return true;
+
+	++si.filtered;
+	if (&si != &sj)
+		++sj.filtered;
+	return false;
+}
+
+void PhysicsEngine::setThreadCount(const int & count) {
+	if (count < 0)
+		throw EngineException("Invalid physics thread count:", std::to_string(count));
+
+	int threads = count > 0 ? count : (int)std::thread::hardware_concurrency();
+	if (threads <= 1)
+		jobs.reset();
+	else if (!jobs || jobs->getThreadCount() != threads)
+		jobs.reset(new JobSystem(threads));
+}
+
+void PhysicsEngine::narrowPhase() {
+	const int count = (int)candidates.size();
+	const int chunks = (count + NARROW_PHASE_CHUNK - 1) / NARROW_PHASE_CHUNK;
+	pairTests = count;
+
+	if (chunkCircles.empty())
+		chunkCircles.resize(1);
+
+	if (!jobs || chunks < 2) {
+		narrowChunk(0, count, contacts, chunkCircles[0]);
+		return;
+	}
+
+	// every chunk writes its own list and they are joined in chunk order,
+	// so the contacts come out exactly as the single threaded loop makes them
+	if ((int)chunkContacts.size() < chunks)
+		chunkContacts.resize(chunks);
+	if ((int)chunkCircles.size() < chunks)
+		chunkCircles.resize(chunks);
+
+	jobs->parallelFor(chunks, [this, count](int chunk) {
+		int begin = chunk * NARROW_PHASE_CHUNK;
+		chunkContacts[chunk].clear();
+		narrowChunk(begin, std::min(count, begin + NARROW_PHASE_CHUNK), chunkContacts[chunk], chunkCircles[chunk]);
+	});
+
+	for (int c = 0; c < chunks; ++c)
+		contacts.insert(contacts.end(), chunkContacts[c].begin(), chunkContacts[c].end());
+}
+
+// sweepAABB() for either scalar, the narrow phase runs it in PhysicsReal
+template <class T>
+static bool sweepBoxes(T aMinX, T aMinY, T aMaxX, T aMaxY, const Vector2T<T> & motion,
+	T bMinX, T bMinY, T bMaxX, T bMaxY, T & time, Vector2T<T> & normal) {
+	normal = Vector2T<T>();
+	if (aMinX < bMaxX && bMinX < aMaxX && aMinY < bMaxY && bMinY < aMaxY) {
+		time = 0;
+		return true;
+	}
+
+	// slab test, the boxes overlap while both axes' overlap intervals do
+	T enter = 0, exit = 1;
+	const T aMin[2] = { aMinX, aMinY }, aMax[2] = { aMaxX, aMaxY };
+	const T bMin[2] = { bMinX, bMinY }, bMax[2] = { bMaxX, bMaxY };
+	const T d[2] = { motion.x, motion.y };
+	int enterAxis = -1;
+
+	for (int axis = 0; axis < 2; ++axis) {
+		if (d[axis] == T(0)) {
+			if (aMax[axis] <= bMin[axis] || aMin[axis] >= bMax[axis])
+				return false;	// never overlaps on this axis
+			continue;
+		}
+
+		T t0 = (bMin[axis] - aMax[axis]) / d[axis];
+		T t1 = (bMax[axis] - aMin[axis]) / d[axis];
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		if (t0 > enter) {
+			enter = t0;
+			enterAxis = axis;
+		}
+		exit = std::min(exit, t1);
+
+		if (enter >= exit)
+			return false;
+	}
+
+	time = enter;
+	if (enterAxis == 0)
+		normal.x = motion.x > T(0) ? -1 : 1;
+	else if (enterAxis == 1)
+		normal.y = motion.y > T(0) ? -1 : 1;
+	return true;
+}
+
+static bool isRound(const Uint8 & shape) {
+	return shape == SHAPE_CIRCLE || shape == SHAPE_CAPSULE;
+}
+
+// radius of a circle around the body's center holding its whole shape
+static float getBoundingRadius(const CollisionShape & shape, const float & halfX, const float & halfY) {
+	switch (shape.type) {
+		case SHAPE_CIRCLE:
+			return (float)shape.radius;
+		case SHAPE_CAPSULE:
+			return (float)shape.radius + length(Vector2f(shape.segment));
+		case SHAPE_POLYGON: {
+			float radius = 0.0f;
+			for (int v = 0; v < shape.vertexCount; ++v)
+				radius = std::max(radius, length(Vector2f(shape.vertices[v])));
+			return radius;
+		}
+		default:
+			return length(Vector2f(halfX, halfY));
+	}
+}
+
+bool PhysicsEngine::sweepShapes(const int & i, const int & j, const PhysicsVector & motion) const {
+	const BodyStore & s = bodies;
+
+	// as in narrowChunk() one body moves by motion and the other stays at its start position.
+	// the moving one is grown along its path into a capsule, the round one if there is one so the test is exact
+	int mover = i, target = j;
+	PhysicsVector path = motion;
+	if (!isRound(s.shape[i]) && isRound(s.shape[j])) {
+		std::swap(mover, target);
+		path = PhysicsVector(-motion.x, -motion.y);
+	}
+
+	PhysicsReal fromX = s.bullet[mover] ? s.sweepX[mover] : s.posX[mover], fromY = s.bullet[mover] ? s.sweepY[mover] : s.posY[mover];
+	PhysicsReal toX = s.bullet[target] ? s.sweepX[target] : s.posX[target], toY = s.bullet[target] ? s.sweepY[target] : s.posY[target];
+
+	CollisionShape capsule;
+	capsule.type = SHAPE_CAPSULE;
+	capsule.radius = getBoundingRadius(objects[mover]->shape, (float)s.halfX[mover], (float)s.halfY[mover]);
+	capsule.segment = PhysicsVector(path.x / 2, path.y / 2);
+
+	ShapeContact contact;
+	return overlapShapes(ShapePose(&capsule, PhysicsVector(fromX + capsule.segment.x, fromY + capsule.segment.y), PhysicsVector()),
+		ShapePose(&objects[target]->shape, PhysicsVector(toX, toY), PhysicsVector(s.halfX[target], s.halfY[target])), contact);
+}
+
+bool PhysicsEngine::pixelsOverlap(const int & i, const int & j) const {
+	const PixelMask * maskA = objects[i]->pixelMask.get(), * maskB = objects[j]->pixelMask.get();
+	if (nullptr == maskA && nullptr == maskB)
+		return true;
+
+	const BodyStore & s = bodies;
+	MaskedBody a = { maskA, (double)s.posX[i], (double)s.posY[i], (double)s.halfX[i], (double)s.halfY[i] };
+	MaskedBody b = { maskB, (double)s.posX[j], (double)s.posY[j], (double)s.halfX[j], (double)s.halfY[j] };
+	return masksOverlap(a, b);
+}
+
+void PhysicsEngine::addContact(const int & i, const int & j, const float & time, std::vector<ContactPair> & out) const {
+	PhysicsObject * a = objects[i].get();
+	PhysicsObject * b = objects[j].get();
+	if (a->bodyId > b->bodyId)
+		std::swap(a, b);
+	out.push_back(ContactPair(a, b, time));
+}
+
+void PhysicsEngine::narrowChunk(const int & begin, const int & end, std::vector<ContactPair> & out, CircleBatch & circles) const {
+	// reads the body store only, safe to run on several threads at once
+	const BodyStore & s = bodies;
+	circles.clear();
+
+	for (int k = begin; k < end; ++k) {
+		int i = candidates[k].i, j = candidates[k].j;
+
+		// exact bounds from the body state, the float ones the broadphase used may be rounded
+		PhysicsReal aX = s.bullet[i] ? s.sweepX[i] : s.posX[i], aY = s.bullet[i] ? s.sweepY[i] : s.posY[i];
+		PhysicsReal bX = s.bullet[j] ? s.sweepX[j] : s.posX[j], bY = s.bullet[j] ? s.sweepY[j] : s.posY[j];
+		if (!(std::min(aX, s.posX[i]) - s.halfX[i] < std::max(bX, s.posX[j]) + s.halfX[j]
+			&& std::min(bX, s.posX[j]) - s.halfX[j] < std::max(aX, s.posX[i]) + s.halfX[i]
+			&& std::min(aY, s.posY[i]) - s.halfY[i] < std::max(bY, s.posY[j]) + s.halfY[j]
+			&& std::min(bY, s.posY[j]) - s.halfY[j] < std::max(aY, s.posY[i]) + s.halfY[i]))
+			continue;
+
+		PhysicsReal time = 1;
+		if (s.bullet[i] || s.bullet[j]) {
+			// the swept bounds overlap, find out if the boxes really meet along the way
+			// b's motion is taken off a's so b can be treated as still at its start position
+			PhysicsVector motion((s.posX[i] - aX) - (s.posX[j] - bX), (s.posY[i] - aY) - (s.posY[j] - bY));
+
+			PhysicsVector normal;
+			if (!sweepBoxes(aX - s.halfX[i], aY - s.halfY[i], aX + s.halfX[i], aY + s.halfY[i], motion,
+				bX - s.halfX[j], bY - s.halfY[j], bX + s.halfX[j], bY + s.halfY[j], time, normal))
+				continue;
+
+			// the bounds meet on the way, other shapes are checked along the whole path
+			if ((s.shape[i] != SHAPE_BOX || s.shape[j] != SHAPE_BOX) && !sweepShapes(i, j, motion))
+				continue;
+		}
+		else if (s.shape[i] != SHAPE_BOX || s.shape[j] != SHAPE_BOX) {
+#ifndef XCUBE_FIXED_POINT
+			// the most common pair after boxes, tested together after the loop.
+			// fixed point keeps them in the exact integer test
+			if (s.shape[i] == SHAPE_CIRCLE && s.shape[j] == SHAPE_CIRCLE) {
+				CandidatePair pair = { i, j };
+				circles.pairs.push_back(pair);
+				circles.dx.push_back(s.posX[j] - s.posX[i]);
+				circles.dy.push_back(s.posY[j] - s.posY[i]);
+				circles.radiusSum.push_back(s.radius[i] + s.radius[j]);
+				continue;
+			}
+#endif
+			ShapeContact contact;
+			if (!overlapShapes(getPose(i), getPose(j), contact))
+				continue;
+		}
+
+		// the shapes meet, masks decide at the end position. bullets keep the shape test along their path
+		if (!s.bullet[i] && !s.bullet[j] && !pixelsOverlap(i, j))
+			continue;
+
+		addContact(i, j, (float)time, out);
+	}
+
+	// contacts are sorted after the narrow phase, so these can come last
+	if (circles.pairs.empty())
+		return;
+
+	circles.hits.resize(circles.pairs.size());
+	int hits = overlapCircleBatch(circles.dx.data(), circles.dy.data(), circles.radiusSum.data(), (int)circles.pairs.size(), circles.hits.data());
+	for (int h = 0; h < hits; ++h) {
+		const CandidatePair & pair = circles.pairs[circles.hits[h]];
+		if (pixelsOverlap(pair.i, pair.j))
+			addContact(pair.i, pair.j, 1.0f, out);
+	}
+}
+
+bool PhysicsEngine::sweepAABB(float aMinX, float aMinY, float aMaxX, float aMaxY, const Vector2f & motion,
+	float bMinX, float bMinY, float bMaxX, float bMaxY, float & time, Vector2f & normal) {
+	return sweepBoxes(aMinX, aMinY, aMaxX, aMaxY, motion, bMinX, bMinY, bMaxX, bMaxY, time, normal);
+}
+
+bool PhysicsEngine::getFirstHit(const PhysicsObject * bullet, SweepHit & hit) const {
+	if (!bullet->bullet || bullet->owner != this)
+		return false;
+
+	const ContactPair * first = nullptr;
+	for (size_t i = 0; i < contacts.size(); ++i) {
+		const ContactPair & c = contacts[i];
+		if ((c.a == bullet || c.b == bullet) && (nullptr == first || c.time < first->time))
+			first = &c;
+	}
+
+	if (nullptr == first)
+		return false;
+
+	PhysicsObject * other = first->getOther(bullet);
+	Vector2f motion(bullet->stepTo.x - bullet->stepFrom.x, bullet->stepTo.y - bullet->stepFrom.y);
+	if (other->bullet)
+		motion = Vector2f(motion.x - (other->stepTo.x - other->stepFrom.x), motion.y - (other->stepTo.y - other->stepFrom.y));
+
+	Vector2f otherStart = other->bullet ? other->stepFrom : getPosition(other->engineIndex);
+	hit.object = other;
+	hit.time = first->time;
+	hit.normal = Vector2f(0.0f, 0.0f);
+	sweepAABB(bullet->stepFrom.x - bullet->hlX, bullet->stepFrom.y - bullet->hlY, bullet->stepFrom.x + bullet->hlX, bullet->stepFrom.y + bullet->hlY, motion,
+		otherStart.x - other->hlX, otherStart.y - other->hlY, otherStart.x + other->hlX, otherStart.y + other->hlY, hit.time, hit.normal);
+
+	hit.position = Vector2f(bullet->stepFrom.x + (bullet->stepTo.x - bullet->stepFrom.x) * hit.time,
+		bullet->stepFrom.y + (bullet->stepTo.y - bullet->stepFrom.y) * hit.time);
+	return true;
+}
+
+// the integrator's loops take their arrays as restrict parameters,
+// the arrays never overlap and saying so lets the compiler vectorize without runtime alias checks
+
+template <class T>
+static void integrateSubstep(T * __restrict posX, T * __restrict posY, T * __restrict velX, T * __restrict velY,
+	const T * __restrict accX, const T * __restrict accY, const T * __restrict damping, const int count, const T h) {
+	// semi-implicit Euler, the position step uses the new velocity
+	for (int i = 0; i < count; ++i) {
+		T drag = T(1) / (T(1) + h * damping[i]);
+		velX[i] = (velX[i] + accX[i] * h) * drag;
+		velY[i] = (velY[i] + accY[i] * h) * drag;
+		posX[i] += velX[i] * h;
+		posY[i] += velY[i] * h;
+	}
+}
+
+template <class T>
+static void computeBounds(const T * __restrict pos, const T * __restrict sweep, const T * __restrict half, const Uint8 * __restrict bullet,
+	float * __restrict lower, float * __restrict upper, const int count) {
+	// one axis of syncBounds(), both values loaded so the select needs no branch
+	for (int i = 0; i < count; ++i) {
+		T p = pos[i], s = sweep[i];
+		T start = bullet[i] ? s : p;
+		lower[i] = toFloatDown((start < p ? start : p) - half[i]);
+		upper[i] = toFloatUp((start < p ? p : start) + half[i]);
+	}
+}
+
+void PhysicsEngine::integrate() {
+	// static and sleeping bodies sit past activeCount and are skipped entirely
+	const int count = activeCount;
+	const PhysicsReal h = timeStep / substeps;
+	BodyStore & s = bodies;
+
+	// forces become accelerations once per update, they are constant over the substeps
+	for (int i = 0; i < count; ++i) {
+		s.forceX[i] = gravityAcceleration.x * s.gravityScale[i] + s.forceX[i] * s.invMass[i];
+		s.forceY[i] = gravityAcceleration.y * s.gravityScale[i] + s.forceY[i] * s.invMass[i];
+	}
+
+	for (int step = 0; step < substeps; ++step)
+		integrateSubstep(s.posX.data(), s.posY.data(), s.velX.data(), s.velY.data(), s.forceX.data(), s.forceY.data(), s.damping.data(), count, h);
+
+	std::fill(s.forceX.begin(), s.forceX.begin() + count, PhysicsReal(0));
+	std::fill(s.forceY.begin(), s.forceY.begin() + count, PhysicsReal(0));
+
+	int moving = 0;
+	for (int i = 0; i < count; ++i) {
+		int m = (s.velX[i] != PhysicsReal(0)) | (s.velY[i] != PhysicsReal(0));
+		s.moved[i] |= (Uint8)m;
+		moving |= m;
+	}
+
+	if (!moving)
+		return;	// all bodies at rest, the bounds and grid are still valid
+
+	computeBounds(s.posX.data(), s.sweepX.data(), s.halfX.data(), s.bullet.data(), s.minX.data(), s.maxX.data(), count);
+	computeBounds(s.posY.data(), s.sweepY.data(), s.halfY.data(), s.bullet.data(), s.minY.data(), s.maxY.data(), count);
+	activeGrid.dirty = true;
+}
+
+void PhysicsEngine::resolveContacts() {
+	BodyStore & s = bodies;
+
+	for (size_t c = 0; c < contacts.size(); ++c) {
+		int i = contacts[c].a->engineIndex;
+		int j = contacts[c].b->engineIndex;
+
+		// kinematic pairs, triggers and bullets only report contacts, sleeping pairs stay where they are
+		PhysicsReal total = s.invMass[i] + s.invMass[j];
+		if (total == PhysicsReal(0) || (i >= activeCount && j >= activeCount) || s.sensor[i] || s.sensor[j] || s.bullet[i] || s.bullet[j])
+			continue;
+
+		// current shapes, an earlier contact may already have separated them.
+		// the normal points from a to b
+		PhysicsReal nx = 0, ny = 0, depth;
+		if (s.shape[i] == SHAPE_BOX && s.shape[j] == SHAPE_BOX) {
+			PhysicsReal overlapX = std::min(s.posX[i] + s.halfX[i], s.posX[j] + s.halfX[j]) - std::max(s.posX[i] - s.halfX[i], s.posX[j] - s.halfX[j]);
+			PhysicsReal overlapY = std::min(s.posY[i] + s.halfY[i], s.posY[j] + s.halfY[j]) - std::max(s.posY[i] - s.halfY[i], s.posY[j] - s.halfY[j]);
+			if (overlapX <= PhysicsReal(0) || overlapY <= PhysicsReal(0))
+				continue;
+
+			// separate along the axis of least penetration
+			if (overlapX < overlapY) {
+				nx = s.posX[j] >= s.posX[i] ? 1 : -1;
+				depth = overlapX;
+			}
+			else {
+				ny = s.posY[j] >= s.posY[i] ? 1 : -1;
+				depth = overlapY;
+			}
+		}
+		else {
+			ShapeContact contact;
+			if (!overlapShapes(getPose(i), getPose(j), contact))
+				continue;
+
+			nx = contact.normal.x;
+			ny = contact.normal.y;
+			depth = contact.depth;
+		}
+
+		// split by inverse mass so kinematic bodies stay where they are
+		PhysicsReal shareA = s.invMass[i] / total, shareB = s.invMass[j] / total;
+		s.posX[i] -= nx * depth * shareA;
+		s.posY[i] -= ny * depth * shareA;
+		s.posX[j] += nx * depth * shareB;
+		s.posY[j] += ny * depth * shareB;
+
+		PhysicsReal approach = (s.velX[j] - s.velX[i]) * nx + (s.velY[j] - s.velY[i]) * ny;
+		if (approach < PhysicsReal(0)) {
+			PhysicsReal e = approach < -PhysicsReal(BOUNCE_MIN_SPEED) ? std::max(s.restitution[i], s.restitution[j]) : PhysicsReal(0);
+			PhysicsReal impulse = -(PhysicsReal(1) + e) * approach / total;
+			s.velX[i] -= nx * impulse * s.invMass[i];
+			s.velY[i] -= ny * impulse * s.invMass[i];
+			s.velX[j] += nx * impulse * s.invMass[j];
+			s.velY[j] += ny * impulse * s.invMass[j];
+		}
+
+		if (shareA > PhysicsReal(0))
+			syncBounds(i);
+		if (shareB > PhysicsReal(0))
+			syncBounds(j);
+	}
+}
+
+void PhysicsEngine::endBulletSteps() {
+	// the plain box is inside the swept bounds the grid was built from, so the grid stays usable for queries
+	bool wasDirty = activeGrid.dirty;
+
+	for (size_t i = 0; i < objects.size(); ++i) {
+		if (!bodies.bullet[i])
+			continue;
+
+		PhysicsObject & obj = *objects[i];
+		obj.stepFrom = Vector2f((float)bodies.sweepX[i], (float)bodies.sweepY[i]);
+		obj.stepTo = getPosition((int)i);
+		bodies.sweepX[i] = bodies.posX[i];
+		bodies.sweepY[i] = bodies.posY[i];
+		syncBounds((int)i);	// shrink back to the plain box
+	}
+
+	activeGrid.dirty = wasDirty;
+}
+
+void PhysicsEngine::countLayerStats() {
+	for (size_t i = 0; i < objects.size(); ++i)
+		++layerStats[bodies.layer[i]].bodies;
+
+	for (size_t c = 0; c < contacts.size(); ++c) {
+		int la = bodies.layer[contacts[c].a->engineIndex];
+		int lb = bodies.layer[contacts[c].b->engineIndex];
+		++layerStats[la].contacts;
+		if (la != lb)
+			++layerStats[lb].contacts;
+	}
+}
+
+const LayerStats & PhysicsEngine::getLayerStats(const int & layer) const {
+	if (layer < 0 || layer >= MAX_COLLISION_LAYERS)
+		throw EngineException("Invalid collision layer:", std::to_string(layer));
+	return layerStats[layer];
+}
+
+static const Uint64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const Uint64 FNV_PRIME = 1099511628211ULL;
+
+static void hashWord(Uint64 & hash, const Uint32 & word) {
+	// FNV-1a a byte at a time, so the result does not depend on endianness
+	for (int b = 0; b < 4; ++b) {
+		hash ^= (word >> (b * 8)) & 0xFF;
+		hash *= FNV_PRIME;
+	}
+}
+
+Uint64 PhysicsEngine::getStateChecksum() const {
+	Uint64 hash = FNV_OFFSET_BASIS;
+	hashWord(hash, (Uint32)objects.size());
+	hashWord(hash, (Uint32)activeCount);
+
+	// the body order only depends on the calls made, so it is part of the state too
+	for (size_t i = 0; i < objects.size(); ++i) {
+		hashWord(hash, objects[i]->bodyId);
+		hashWord(hash, rawBits(bodies.posX[i]));
+		hashWord(hash, rawBits(bodies.posY[i]));
+		hashWord(hash, rawBits(bodies.velX[i]));
+		hashWord(hash, rawBits(bodies.velY[i]));
+		hashWord(hash, rawBits(bodies.sleepTime[i]));
+	}
+
+	for (size_t c = 0; c < contacts.size(); ++c) {
+		hashWord(hash, contacts[c].a->bodyId);
+		hashWord(hash, contacts[c].b->bodyId);
+	}
+
+	return hash;
+}
+
+/* SNAPSHOTS */
+
+static const Uint32 SNAPSHOT_MAGIC = 0x53504358;	// "XCPS"
+static const Uint32 SNAPSHOT_VERSION = 1;
+
+#ifdef XCUBE_FIXED_POINT
+static const Uint32 SNAPSHOT_FIXED_POINT = 1;
+#else
+static const Uint32 SNAPSHOT_FIXED_POINT = 0;
+#endif
+
+// all records are plain data, copied in and out with memcpy
+struct SnapshotHeader {
+	Uint32 magic, version, fixedPoint;
+	Uint32 bodyCount, activeCount, contactCount, eventCount;
+	Uint32 staticMoved;
+};
+
+// what the body store does not hold, and the handle that finds the object again on restore
+struct SnapshotBody {
+	Uint32 slot, generation;
+	MotionType motion;
+	float mass, damping, restitution;
+	Uint32 category, mask;
+	Uint8 sensor, bullet;
+	Vector2f stepFrom, stepTo;
+	CollisionShape shape;
+};
+
+struct SnapshotContact {
+	Uint32 a, b;	// body indices
+	float time;
+};
+
+struct SnapshotEvent {
+	Uint32 type, a, b;
+};
+
+struct ArraySizer {
+	size_t bytes;
+	template <class T> void operator()(const std::vector<T> & v) { bytes += v.size() * sizeof(T); }
+};
+
+// bytes of the store before one of its arrays
+struct ArrayOffset {
+	const void * array;
+	size_t bytes;
+	bool found;
+	template <class T> void operator()(const std::vector<T> & v) {
+		if (static_cast<const void *>(&v) == array)
+			found = true;
+		else if (!found)
+			bytes += v.size() * sizeof(T);
+	}
+};
+
+struct ArrayWriter {
+	Uint8 * out;
+	template <class T> void operator()(const std::vector<T> & v) {
+		if (!v.empty())
+			std::memcpy(out, v.data(), v.size() * sizeof(T));
+		out += v.size() * sizeof(T);
+	}
+};
+
+struct ArrayReader {
+	const Uint8 * in;
+	size_t count;
+	template <class T> void operator()(std::vector<T> & v) {
+		v.resize(count);
+		if (count > 0)
+			std::memcpy(v.data(), in, count * sizeof(T));
+		in += count * sizeof(T);
+	}
+};
+
+template <class T>
+static void writeRecord(Uint8 *& out, const T & record) {
+	std::memcpy(out, &record, sizeof(T));
+	out += sizeof(T);
+}
+
+template <class T>
+static void readRecord(const Uint8 *& in, T & record) {
+	std::memcpy(&record, in, sizeof(T));
+	in += sizeof(T);
+}
+
+void PhysicsEngine::saveSnapshot(PhysicsSnapshot & snapshot) const {
+	const int count = (int)objects.size();
+
+	// bytes per body of the store, the same for every body
+	ArraySizer sizer = { 0 };
+	BodyStore::forEachArray(bodies, sizer);
+
+	size_t size = sizeof(SnapshotHeader) + count * sizeof(SnapshotBody) + sizer.bytes
+		+ contacts.size() * sizeof(SnapshotContact) + events.size() * sizeof(SnapshotEvent);
+	snapshot.buffer.resize(size);
+	Uint8 * out = snapshot.buffer.data();
+
+	SnapshotHeader header = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION, SNAPSHOT_FIXED_POINT,
+		(Uint32)count, (Uint32)activeCount, (Uint32)contacts.size(), (Uint32)events.size(), staticMoved ? 1u : 0u };
+	writeRecord(out, header);
+
+	for (int i = 0; i < count; ++i) {
+		const PhysicsObject & obj = *objects[i];
+		SnapshotBody body;
+		std::memset(static_cast<void *>(&body), 0, sizeof(body));	// padding too, so equal states give equal bytes
+		body.slot = obj.handle.slot;
+		body.generation = obj.handle.generation;
+		body.motion = obj.motion;
+		body.mass = obj.mass;
+		body.damping = obj.damping;
+		body.restitution = obj.restitution;
+		body.category = obj.category;
+		body.mask = obj.mask;
+		body.sensor = obj.sensor ? 1 : 0;
+		body.bullet = obj.bullet ? 1 : 0;
+		body.stepFrom = obj.stepFrom;
+		body.stepTo = obj.stepTo;
+		body.shape = obj.shape;
+		writeRecord(out, body);
+	}
+
+	ArrayWriter writer = { out };
+	BodyStore::forEachArray(bodies, writer);
+	out = writer.out;
+
+	for (size_t c = 0; c < contacts.size(); ++c) {
+		SnapshotContact contact = { (Uint32)contacts[c].a->engineIndex, (Uint32)contacts[c].b->engineIndex, contacts[c].time };
+		writeRecord(out, contact);
+	}
+
+	for (size_t e = 0; e < events.size(); ++e) {
+		SnapshotEvent event = { (Uint32)events[e].type, (Uint32)events[e].a->engineIndex, (Uint32)events[e].b->engineIndex };
+		writeRecord(out, event);
+	}
+}
+
+void PhysicsEngine::restoreSnapshot(const PhysicsSnapshot & snapshot) {
+	const std::vector<Uint8> & buffer = snapshot.buffer;
+	const int count = (int)objects.size();
+
+	SnapshotHeader header;
+	if (buffer.size() < sizeof(header))
+		throw EngineException("Invalid physics snapshot:", "too short");
+
+	const Uint8 * in = buffer.data();
+	readRecord(in, header);
+	if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+		throw EngineException("Invalid physics snapshot:", "unknown format");
+	if (header.fixedPoint != SNAPSHOT_FIXED_POINT)
+		throw EngineException("Invalid physics snapshot:", "saved by a build with the other XCUBE_FIXED_POINT setting");
+	if (header.bodyCount != (Uint32)count || header.activeCount > header.bodyCount)
+		throw EngineException("Physics snapshot does not match the registered bodies:", std::to_string(header.bodyCount) + " saved, " + std::to_string(count) + " registered");
+
+	ArraySizer sizer = { 0 };
+	BodyStore::forEachArray(bodies, sizer);
+	size_t size = sizeof(SnapshotHeader) + count * sizeof(SnapshotBody) + sizer.bytes
+		+ header.contactCount * sizeof(SnapshotContact) + header.eventCount * sizeof(SnapshotEvent);
+	if (buffer.size() != size)
+		throw EngineException("Invalid physics snapshot:", "wrong size");
+
+	// the store's shape bytes pick the pair tests, they have to agree with the saved shapes
+	ArrayOffset shapes = { &bodies.shape, 0, false };
+	BodyStore::forEachArray(bodies, shapes);
+	const Uint8 * shapeBytes = in + count * sizeof(SnapshotBody) + shapes.bytes;
+
+	// every saved body has to be registered still and hold values the engine can use, nothing is changed before that is known
+	const Uint8 * bodyRecords = in;
+	restoreSeen.assign(count, 0);
+	for (int k = 0; k < count; ++k) {
+		SnapshotBody body;
+		readRecord(in, body);
+		if (!isValid(BodyHandle(body.slot, body.generation)) || restoreSeen[slotObject[body.slot]])
+			throw EngineException("Physics snapshot does not match the registered bodies:", "body " + std::to_string(k));
+		restoreSeen[slotObject[body.slot]] = 1;
+
+		const int motion = (int)body.motion;
+		const int shape = (int)body.shape.type;
+		if (motion < MOTION_KINEMATIC || motion > MOTION_STATIC || shape < 0 || shape >= SHAPE_TYPE_COUNT
+			|| body.shape.vertexCount < 0 || body.shape.vertexCount > MAX_POLYGON_VERTICES
+			|| (shape == SHAPE_POLYGON && body.shape.vertexCount < 3) || shapeBytes[k] != shape)
+			throw EngineException("Invalid physics snapshot:", "body " + std::to_string(k));
+	}
+
+	const Uint8 * pairRecords = in + sizer.bytes;
+	for (Uint32 c = 0; c < header.contactCount; ++c) {
+		SnapshotContact contact;
+		readRecord(pairRecords, contact);
+		if (contact.a >= (Uint32)count || contact.b >= (Uint32)count)
+			throw EngineException("Invalid physics snapshot:", "contact out of range");
+	}
+	for (Uint32 e = 0; e < header.eventCount; ++e) {
+		SnapshotEvent event;
+		readRecord(pairRecords, event);
+		if (event.a >= (Uint32)count || event.b >= (Uint32)count || event.type > CONTACT_EXIT)
+			throw EngineException("Invalid physics snapshot:", "event out of range");
+	}
+
+	// objects into the saved order, the store is overwritten below
+	in = bodyRecords;
+	for (int k = 0; k < count; ++k) {
+		SnapshotBody body;
+		readRecord(in, body);
+
+		int from = slotObject[body.slot];
+		if (from != k)
+			swapObjects(k, from);
+
+		PhysicsObject & obj = *objects[k];
+		obj.motion = body.motion;
+		obj.mass = body.mass;
+		obj.damping = body.damping;
+		obj.restitution = body.restitution;
+		obj.category = body.category;
+		obj.mask = body.mask;
+		obj.sensor = body.sensor != 0;
+		obj.bullet = body.bullet != 0;
+		obj.stepFrom = body.stepFrom;
+		obj.stepTo = body.stepTo;
+		obj.shape = body.shape;
+	}
+
+	ArrayReader reader = { in, (size_t)count };
+	BodyStore::forEachArray(bodies, reader);
+	in = reader.in;
+
+	activeCount = (int)header.activeCount;
+	staticMoved = header.staticMoved != 0;
+
+	contacts.clear();
+	for (Uint32 c = 0; c < header.contactCount; ++c) {
+		SnapshotContact contact;
+		readRecord(in, contact);
+		contacts.push_back(ContactPair(objects[contact.a].get(), objects[contact.b].get(), contact.time));
+	}
+
+	events.clear();
+	for (Uint32 e = 0; e < header.eventCount; ++e) {
+		SnapshotEvent event;
+		readRecord(in, event);
+		events.push_back(ContactEvent((ContactEventType)event.type, ContactPair(objects[event.a].get(), objects[event.b].get())));
+	}
+
+	// everything derived from the bodies is built again from the restored state
+	activeGrid.dirty = staticGrid.dirty = true;
+	sapDirty = true;
+}
+
+void PhysicsEngine::carryStillContacts() {
+	for (size_t i = 0; i < previousContacts.size(); ++i) {
+		const ContactPair & pair = previousContacts[i];
+		if (isStill(pair.a->engineIndex) && isStill(pair.b->engineIndex))
+			contacts.push_back(pair);
+	}
+}
+
+void PhysicsEngine::wakeTouched() {
+	for (size_t c = 0; c < contacts.size(); ++c) {
+		// indices are read again for every contact, waking a body moves it
+		int i = contacts[c].a->engineIndex;
+		int j = contacts[c].b->engineIndex;
+
+		// an awake body or a placed static one wakes a sleeping body it runs into
+		if (bodies.moved[i] && (i < activeCount || bodies.staticBody[i]) && j >= activeCount && !bodies.staticBody[j])
+			wakeBody(j);
+		else if (bodies.moved[j] && (j < activeCount || bodies.staticBody[j]) && i >= activeCount && !bodies.staticBody[i])
+			wakeBody(i);
+	}
+}
+
+void PhysicsEngine::updateSleep() {
+	using std::abs;	// Fixed's abs() is found by argument lookup
+	const PhysicsReal restSpeed = SLEEP_SPEED;
+
+	// backwards, a body put to sleep is swapped with the last awake one which was already looked at
+	for (int i = activeCount - 1; i >= 0; --i) {
+		// kinematic bodies only sleep when they are not moving at all.
+		// per axis, a squared speed would overflow in fixed point
+		PhysicsReal threshold = bodies.invMass[i] > PhysicsReal(0) ? restSpeed : PhysicsReal(0);
+		if (abs(bodies.velX[i]) > threshold || abs(bodies.velY[i]) > threshold) {
+			bodies.sleepTime[i] = 0;
+			continue;
+		}
+
+		bodies.sleepTime[i] += timeStep;
+		if (bodies.sleepTime[i] >= PhysicsReal(SLEEP_DELAY)) {
+			// a resting body is nudged by its contacts every update, it keeps the contacts it has now while asleep
+			bodies.velX[i] = bodies.velY[i] = 0;
+			bodies.moved[i] = 0;
+			deactivate(i);
+		}
+	}
+}
+
+void PhysicsEngine::buildEvents() {
+	events.clear();
+
+	// both lists are sorted, a single merge finds new, kept and lost pairs
+	size_t c = 0, p = 0;
+	while (c < contacts.size() || p < previousContacts.size()) {
+		if (p == previousContacts.size() || (c < contacts.size() && pairLess(contacts[c], previousContacts[p]))) {
+			events.push_back(ContactEvent(CONTACT_ENTER, contacts[c++]));
+		}
+		else if (c == contacts.size() || pairLess(previousContacts[p], contacts[c])) {
+			events.push_back(ContactEvent(CONTACT_EXIT, previousContacts[p++]));
+		}
+		else {
+			if (reportStay)
+				events.push_back(ContactEvent(CONTACT_STAY, contacts[c]));
+			++c;
+			++p;
+		}
+	}
 }
 
 void PhysicsEngine::update() {
+	contacts.swap(previousContacts);
+	contacts.clear();
+	candidates.clear();
+	pairTests = 0;
+	std::fill(layerStats, layerStats + MAX_COLLISION_LAYERS, LayerStats());
+
+	integrate();
+
+	if (broadphase == BROADPHASE_SAP)
+		findPairsSAP();
+	else
+		findPairsGrid();
+	findStaticPairs();
+
+	narrowPhase();
+	carryStillContacts();
+	std::sort(contacts.begin(), contacts.end(), pairLess);
+	wakeTouched();
+
+	buildEvents();
+	countLayerStats();
 
+	std::fill(bodies.moved.begin(), bodies.moved.end(), 0);
+
+	// after the fill so pushed bodies count as moved next update
+	resolveContacts();
+
+	// a bullet's cached contacts came from its sweep, which is over now
+	endBulletSteps();
+
+	if (sleepEnabled)
+		updateSleep();
 }
 
-//sets the center point of the physics object
-void PhysicsObject::setCenter(const Point2& p)
-{
-	center = p;
+int PhysicsEngine::getContacts(const PhysicsObject * obj, std::vector<PhysicsObject *> & out) const {
+	int found = 0;
+	for (size_t i = 0; i < contacts.size(); ++i) {
+		PhysicsObject * other = contacts[i].getOther(obj);
+		if (nullptr != other) {
+			out.push_back(other);
+			++found;
+		}
+	}
+	return found;
 }
-//gets the center point of the physics object
-Point2 PhysicsObject::getCenter() const
-{
-	return center;
+
+bool PhysicsEngine::isInContact(const PhysicsObject * a, const PhysicsObject * b) const {
+	if (!a->isRegistered() || !b->isRegistered())
+		return false;
+
+	ContactPair key(const_cast<PhysicsObject *>(a), const_cast<PhysicsObject *>(b));
+	if (a->bodyId > b->bodyId)
+		std::swap(key.a, key.b);
+
+	std::vector<ContactPair>::const_iterator it = std::lower_bound(contacts.begin(), contacts.end(), key, pairLess);
+	return it != contacts.end() && it->a == key.a && it->b == key.b;
+}
+
+/* QUERIES */
+
+bool PhysicsEngine::findCell(const CellGrid & grid, const Uint64 & cell, size_t & begin, size_t & end) const {
+	const std::vector<CellEntry> & cellEntries = grid.entries;
+	std::vector<CellEntry>::const_iterator it = std::lower_bound(cellEntries.begin(), cellEntries.end(), cell,
+		[](const CellEntry & entry, const Uint64 & key) { return entry.cell < key; });
+	begin = it - cellEntries.begin();
+	end = begin;
+	while (end < cellEntries.size() && cellEntries[end].cell == cell)
+		++end;
+	return end > begin;
+}
+
+template <class ExactTest>
+int PhysicsEngine::queryArea(float minX, float minY, float maxX, float maxY, const ExactTest & test, PhysicsObject ** results, const int & maxResults) {
+	const int count = (int)objects.size();
+	int found = 0;
+	if (maxResults <= 0 || count == 0)
+		return 0;
+
+	buildDirtyGrids();
+
+	const float invCell = 1.0f / cellSize;
+	int cellMinX = (int)std::floor(minX * invCell), cellMinY = (int)std::floor(minY * invCell);
+	int cellMaxX = (int)std::floor(maxX * invCell), cellMaxY = (int)std::floor(maxY * invCell);
+	long cells = (long)(cellMaxX - cellMinX + 1) * (long)(cellMaxY - cellMinY + 1);
+
+	if (cells > MAX_QUERY_CELLS) {
+		// walking the cells would cost more than looking at every body once
+		batchHits.resize(count);
+		int hits = overlapAABBBatch(minX, minY, maxX, maxY, getBodyArrays(), 0, count, batchHits.data());
+		for (int h = 0; h < hits && found < maxResults; ++h)
+			if (test(batchHits[h]))
+				results[found++] = objects[batchHits[h]].get();
+		return found;
+	}
+
+	// awake bodies first, then static / asleep ones
+	const CellGrid * grids[2] = { &activeGrid, &staticGrid };
+	for (int g = 0; g < 2; ++g) {
+		const CellGrid & grid = *grids[g];
+
+		for (int y = cellMinY; y <= cellMaxY; ++y)
+			for (int x = cellMinX; x <= cellMaxX; ++x) {
+				size_t begin, end;
+				if (!findCell(grid, packCell(x, y), begin, end))
+					continue;
+
+				for (size_t e = begin; e < end; ++e) {
+					int i = grid.entries[e].object;
+					const CellRange & range = cellRanges[i];
+
+					// a body in several of the visited cells is only looked at in the first one
+					if (std::max(range.minX, cellMinX) != x || std::max(range.minY, cellMinY) != y)
+						continue;
+
+					if (test(i)) {
+						results[found++] = objects[i].get();
+						if (found == maxResults)
+							return found;
+					}
+				}
+			}
+
+		for (size_t k = 0; k < grid.oversized.size() && found < maxResults; ++k)
+			if (test(grid.oversized[k]))
+				results[found++] = objects[grid.oversized[k]].get();
+
+		if (found == maxResults)
+			break;
+	}
+
+	return found;
+}
+
+int PhysicsEngine::queryAABB(const Rectf & area, PhysicsObject ** results, const int & maxResults, const Uint32 & mask) {
+	float minX = area.x, minY = area.y, maxX = area.x + area.w, maxY = area.y + area.h;
+	const BodyStore & s = bodies;
+
+	const CollisionShape box;
+	const ShapePose pose(&box, PhysicsVector((minX + maxX) / 2.0f, (minY + maxY) / 2.0f), PhysicsVector(area.w / 2.0f, area.h / 2.0f));
+	return queryArea(minX, minY, maxX, maxY, [this, &s, &pose, minX, minY, maxX, maxY, mask](const int & i) {
+		if (!((s.category[i] & mask) && s.posX[i] - s.halfX[i] < maxX && minX < s.posX[i] + s.halfX[i]
+			&& s.posY[i] - s.halfY[i] < maxY && minY < s.posY[i] + s.halfY[i]))
+			return false;
+
+		// other shapes only filled their bounds so far
+		ShapeContact contact;
+		return s.shape[i] == SHAPE_BOX || overlapShapes(pose, getPose(i), contact);
+	}, results, maxResults);
+}
+
+int PhysicsEngine::queryCircle(const Point2 & center, const float & radius, PhysicsObject ** results, const int & maxResults, const Uint32 & mask) {
+	float cx = (float)center.x, cy = (float)center.y, r = radius;
+	const BodyStore & s = bodies;
+
+	CollisionShape circle;
+	circle.type = SHAPE_CIRCLE;
+	circle.radius = r;
+	const ShapePose pose(&circle, PhysicsVector(cx, cy), PhysicsVector());
+	return queryArea(cx - r, cy - r, cx + r, cy + r, [this, &s, &pose, cx, cy, r, mask](const int & i) {
+		if (!(s.category[i] & mask))
+			return false;
+
+		ShapeContact contact;
+		if (s.shape[i] != SHAPE_BOX)
+			return r > 0.0f && overlapShapes(pose, getPose(i), contact);
+
+		// closest point of the box to the circle's center, in float as squared distances overflow fixed point
+		float px = std::max((float)(s.posX[i] - s.halfX[i]), std::min(cx, (float)(s.posX[i] + s.halfX[i])));
+		float py = std::max((float)(s.posY[i] - s.halfY[i]), std::min(cy, (float)(s.posY[i] + s.halfY[i])));
+		return (px - cx) * (px - cx) + (py - cy) * (py - cy) < r * r;
+	}, results, maxResults);
+}
+
+int PhysicsEngine::queryPoint(const Point2 & point, PhysicsObject ** results, const int & maxResults, const Uint32 & mask) {
+	float px = (float)point.x, py = (float)point.y;
+	const BodyStore & s = bodies;
+
+	// a point is a circle without radius
+	CollisionShape dot;
+	dot.type = SHAPE_CIRCLE;
+	const ShapePose pose(&dot, PhysicsVector(px, py), PhysicsVector());
+	return queryArea(px, py, px, py, [this, &s, &pose, px, py, mask](const int & i) {
+		if (!((s.category[i] & mask) && s.posX[i] - s.halfX[i] < px && px < s.posX[i] + s.halfX[i]
+			&& s.posY[i] - s.halfY[i] < py && py < s.posY[i] + s.halfY[i]))
+			return false;
+
+		ShapeContact contact;
+		return s.shape[i] == SHAPE_BOX || overlapShapes(pose, getPose(i), contact);
+	}, results, maxResults);
+}
+
+void PhysicsEngine::testRay(const int & i, const RayQuery & ray, RaycastHit & hit) const {
+	const PhysicsObject * obj = objects[i].get();
+	if (obj == ray.ignore || obj == ray.ignore2 || !(bodies.category[i] & ray.mask))
+		return;
+
+	// a ray is a sweep of an empty box
+	float time;
+	Vector2f normal(0.0f, 0.0f);
+	Vector2f motion((float)(ray.to.x - ray.from.x), (float)(ray.to.y - ray.from.y));
+	if (!sweepAABB((float)ray.from.x, (float)ray.from.y, (float)ray.from.x, (float)ray.from.y, motion,
+		(float)(bodies.posX[i] - bodies.halfX[i]), (float)(bodies.posY[i] - bodies.halfY[i]),
+		(float)(bodies.posX[i] + bodies.halfX[i]), (float)(bodies.posY[i] + bodies.halfY[i]), time, normal))
+		return;
+
+	if (nullptr == hit.object || time < hit.time) {
+		hit.object = objects[i].get();
+		hit.time = time;
+		hit.normal = normal;
+	}
+}
+
+void PhysicsEngine::raycastGrid(const RayQuery & ray, RaycastHit & hit) const {
+	hit = RaycastHit();
+
+	for (size_t k = 0; k < activeGrid.oversized.size(); ++k)
+		testRay(activeGrid.oversized[k], ray, hit);
+	for (size_t k = 0; k < staticGrid.oversized.size(); ++k)
+		testRay(staticGrid.oversized[k], ray, hit);
+
+	// grid traversal (Amanatides & Woo), cells are visited in the order the ray enters them
+	const float size = (float)cellSize;
+	float x0 = (float)ray.from.x, y0 = (float)ray.from.y;
+	float dx = (float)(ray.to.x - ray.from.x), dy = (float)(ray.to.y - ray.from.y);
+
+	int cellX = (int)std::floor(x0 / size), cellY = (int)std::floor(y0 / size);
+	int endX = (int)std::floor(ray.to.x / size), endY = (int)std::floor(ray.to.y / size);
+	int stepX = dx > 0.0f ? 1 : -1, stepY = dy > 0.0f ? 1 : -1;
+
+	const float never = 2.0f;	// past the end of the ray
+	float tMaxX = dx != 0.0f ? ((cellX + (dx > 0.0f ? 1 : 0)) * size - x0) / dx : never;
+	float tMaxY = dy != 0.0f ? ((cellY + (dy > 0.0f ? 1 : 0)) * size - y0) / dy : never;
+	float tDeltaX = dx != 0.0f ? size / std::fabs(dx) : never;
+	float tDeltaY = dy != 0.0f ? size / std::fabs(dy) : never;
+
+	int steps = std::abs(endX - cellX) + std::abs(endY - cellY);
+	for (int s = 0; s <= steps; ++s) {
+		size_t begin, end;
+		Uint64 cell = packCell(cellX, cellY);
+		if (findCell(activeGrid, cell, begin, end))
+			for (size_t e = begin; e < end; ++e)
+				testRay(activeGrid.entries[e].object, ray, hit);
+		if (findCell(staticGrid, cell, begin, end))
+			for (size_t e = begin; e < end; ++e)
+				testRay(staticGrid.entries[e].object, ray, hit);
+
+		// anything in later cells is entered after this cell is left
+		float leave = std::min(tMaxX, tMaxY);
+		if (nullptr != hit.object && hit.time <= leave)
+			break;
+
+		if (tMaxX < tMaxY) {
+			cellX += stepX;
+			tMaxX += tDeltaX;
+		}
+		else {
+			cellY += stepY;
+			tMaxY += tDeltaY;
+		}
+	}
+
+	if (nullptr != hit.object)
+		hit.point = Point2((int)(x0 + dx * hit.time), (int)(y0 + dy * hit.time));
+}
+
+bool PhysicsEngine::raycast(const Point2 & from, const Point2 & to, RaycastHit & hit, const PhysicsObject * ignore, const Uint32 & mask) {
+	buildDirtyGrids();
+
+	raycastGrid(RayQuery(from, to, ignore, nullptr, mask), hit);
+	return nullptr != hit.object;
+}
+
+int PhysicsEngine::raycastBatch(const RayQuery * rays, const int & count, RaycastHit * hits) {
+	buildDirtyGrids();
+
+	// the grids are built once for the whole batch
+	int hitCount = 0;
+	for (int i = 0; i < count; ++i) {
+		raycastGrid(rays[i], hits[i]);
+		if (nullptr != hits[i].object)
+			++hitCount;
+	}
+	return hitCount;
 }
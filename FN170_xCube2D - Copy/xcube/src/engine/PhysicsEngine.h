@@ -4,12 +4,169 @@
 #include <vector>
 #include <memory>
 
+#include "EngineCommon.h"
 #include "GameMath.h"
+#include "AABBBatch.h"
+#include "JobSystem.h"
+#include "CollisionShapes.h"
+#include "PixelMask.h"
 
 static const float DEFAULT_GRAVITY = -1.0f;
 
+static const float DEFAULT_TIME_STEP = 1.0f / 60.0f;	// seconds simulated by one update()
+static const int DEFAULT_SUBSTEPS = 4;
+
+static const int DEFAULT_CELL_SIZE = 64;	// broadphase grid cell in pixels, about the size of a typical body
+static const int MAX_CELLS_PER_OBJECT = 64;	// larger bodies skip the grid and are tested against everything
+static const int MAX_QUERY_CELLS = 256;		// larger area queries scan all bodies in SIMD batches instead of cells
+
+static const int NARROW_PHASE_CHUNK = 256;	// candidate pairs per narrow phase job
+
+static const float SLEEP_SPEED = 2.0f;	// pixels per second, dynamic bodies slower than this may fall asleep
+static const float SLEEP_DELAY = 0.5f;	// seconds a body has to stay at rest before it sleeps
+
+static const Uint32 COLLIDE_ALL = 0xFFFFFFFF;	// default category and mask, every body meets every other
+static const int MAX_COLLISION_LAYERS = 32;		// one per category bit
+
 class PhysicsObject;
 
+enum BroadphaseType {
+	BROADPHASE_GRID,	// uniform grid, rebuilt every update, good for many fast moving bodies
+	BROADPHASE_SAP		// sweep and prune on x, order kept between updates, good for mostly still scenes
+};
+
+enum MotionType {
+	MOTION_KINEMATIC,	// moves only by its velocity or when placed, pushes dynamic bodies but is never pushed
+	MOTION_DYNAMIC,		// integrated from forces, gravity and collisions
+	MOTION_STATIC		// never moves on its own, kept out of integration in the rarely rebuilt static grid
+};
+
+enum ContactEventType {
+	CONTACT_ENTER, CONTACT_STAY, CONTACT_EXIT
+};
+
+/**
+ * Refers to a registered body without owning it,
+ * stays safe to use after the body is unregistered (the generation no longer matches)
+ */
+struct BodyHandle {
+	Uint32 slot;
+	Uint32 generation;
+
+	BodyHandle() : slot(0xFFFFFFFF), generation(0) {}
+	BodyHandle(Uint32 slot, Uint32 generation) : slot(slot), generation(generation) {}
+
+	bool operator==(const BodyHandle & other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!=(const BodyHandle & other) const { return !(*this == other); }
+};
+
+/**
+ * Broadphase counters of one collision layer during the last PhysicsEngine::update(),
+ * bodies count under the lowest bit of their category
+ */
+struct LayerStats {
+	int bodies;		// registered bodies on the layer
+	int candidates;	// pairs involving the layer handed on by the broadphase
+	int filtered;	// of those, rejected by category / mask without a geometric test
+	int contacts;	// pairs involving the layer in contact after the update
+
+	LayerStats() : bodies(0), candidates(0), filtered(0), contacts(0) {}
+};
+
+/**
+ * Two registered objects touching after the last PhysicsEngine::update(): their collision shapes overlap,
+ * and their pixel masks too where either has one. A pair where neither body moved since the update before
+ * (e.g. both asleep) is carried over from it without being tested again.
+ * a is always the object registered first
+ */
+struct ContactPair {
+	PhysicsObject * a;
+	PhysicsObject * b;
+	float time;	// for bullets, fraction of the step's motion at first touch, 1 (end of step) otherwise
+
+	ContactPair(PhysicsObject * a, PhysicsObject * b, float time = 1.0f) : a(a), b(b), time(time) {}
+
+	/**
+	* @return the object in this pair that is not obj, or nullptr if obj is not part of it
+	*/
+	PhysicsObject * getOther(const PhysicsObject * obj) const {
+		return obj == a ? b : (obj == b ? a : nullptr);
+	}
+};
+
+/**
+ * Earliest contact of a bullet body along its motion during the last PhysicsEngine::update()
+ */
+struct SweepHit {
+	PhysicsObject * object;	// what was hit
+	float time;				// fraction of the motion, 0 is the start position
+	Vector2f position;		// bullet center at the time of impact
+	Vector2f normal;		// normal of the face that was hit, zero if already overlapping at the start
+
+	SweepHit() : object(nullptr), time(1.0f), position(0, 0), normal(0.0f, 0.0f) {}
+};
+
+/**
+ * Closest body along a ray, see PhysicsEngine::raycast()
+ */
+struct RaycastHit {
+	PhysicsObject * object;	// nullptr if nothing was hit
+	float time;				// fraction of the way from start to end
+	Point2 point;			// where the ray entered the body
+	Vector2f normal;		// normal of the face that was hit, zero if the ray starts inside
+
+	RaycastHit() : object(nullptr), time(1.0f), point(0, 0), normal(0.0f, 0.0f) {}
+};
+
+/**
+ * One ray of PhysicsEngine::raycastBatch(), e.g. a line of sight check between two bodies
+ */
+struct RayQuery {
+	Point2 from, to;
+	const PhysicsObject * ignore;	// typically the body the ray starts in, may be nullptr
+	const PhysicsObject * ignore2;	// typically the body the ray is aimed at, may be nullptr
+	Uint32 mask;					// only bodies with a category bit in mask can block the ray
+
+	RayQuery() : from(0, 0), to(0, 0), ignore(nullptr), ignore2(nullptr), mask(COLLIDE_ALL) {}
+	RayQuery(const Point2 & from, const Point2 & to, const PhysicsObject * ignore = nullptr, const PhysicsObject * ignore2 = nullptr, const Uint32 & mask = COLLIDE_ALL)
+		: from(from), to(to), ignore(ignore), ignore2(ignore2), mask(mask) {}
+};
+
+/**
+ * Change in a pair's contact state between two PhysicsEngine::update() calls
+ */
+struct ContactEvent {
+	ContactEventType type;
+	PhysicsObject * a;
+	PhysicsObject * b;
+
+	ContactEvent(ContactEventType type, const ContactPair & pair) : type(type), a(pair.a), b(pair.b) {}
+
+	PhysicsObject * getOther(const PhysicsObject * obj) const {
+		return obj == a ? b : (obj == b ? a : nullptr);
+	}
+};
+
+/**
+ * Complete simulation state of a PhysicsEngine in one flat buffer, see PhysicsEngine::saveSnapshot().
+ * The bodies' fields come one block after another, so two snapshots of the same bodies line up
+ * byte for byte and a delta between them is small where little changed.
+ * Saving into the same snapshot again reuses its buffer
+ */
+class PhysicsSnapshot {
+	friend class PhysicsEngine;
+	private:
+		std::vector<Uint8> buffer;
+	public:
+		const Uint8 * getData() const { return buffer.data(); }
+		size_t getSize() const { return buffer.size(); }
+
+		/**
+		* Takes bytes saved earlier, e.g. received over the network, they are checked on restore
+		*/
+		void assign(const Uint8 * data, const size_t & size) { buffer.assign(data, data + size); }
+};
+
 class PhysicsEngine {
 	friend class XCube2Engine;
 	friend class PhysicsObject;
@@ -18,6 +175,165 @@ class PhysicsEngine {
 		PhysicsEngine();
 
 		std::vector<std::shared_ptr<PhysicsObject>> objects;
+		Uint32 nextBodyId;
+
+		/**
+		* Registered bodies as a structure of arrays parallel to objects,
+		* while a body is registered its state lives here and PhysicsObject reads / writes through
+		*/
+		struct BodyStore {
+			std::vector<PhysicsReal> posX, posY;
+			std::vector<PhysicsReal> sweepX, sweepY;	// position at the start of the step, bullets only
+			std::vector<PhysicsReal> halfX, halfY;
+			std::vector<PhysicsReal> velX, velY;
+			std::vector<PhysicsReal> forceX, forceY;	// accumulated until the next update()
+			std::vector<PhysicsReal> invMass;			// 0 for kinematic bodies
+			std::vector<PhysicsReal> gravityScale;		// 0 for kinematic bodies
+			std::vector<PhysicsReal> damping, restitution;
+			std::vector<float> minX, minY, maxX, maxY;	// bounds, swept for bullets, rounded outwards in fixed point
+			std::vector<Uint8> moved;			// since the last update()
+			std::vector<Uint8> bullet, sensor;
+			std::vector<Uint32> category, mask;
+			std::vector<Uint8> layer;			// lowest category bit, for LayerStats
+			std::vector<Uint8> staticBody;
+			std::vector<PhysicsReal> sleepTime;	// seconds at rest
+			std::vector<Uint8> shape;			// ShapeType, halfX / halfY are the shape's bounds when it is not a box
+			std::vector<PhysicsReal> radius;	// circles and capsules, so circle pairs are tested without touching the object
+
+			void push(const PhysicsObject & obj);
+			void storeMaterial(const int & i, const PhysicsObject & obj);
+			void storeShape(const int & i, const PhysicsObject & obj);
+			void load(const int & i, PhysicsObject & obj) const;
+			void swap(const int & i, const int & j);
+			void swapRemove(const int & i);
+
+			/**
+			* Calls visit(array) for every array above, store may be const
+			*/
+			template <class Store, class Visitor>
+			static void forEachArray(Store & store, Visitor & visit);
+		} bodies;
+
+		// objects [0, activeCount) are awake, the rest are static or asleep.
+		// only awake bodies are integrated and go into the per update grid
+		int activeCount;
+		bool sleepEnabled;
+
+		PhysicsVector gravityAcceleration;	// pixels per second squared
+		PhysicsReal timeStep;
+		int substeps;
+
+		// handle slots, a slot's generation changes whenever its body is unregistered
+		std::vector<Uint32> slotGeneration;
+		std::vector<int> slotObject;		// index into objects, -1 when free
+		std::vector<Uint32> objectSlot;		// inverse of slotObject
+		std::vector<Uint32> freeSlots;
+
+		BroadphaseType broadphase;
+
+		// broadphase scratch, reused every update() so a steady scene does not allocate
+		struct CellEntry {
+			Uint64 cell;
+			int object;
+
+			bool operator<(const CellEntry & other) const {
+				return cell < other.cell || (cell == other.cell && object < other.object);
+			}
+		};
+
+		struct CellRange {
+			int minX, minY, maxX, maxY;
+			bool oversized;
+		};
+
+		struct CellGrid {
+			std::vector<CellEntry> entries;
+			std::vector<int> oversized;
+			bool dirty;		// bounds changed since the grid was built, queries rebuild before use
+
+			CellGrid() : dirty(true) {}
+		};
+
+		int cellSize;
+		CellGrid activeGrid;	// awake bodies, rebuilt every update something moved
+		CellGrid staticGrid;	// static and sleeping bodies, rebuilt only when that set changes
+		bool staticMoved;		// a static or sleeping body was placed since the last update
+		std::vector<CellRange> cellRanges;	// per body, from the grid holding it
+		std::vector<int> batchHits;
+
+		// broadphase output, tested by the narrow phase in order
+		struct CandidatePair {
+			int i, j;
+		};
+		std::vector<CandidatePair> candidates;
+
+		// circle pairs of one narrow phase chunk, gathered and tested together in SIMD batches
+		struct CircleBatch {
+			std::vector<CandidatePair> pairs;
+			std::vector<float> dx, dy, radiusSum;
+			std::vector<int> hits;
+
+			void clear() { pairs.clear(); dx.clear(); dy.clear(); radiusSum.clear(); }
+		};
+
+		std::unique_ptr<JobSystem> jobs;	// nullptr while single threaded
+		std::vector<std::vector<ContactPair>> chunkContacts;	// narrow phase output per chunk, merged in chunk order
+		std::vector<CircleBatch> chunkCircles;				// per chunk as well
+
+		std::vector<int> sapOrder;	// awake object indices sorted by minX, persistent
+		bool sapDirty;				// set of awake bodies changed, sapOrder is sorted from scratch
+		std::vector<float> sapMinX, sapMinY, sapMaxX, sapMaxY;	// bounds gathered in sapOrder
+
+		// both sorted by body id pair, contacts of the previous update are diffed into events
+		std::vector<ContactPair> contacts;
+		std::vector<ContactPair> previousContacts;
+		std::vector<ContactEvent> events;
+		bool reportStay;
+
+		int pairTests;
+		LayerStats layerStats[MAX_COLLISION_LAYERS];
+
+		std::vector<Uint8> restoreSeen;	// restoreSnapshot() scratch, per body
+
+		void syncBounds(const int & i);
+		// by value, callers pass a body's own engineIndex which the swap changes
+		void swapBodies(int i, int j);
+		void swapObjects(int i, int j);
+		int activate(int i);
+		int deactivate(int i);
+		void wakeBody(const int & i);
+		bool isStill(const int & i) const { return bodies.moved[i] == 0; }
+		Vector2f getPosition(const int & i) const { return Vector2f((float)bodies.posX[i], (float)bodies.posY[i]); }
+		ShapePose getPose(const int & i) const;
+		AABBArrays getBodyArrays() const;
+
+		void buildGrid(CellGrid & grid, const int & begin, const int & end);
+		void buildDirtyGrids();
+		bool findCell(const CellGrid & grid, const Uint64 & cell, size_t & begin, size_t & end) const;
+
+		template <class ExactTest>
+		int queryArea(float minX, float minY, float maxX, float maxY, const ExactTest & test, PhysicsObject ** results, const int & maxResults);
+		void raycastGrid(const RayQuery & ray, RaycastHit & hit) const;
+		void testRay(const int & i, const RayQuery & ray, RaycastHit & hit) const;
+
+		void findPairsGrid();
+		void findPairsSAP();
+		void findStaticPairs();
+		bool acceptPair(const int & i, const int & j);
+		void addCandidate(const int & i, const int & j);
+		void narrowPhase();
+		void narrowChunk(const int & begin, const int & end, std::vector<ContactPair> & out, CircleBatch & circles) const;
+		bool sweepShapes(const int & i, const int & j, const PhysicsVector & motion) const;
+		bool pixelsOverlap(const int & i, const int & j) const;
+		void addContact(const int & i, const int & j, const float & time, std::vector<ContactPair> & out) const;
+		void countLayerStats();
+		void integrate();
+		void resolveContacts();
+		void endBulletSteps();
+		void carryStillContacts();
+		void wakeTouched();
+		void updateSleep();
+		void buildEvents();
 
 	public:
 		/**
@@ -26,32 +342,342 @@ class PhysicsEngine {
 		*/
 
 		void setGravity(float gravityValue, float worldUpdateInterval);
+
+		~PhysicsEngine();
+
+		/**
+		* Gravity integrated into dynamic bodies every update(), in pixels per second squared,
+		* positive y is down the screen. Zero by default
+		*/
+		void setGravityAcceleration(const Vector2f & acceleration) { gravityAcceleration = PhysicsVector(acceleration); }
+		Vector2f getGravityAcceleration() const { return Vector2f(gravityAcceleration); }
+
+		/**
+		* Every update() advances the simulation by a fixed step, split into substeps
+		* so fast bodies and stiff damping stay stable
+		*
+		* @param seconds - simulated time per update(), normally the game's fixed frame time
+		*/
+		void setTimeStep(const float & seconds, const int & substeps);
+		float getTimeStep() const { return (float)timeStep; }
+		int getSubsteps() const { return substeps; }
+
+		/**
+		* Integrates velocities and positions (semi-implicit Euler, fixed substeps),
+		* then finds all overlapping pairs of registered objects
+		* using the selected broadphase, so the cost scales with the number of nearby objects.
+		* Pairs whose bodies both did not move keep last update's result without a test.
+		* Contact events are rebuilt by comparing against the previous update.
+		* Finally overlapping pairs with a dynamic body are pushed apart and bounced,
+		* which shows in the next update's contacts.
+		* Static and sleeping bodies are only tested against awake ones that moved
+		*/
 		void update();
 
 		void registerObject(std::shared_ptr<PhysicsObject>);
+
+		/**
+		* Removes the object and any contacts it is part of,
+		* no exit events are reported for those contacts
+		*/
+		void unregisterObject(std::shared_ptr<PhysicsObject>);
+
+		int getObjectCount() { return (int)objects.size(); }
+
+		/**
+		* @return bodies currently integrated and in the per update broadphase, i.e. neither static nor asleep
+		*/
+		int getAwakeCount() const { return activeCount; }
+
+		/**
+		* Bodies at rest for SLEEP_DELAY are put to sleep, they wake when moved,
+		* pushed or touched by a moving body. On by default
+		*/
+		void setSleepEnabled(bool enabled);
+
+		bool isValid(const BodyHandle & handle) const;
+
+		/**
+		* @return the registered object or nullptr if the handle is stale
+		*/
+		PhysicsObject * getObject(const BodyHandle & handle) const;
+
+		/**
+		* Grid cell size in pixels, best close to the size of the common bodies
+		*/
+		void setCellSize(const int & size);
+		int getCellSize() { return cellSize; }
+
+		void setBroadphase(BroadphaseType type) { broadphase = type; }
+		BroadphaseType getBroadphase() { return broadphase; }
+
+		/**
+		* Threads testing broadphase candidates, 1 (the default) keeps everything
+		* on the calling thread, 0 uses one per hardware thread.
+		* Contacts and events are bit identical whatever the count
+		*/
+		void setThreadCount(const int & count);
+		int getThreadCount() const { return jobs ? jobs->getThreadCount() : 1; }
+
+		/**
+		* @return pairs found by the last update(), valid until the next update()
+		*/
+		const std::vector<ContactPair> & getContacts() const { return contacts; }
+
+		/**
+		* Appends every object touching obj during the last update() to out
+		* @return number of objects appended
+		*/
+		int getContacts(const PhysicsObject * obj, std::vector<PhysicsObject *> & out) const;
+
+		/**
+		* Finds the earliest thing a bullet body touched while moving during the last update()
+		* @return false if it hit nothing or is not a registered bullet
+		*/
+		bool getFirstHit(const PhysicsObject * bullet, SweepHit & hit) const;
+
+		/**
+		* Area queries, candidates come from the broadphase grid and are tested
+		* against each body's current shape. Results are written to the caller's buffer,
+		* nothing is allocated once the grid scratch has grown
+		*
+		* @param results - receives up to maxResults objects, each at most once
+		* @param mask - only bodies with a category bit in mask are reported
+		* @return number of objects written
+		*/
+		int queryAABB(const Rectf & area, PhysicsObject ** results, const int & maxResults, const Uint32 & mask = COLLIDE_ALL);
+		int queryCircle(const Point2 & center, const float & radius, PhysicsObject ** results, const int & maxResults, const Uint32 & mask = COLLIDE_ALL);
+		int queryPoint(const Point2 & point, PhysicsObject ** results, const int & maxResults, const Uint32 & mask = COLLIDE_ALL);
+
+		/**
+		* Walks the grid cells along the segment and stops at the closest hit,
+		* bodies are hit at their bounding box whatever their shape
+		* @param mask - bodies without a category bit in mask are passed through
+		* @return true if a body other than ignore is hit between from and to
+		*/
+		bool raycast(const Point2 & from, const Point2 & to, RaycastHit & hit, const PhysicsObject * ignore = nullptr, const Uint32 & mask = COLLIDE_ALL);
+
+		/**
+		* Casts count independent rays against the same grid, hits[i] answers rays[i]
+		* (object is nullptr on a miss), meant for many line of sight checks per frame
+		* @return number of rays that hit something
+		*/
+		int raycastBatch(const RayQuery * rays, const int & count, RaycastHit * hits);
+
+		/**
+		* Time of impact of box a moving by motion against a still box b, touching edges do not count
+		*
+		* @param time - set to the fraction of motion at first overlap, 0 if already overlapping
+		* @param normal - set to the normal of b's face that was hit, zero if already overlapping
+		* @return true if they overlap anywhere along the motion
+		*/
+		static bool sweepAABB(float aMinX, float aMinY, float aMaxX, float aMaxY, const Vector2f & motion,
+			float bMinX, float bMinY, float bMaxX, float bMaxY, float & time, Vector2f & normal);
+
+		bool isInContact(const PhysicsObject * a, const PhysicsObject * b) const;
+
+		/**
+		* @return enter / exit (and stay if enabled) events of the last update(),
+		* sorted by body ids, valid until the next update()
+		*/
+		const std::vector<ContactEvent> & getContactEvents() const { return events; }
+
+		/**
+		* Stay events repeat every contact every update, off by default
+		*/
+		void setReportStayEvents(bool report) { reportStay = report; }
+
+		/**
+		* @return narrow phase tests done by the last update(), i.e. broadphase candidates
+		* that passed the layer filter
+		*/
+		int getPairTestCount() { return pairTests; }
+
+		/**
+		* @param layer - category bit index, 0 to MAX_COLLISION_LAYERS - 1
+		* @return counters of the last update()
+		*/
+		const LayerStats & getLayerStats(const int & layer) const;
+
+		/**
+		* Hash of every registered body's exact position, velocity and sleep state and of the current contacts.
+		* Equal on two runs given the same inputs, with XCUBE_FIXED_POINT also across builds and platforms,
+		* so comparing it per update finds the first update where a replay went different
+		*/
+		Uint64 getStateChecksum() const;
+
+		/**
+		* Saves every registered body's state and settings, which bodies are asleep
+		* and the contacts and events of the last update() into snapshot.
+		* Allocates only while the snapshot's buffer grows
+		*/
+		void saveSnapshot(PhysicsSnapshot & snapshot) const;
+
+		/**
+		* Puts the simulation back to a saved state, to re-simulate from an earlier update (rollback)
+		* or restart a level. Updates after the restore repeat exactly what followed the save.
+		* The same bodies have to be registered as at the save, in any order.
+		* Engine settings (gravity, time step, broadphase, threads), user data, pixel masks and the
+		* last update()'s statistics are not part of a snapshot
+		*
+		* @throws EngineException if the snapshot is damaged (including a body with an unknown motion type or shape),
+		* comes from a build with the other PhysicsReal or the registered bodies are not the saved ones.
+		* Nothing is changed when it throws
+		*/
+		void restoreSnapshot(const PhysicsSnapshot & snapshot);
 };
 
 class PhysicsObject {
 	friend class PhysicsEngine;
 	protected:
 		float lX, lY, hlX, hlY;	// lengths and half lengths
+		CollisionShape shape;	// the box above unless set otherwise
+		std::shared_ptr<const PixelMask> pixelMask;	// nullptr unless set, refines contacts of the shape
 
-		Point2 center;
-		Vector2f force;
+		// body state while not registered, the engine's BodyStore holds it otherwise
+		PhysicsVector position;
+		PhysicsVector velocity;
+		PhysicsVector force;
 
-		void applyForce(const Vector2f &);
+		MotionType motion;
+		float mass;
+		float damping;		// fraction of velocity lost per second, roughly
+		float restitution;	// 0 stops dead on impact, 1 bounces back at full speed
+		bool sensor;
+
+		Uint32 category;	// layers this body is on
+		Uint32 mask;		// layers this body collides with
+
+		PhysicsEngine * owner;	// engine this object is registered with, nullptr if none
+		int engineIndex;	// position in PhysicsEngine::objects, -1 when not registered
+		BodyHandle handle;
+		Uint32 bodyId;		// unique per registration, orders contact pairs
+
+		bool bullet;
+		Vector2f stepFrom, stepTo;	// motion of the last completed step, bullets only
+
+		void * userData;
+		int userType;
+
+		void syncMaterial();
+		Vector2f getBoundsHalf() const;
+		ShapePose getPose() const;
 	public:
 		PhysicsObject(const Point2 & center, float x, float y);
+
+		/**
+		* Position is kept in float so slow bodies accumulate sub pixel motion,
+		* the center is the position rounded to whole pixels
+		*/
 		void setCenter(const Point2& p);
 		Point2 getCenter() const;
+		void setPosition(const Vector2f & p);
+		Vector2f getPosition() const;
+
+		/**
+		* In pixels per second
+		*/
+		void setVelocity(const Vector2f & v);
+		Vector2f getVelocity() const;
+
+		/**
+		* Forces add up until the next PhysicsEngine::update(), which applies and clears them.
+		* Kinematic bodies ignore forces and impulses
+		*/
+		void applyForce(const Vector2f &);
+		void applyImpulse(const Vector2f &);
+
+		/**
+		* Bodies are kinematic by default, i.e. they stay where the game puts them.
+		* Static bodies are for things that do not move, e.g. pickups and walls,
+		* they are never integrated and never tested against each other
+		*/
+		void setMotionType(MotionType type);
+		MotionType getMotionType() const { return motion; }
+
+		/**
+		* Placing, pushing or applying a force also wakes a body
+		*/
+		void wake();
+		bool isAwake() const;
+
+		/**
+		* @param mass - must be positive
+		*/
+		void setMass(const float & mass);
+		float getMass() const { return mass; }
+		void setDamping(const float & damping);
+		float getDamping() const { return damping; }
+		void setRestitution(const float & restitution);
+		float getRestitution() const { return restitution; }
+
+		/**
+		* Sensors report contacts but are never pushed and never push anything
+		*/
+		void setSensor(bool isSensor);
+		bool isSensor() const { return sensor; }
+
+		/**
+		* Two bodies only collide if each one's category shares a bit with the other's mask,
+		* other pairs are dropped by the broadphase before any geometric test.
+		* Bodies start on every layer colliding with everything (COLLIDE_ALL)
+		*/
+		void setCollisionFilter(const Uint32 & category, const Uint32 & mask);
+		Uint32 getCategory() const { return category; }
+		Uint32 getMask() const { return mask; }
+
+		/**
+		* Collision shape centered on the position, the box of the given lengths by default.
+		* Contacts, pushes and area queries use the shape, the broadphase and raycasts its bounding box.
+		* Circle pairs are tested in SIMD batches, other shapes through a table of pair tests
+		*
+		* @param shape - e.g. CollisionShape::circle(24), a default constructed shape goes back to the box
+		*/
+		void setShape(const CollisionShape & shape);
+		const CollisionShape & getShape() const { return shape; }
+		ShapeType getShapeType() const { return shape.type; }
+
+		/**
+		* Pixel exact contacts, e.g. with ResourceManager::getPixelMask() of the body's sprite.
+		* The mask is centered on the position, one mask pixel per world pixel and not rotated.
+		* Pairs whose shapes overlap are only in contact if the masks share a solid pixel,
+		* or against a body without a mask, if a solid pixel is inside that body's bounding box.
+		* Bullets, pushes and queries keep using the shape alone
+		*
+		* @param mask - nullptr goes back to the shape alone
+		*/
+		void setPixelMask(const std::shared_ptr<const PixelMask> & mask);
+		const std::shared_ptr<const PixelMask> & getPixelMask() const { return pixelMask; }
 
-		Point2 getCenter() { return center; }
 		float getLengthX() { return lX; }
 		float getLengthY() { return lY; }
 		float getHalfLengthX() { return hlX; }
 		float getHalfLengthY() { return hlY; }
 
+		bool isRegistered() const { return engineIndex >= 0; }
+		Uint32 getBodyId() const { return bodyId; }
+		BodyHandle getHandle() const { return handle; }
+
+		/**
+		* Bullets are tested along their whole motion between two engine updates (swept AABB)
+		* instead of only at their end position, so fast or thin bodies do not tunnel.
+		* With other shapes the path is then checked as a capsule, exact for circles
+		* and rounded to the bounding circle for boxes and polygons
+		*/
+		void setBullet(bool isBullet);
+		bool isBullet() const { return bullet; }
 
+		/**
+		* Lets the game map contacts back to its own entities,
+		* type is a game defined tag to tell apart different kinds of owners
+		*/
+		void setUserData(void * data, int type = 0) { userData = data; userType = type; }
+		void * getUserData() const { return userData; }
+		int getUserType() const { return userType; }
+
+		/**
+		* Shape overlap refined by the pixel masks, touching edges do not count
+		*/
 		bool isColliding(const PhysicsObject& other);
 
 		/**
@@ -62,4 +688,4 @@ class PhysicsObject {
 		virtual void applyAntiGravity(const PhysicsEngine & engine);
 };
 
-#endif
\ No newline at end of file
+#endif
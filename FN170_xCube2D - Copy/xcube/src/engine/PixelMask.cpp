@@ -0,0 +1,262 @@
+#include "PixelMask.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define XCUBE_MASK_SSE2
+#endif
+
+PixelMask::PixelMask(const int & w, const int & h) : width(w), height(h), setMinX(0), setMinY(0), setMaxX(0), setMaxY(0) {
+	if (w <= 0 || h <= 0)
+		throw EngineException("Invalid pixel mask size:", std::to_string(w) + "x" + std::to_string(h));
+
+	wordsPerRow = (w + 63) / 64;
+	stride = wordsPerRow + 2;
+	words.assign((size_t)stride * h, 0);
+}
+
+bool PixelMask::get(const int & x, const int & y) const {
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return false;
+	return (getRow(y)[x >> 6] >> (x & 63)) & 1;
+}
+
+void PixelMask::set(const int & x, const int & y, bool solid) {
+	if (x < 0 || y < 0 || x >= width || y >= height)
+		return;
+
+	Uint64 & word = words[y * stride + 1 + (x >> 6)];
+	Uint64 bit = (Uint64)1 << (x & 63);
+	if (!solid) {
+		// the set bounds may now be larger than needed, which tests only pay for in time
+		word &= ~bit;
+		return;
+	}
+
+	word |= bit;
+	if (setMinX >= setMaxX) {
+		setMinX = x; setMinY = y;
+		setMaxX = x + 1; setMaxY = y + 1;
+	}
+	else {
+		setMinX = std::min(setMinX, x); setMinY = std::min(setMinY, y);
+		setMaxX = std::max(setMaxX, x + 1); setMaxY = std::max(setMaxY, y + 1);
+	}
+}
+
+int PixelMask::countSet() const {
+	int count = 0;
+	for (size_t w = 0; w < words.size(); ++w)
+		for (Uint64 bits = words[w]; bits != 0; bits &= bits - 1)
+			++count;
+	return count;
+}
+
+void PixelMask::updateSetBounds() {
+	setMinX = width; setMinY = height;
+	setMaxX = setMaxY = 0;
+	for (int y = 0; y < height; ++y) {
+		const Uint64 * row = getRow(y);
+		for (int k = 0; k < wordsPerRow; ++k) {
+			if (row[k] == 0)
+				continue;
+
+			int low = 0, high = 63;
+			while (!((row[k] >> low) & 1)) ++low;
+			while (!((row[k] >> high) & 1)) --high;
+			setMinX = std::min(setMinX, k * 64 + low);
+			setMaxX = std::max(setMaxX, k * 64 + high + 1);
+			setMinY = std::min(setMinY, y);
+			setMaxY = y + 1;
+		}
+	}
+
+	if (setMaxX == 0)
+		setMinX = setMinY = 0;
+}
+
+// raw value of one pixel whatever the surface's bytes per pixel
+static Uint32 readPixel(const SDL_Surface * surface, const int & x, const int & y) {
+	const Uint8 * p = (const Uint8 *)surface->pixels + y * surface->pitch + x * surface->format->BytesPerPixel;
+	switch (surface->format->BytesPerPixel) {
+		case 1: return *p;
+		case 2: return *(const Uint16 *)p;
+		case 3:
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			return (p[0] << 16) | (p[1] << 8) | p[2];
+#else
+			return p[0] | (p[1] << 8) | (p[2] << 16);
+#endif
+		default: return *(const Uint32 *)p;
+	}
+}
+
+std::shared_ptr<PixelMask> PixelMask::fromSurface(SDL_Surface * surface, const Uint8 & alphaThreshold) {
+	if (nullptr == surface)
+		throw EngineException("Cannot build pixel mask:", "no surface");
+
+	std::shared_ptr<PixelMask> mask = std::make_shared<PixelMask>(surface->w, surface->h);
+
+	Uint32 key = 0;
+	bool keyed = SDL_GetColorKey(surface, &key) == 0;
+
+	if (SDL_LockSurface(surface) != 0)
+		throw EngineException(SDL_GetError(), "pixel mask");
+
+	// bits are packed straight into the words, set() would update the bounds every pixel
+	for (int y = 0; y < surface->h; ++y) {
+		Uint64 * row = mask->words.data() + y * mask->stride + 1;
+		for (int x = 0; x < surface->w; ++x) {
+			Uint32 pixel = readPixel(surface, x, y);
+			Uint8 r, g, b, a;
+			SDL_GetRGBA(pixel, surface->format, &r, &g, &b, &a);
+			if (a >= alphaThreshold && !(keyed && pixel == key))
+				row[x >> 6] |= (Uint64)1 << (x & 63);
+		}
+	}
+
+	SDL_UnlockSurface(surface);
+	mask->updateSetBounds();
+	return mask;
+}
+
+std::shared_ptr<PixelMask> PixelMask::scaled(const int & newWidth, const int & newHeight) const {
+	std::shared_ptr<PixelMask> mask = std::make_shared<PixelMask>(newWidth, newHeight);
+	for (int y = 0; y < newHeight; ++y) {
+		const Uint64 * source = getRow((int)((Sint64)y * height / newHeight));
+		Uint64 * row = mask->words.data() + y * mask->stride + 1;
+		for (int x = 0; x < newWidth; ++x) {
+			int sx = (int)((Sint64)x * width / newWidth);
+			if ((source[sx >> 6] >> (sx & 63)) & 1)
+				row[x >> 6] |= (Uint64)1 << (x & 63);
+		}
+	}
+
+	mask->updateSetBounds();
+	return mask;
+}
+
+/* OVERLAP TESTS */
+
+// rows and words of a where both masks' solid pixels can meet, false if nowhere
+struct MaskOverlap {
+	int minY, maxY;			// rows of a, max exclusive
+	int firstWord, lastWord;	// words of a's rows, inclusive
+	int word, shift;		// 64 pixels of b under a's firstWord start at b's bit word * 64 + shift
+};
+
+static bool findOverlap(const PixelMask & a, const PixelMask & b, const int & dx, const int & dy, MaskOverlap & area) {
+	SDL_Rect boundsA = a.getSetBounds(), boundsB = b.getSetBounds();
+	int minX = std::max(boundsA.x, boundsB.x + dx), maxX = std::min(boundsA.x + boundsA.w, boundsB.x + boundsB.w + dx);
+	area.minY = std::max(boundsA.y, boundsB.y + dy);
+	area.maxY = std::min(boundsA.y + boundsA.h, boundsB.y + boundsB.h + dy);
+	if (minX >= maxX || area.minY >= area.maxY)
+		return false;
+
+	area.firstWord = minX >> 6;
+	area.lastWord = (maxX - 1) >> 6;
+
+	// minX is at least dx, so this is above -64 and the read starts at most one word before b's row,
+	// on its zero guard word. the bit index is shifted up to keep the division on positive numbers
+	int bit = area.firstWord * 64 - dx + 64;
+	area.word = (bit >> 6) - 1;
+	area.shift = bit & 63;
+	return true;
+}
+
+// 64 pixels of b's row lined up with one word of a
+static inline Uint64 alignedWord(const Uint64 * row, const int & word, const int & shift) {
+	return shift == 0 ? row[word] : (row[word] >> shift) | (row[word + 1] << (64 - shift));
+}
+
+bool overlapPixelMasksScalar(const PixelMask & a, const PixelMask & b, const int & dx, const int & dy) {
+	MaskOverlap area;
+	if (!findOverlap(a, b, dx, dy, area))
+		return false;
+
+	for (int y = area.minY; y < area.maxY; ++y) {
+		const Uint64 * rowA = a.getRow(y);
+		const Uint64 * rowB = b.getRow(y - dy);
+		for (int k = area.firstWord, w = area.word; k <= area.lastWord; ++k, ++w)
+			if (rowA[k] & alignedWord(rowB, w, area.shift))
+				return true;
+	}
+
+	return false;
+}
+
+bool overlapPixelMasks(const PixelMask & a, const PixelMask & b, const int & dx, const int & dy) {
+	MaskOverlap area;
+	if (!findOverlap(a, b, dx, dy, area))
+		return false;
+
+#if defined(XCUBE_MASK_SSE2)
+	// the shift is the same for every word, a shift by 64 gives zero so shift 0 needs no branch
+	const __m128i right = _mm_cvtsi32_si128(area.shift), left = _mm_cvtsi32_si128(64 - area.shift);
+	const __m128i zero = _mm_setzero_si128();
+#endif
+
+	for (int y = area.minY; y < area.maxY; ++y) {
+		const Uint64 * rowA = a.getRow(y);
+		const Uint64 * rowB = b.getRow(y - dy);
+		int k = area.firstWord, w = area.word;
+
+#if defined(XCUBE_MASK_SSE2)
+		// two words per step, one branch per row
+		__m128i any = zero;
+		for (; k + 1 <= area.lastWord; k += 2, w += 2) {
+			__m128i low = _mm_loadu_si128((const __m128i *)(rowB + w));
+			__m128i high = _mm_loadu_si128((const __m128i *)(rowB + w + 1));
+			__m128i bits = _mm_or_si128(_mm_srl_epi64(low, right), _mm_sll_epi64(high, left));
+			any = _mm_or_si128(any, _mm_and_si128(bits, _mm_loadu_si128((const __m128i *)(rowA + k))));
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF)
+			return true;
+#endif
+
+		// remainder, or everything without SIMD
+		for (; k <= area.lastWord; ++k, ++w)
+			if (rowA[k] & alignedWord(rowB, w, area.shift))
+				return true;
+	}
+
+	return false;
+}
+
+bool overlapPixelMaskRect(const PixelMask & mask, int minX, int minY, int maxX, int maxY) {
+	SDL_Rect bounds = mask.getSetBounds();
+	minX = std::max(minX, bounds.x);
+	minY = std::max(minY, bounds.y);
+	maxX = std::min(maxX, bounds.x + bounds.w);
+	maxY = std::min(maxY, bounds.y + bounds.h);
+	if (minX >= maxX || minY >= maxY)
+		return false;
+
+	const int firstWord = minX >> 6, lastWord = (maxX - 1) >> 6;
+	const Uint64 firstBits = ~(Uint64)0 << (minX & 63);
+	const Uint64 lastBits = ~(Uint64)0 >> (63 - ((maxX - 1) & 63));
+
+	for (int y = minY; y < maxY; ++y) {
+		const Uint64 * row = mask.getRow(y);
+		for (int k = firstWord; k <= lastWord; ++k) {
+			Uint64 bits = row[k];
+			if (k == firstWord)
+				bits &= firstBits;
+			if (k == lastWord)
+				bits &= lastBits;
+			if (bits != 0)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+const char * getPixelMaskPath() {
+#if defined(XCUBE_MASK_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
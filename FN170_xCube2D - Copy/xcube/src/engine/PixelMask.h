@@ -0,0 +1,97 @@
+#ifndef __PIXEL_MASK_H__
+#define __PIXEL_MASK_H__
+
+#include <vector>
+#include <memory>
+
+#include <SDL.h>
+
+#include "EngineCommon.h"
+
+static const Uint8 DEFAULT_MASK_ALPHA = 128;	// pixels at least this opaque are solid
+
+/**
+ * One bit per pixel, set where a sprite is solid, for pixel exact collision tests.
+ * Rows are packed into 64 bit words (pixel x is bit x % 64 of word x / 64),
+ * so two masks are compared 64 pixels per AND instead of pixel by pixel.
+ * Masks are not rotated or scaled with the sprite, build one per size with scaled()
+ */
+class PixelMask {
+	private:
+		int width, height;
+		int wordsPerRow;
+		int stride;		// wordsPerRow plus a zero word on each side, so shifted reads never leave the row
+		std::vector<Uint64> words;
+
+		// smallest rectangle holding every set pixel, max exclusive, empty when nothing is set
+		int setMinX, setMinY, setMaxX, setMaxY;
+
+		void updateSetBounds();
+	public:
+		/**
+		* @param width, height - in pixels, must be positive. All pixels start clear
+		*/
+		PixelMask(const int & width, const int & height);
+
+		/**
+		* Builds the mask of a loaded image, a pixel is solid if its alpha is at least alphaThreshold
+		* and, when the surface has a colour key, its value is not the key
+		*
+		* @throws EngineException if the surface cannot be read
+		*/
+		static std::shared_ptr<PixelMask> fromSurface(SDL_Surface * surface, const Uint8 & alphaThreshold = DEFAULT_MASK_ALPHA);
+
+		/**
+		* @return a copy stretched to the given size (nearest pixel), e.g. for a sprite drawn larger than its texture
+		*/
+		std::shared_ptr<PixelMask> scaled(const int & newWidth, const int & newHeight) const;
+
+		int getWidth() const { return width; }
+		int getHeight() const { return height; }
+
+		bool get(const int & x, const int & y) const;
+		void set(const int & x, const int & y, bool solid);
+
+		/**
+		* @return number of solid pixels
+		*/
+		int countSet() const;
+
+		/**
+		* Bounds of the solid pixels, max exclusive, so tests can skip the transparent border
+		*/
+		SDL_Rect getSetBounds() const { SDL_Rect r = { setMinX, setMinY, setMaxX - setMinX, setMaxY - setMinY }; return r; }
+
+		/**
+		* @return the words of row y, wordsPerRow of them with a zero word readable on either side
+		*/
+		const Uint64 * getRow(const int & y) const { return words.data() + y * stride + 1; }
+		int getWordsPerRow() const { return wordsPerRow; }
+};
+
+/**
+ * Tests whether two masks have a solid pixel in the same place, with b's top left corner at (dx, dy)
+ * in a's pixels. Only the rows and words where both masks' solid bounds overlap are looked at,
+ * so callers do the cheap bounding box test first and this one only on boxes that overlap.
+ *
+ * Uses SSE2 (two words per AND) when the compiler targets it, see getPixelMaskPath()
+ */
+bool overlapPixelMasks(const PixelMask & a, const PixelMask & b, const int & dx, const int & dy);
+
+/**
+ * Same as overlapPixelMasks() one word at a time, the reference for tests and benchmarks
+ */
+bool overlapPixelMasksScalar(const PixelMask & a, const PixelMask & b, const int & dx, const int & dy);
+
+/**
+ * Tests whether the mask has a solid pixel inside a rectangle given in its pixels, max exclusive,
+ * e.g. the bounding box of a body without a mask
+ */
+bool overlapPixelMaskRect(const PixelMask & mask, int minX, int minY, int maxX, int maxY);
+
+/**
+ * @return "sse2" or "scalar", the path compiled into overlapPixelMasks()
+ */
+const char * getPixelMaskPath();
+
+#endif
@@ -94,9 +94,9 @@ void PlayerEntity::update(float dt)
     dest.x = (int)position.x;
     dest.y = (int)position.y;
 
-    //sync physics body with player position
+    //sync physics body with the sprite center, position is the top left corner
     if (physics)
-        physics->setCenter(position);
+        physics->setCenter(Point2(position.x + dest.w / 2, position.y + dest.h / 2));
 
     //update damage timers and state
     damage.update();
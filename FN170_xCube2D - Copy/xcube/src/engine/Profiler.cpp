@@ -0,0 +1,61 @@
+#include "Profiler.h"
+
+Uint64 Profiler::frameStart = 0;
+Uint64 Profiler::sectionStart[PROFILE_LAST] = {};
+Uint64 Profiler::sectionTotal[PROFILE_LAST] = {};
+
+RollingStats<PROFILE_HISTORY> Profiler::frameStats;
+RollingStats<PROFILE_HISTORY> Profiler::sectionStats[PROFILE_LAST];
+
+static const char * SECTION_NAMES[PROFILE_LAST] = {
+	"events", "update", "physics", "render", "present"
+};
+
+static float nanosToMs(Uint64 nanos) {
+	return (float)((double)nanos / (double)NANOS_PER_MILLI);
+}
+
+void Profiler::beginFrame() {
+	frameStart = Timer::getNanos();
+}
+
+void Profiler::endFrame() {
+	for (int i = 0; i < PROFILE_LAST; ++i) {
+		sectionStats[i].add(nanosToMs(sectionTotal[i]));
+		sectionTotal[i] = 0;
+	}
+
+	frameStats.add(nanosToMs(Timer::getNanos() - frameStart));
+}
+
+void Profiler::begin(ProfileSection section) {
+	sectionStart[section] = Timer::getNanos();
+}
+
+void Profiler::end(ProfileSection section) {
+	sectionTotal[section] += Timer::getNanos() - sectionStart[section];
+}
+
+float Profiler::getSectionMs(ProfileSection section) {
+	return sectionStats[section].getLatest();
+}
+
+const char * Profiler::getSectionName(ProfileSection section) {
+	return SECTION_NAMES[section];
+}
+
+const StatsSummary & Profiler::getSectionStats(ProfileSection section) {
+	return sectionStats[section].getSummary();
+}
+
+float Profiler::getFrameMs() {
+	return frameStats.getLatest();
+}
+
+const StatsSummary & Profiler::getFrameStats() {
+	return frameStats.getSummary();
+}
+
+float Profiler::getFrameHistory(int framesAgo) {
+	return frameStats.getSample(framesAgo);
+}
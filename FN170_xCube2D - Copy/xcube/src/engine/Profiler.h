@@ -0,0 +1,82 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <SDL.h>
+
+#include "Timer.h"
+#include "RollingStats.h"
+
+/**
+ * Fixed set of engine sections timed every frame.
+ * Add new sections before PROFILE_LAST and give them a name in Profiler.cpp
+ */
+enum ProfileSection {
+	PROFILE_EVENTS, PROFILE_UPDATE, PROFILE_PHYSICS, PROFILE_RENDER, PROFILE_PRESENT, PROFILE_LAST
+};
+
+static const int PROFILE_HISTORY = 120;	// frames kept for the frame time graph and statistics
+
+/**
+ * Lightweight frame profiler based on the high resolution Timer
+ *
+ * Sections may be entered multiple times per frame, their times accumulate
+ * until endFrame() is called, which pushes the totals into rolling statistics
+ */
+class Profiler {
+	private:
+		static Uint64 frameStart;
+		static Uint64 sectionStart[PROFILE_LAST];
+		static Uint64 sectionTotal[PROFILE_LAST];
+
+		static RollingStats<PROFILE_HISTORY> frameStats;
+		static RollingStats<PROFILE_HISTORY> sectionStats[PROFILE_LAST];
+	public:
+		static void beginFrame();
+
+		/**
+		* Pushes section totals and the frame time into the rolling statistics
+		*/
+		static void endFrame();
+
+		static void begin(ProfileSection);
+		static void end(ProfileSection);
+
+		/**
+		* @return time spent in section during the last completed frame
+		*/
+		static float getSectionMs(ProfileSection);
+		static const char * getSectionName(ProfileSection);
+
+		/**
+		* @return min / max / mean / percentiles of section time over the history window
+		*/
+		static const StatsSummary & getSectionStats(ProfileSection);
+
+		/**
+		* @return duration of the last completed frame, including any delay
+		*/
+		static float getFrameMs();
+
+		/**
+		* @return min / max / mean / percentiles of frame time over the history window
+		*/
+		static const StatsSummary & getFrameStats();
+
+		/**
+		* @param framesAgo - 0 is the last completed frame
+		*/
+		static float getFrameHistory(int framesAgo);
+};
+
+/**
+ * Times the enclosing scope
+ */
+class ProfileScope {
+	private:
+		ProfileSection section;
+	public:
+		ProfileScope(ProfileSection s) : section(s) { Profiler::begin(section); }
+		~ProfileScope() { Profiler::end(section); }
+};
+
+#endif
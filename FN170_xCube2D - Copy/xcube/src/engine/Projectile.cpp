@@ -2,6 +2,28 @@
 
 //constructor
 Projectile::Projectile(const Point2& startPos, const Vector2f& dir)
+    : Projectile()
+{
+    launch(startPos, dir);
+}
+
+//pooled constructor, the physics body is made once and kept for every launch
+Projectile::Projectile()
+    : alive(false)
+{
+    //create physics body for collision detection
+    physics = std::make_shared<PhysicsObject>(
+        Point2(0, 0),
+        16.0f, 16.0f //slightly larger hitbox for more reliable collisions
+    );
+
+    //swept collision so fast projectiles can't skip over targets between ticks
+    physics->setBullet(true);
+    physics->setShape(CollisionShape::circle(8.0f));
+}
+
+//fire from start position with direction
+void Projectile::launch(const Point2& startPos, const Vector2f& dir)
 {
     //initialise projectile position
     position = Vector2f((float)startPos.x, (float)startPos.y);
@@ -9,11 +31,9 @@ Projectile::Projectile(const Point2& startPos, const Vector2f& dir)
     //set velocity using normalised direction for consistent speed
     velocity = normalise(dir) * speed;
 
-    //create physics body for collision detection
-    physics = std::make_shared<PhysicsObject>(
-        startPos,
-        16.0f, 16.0f //slightly larger hitbox for more reliable collisions
-    );
+    //body is unregistered between shots, registering it starts the sweep here
+    physics->setPosition(position);
+    alive = true;
 }
 
 //per frame projectile update
@@ -23,8 +43,8 @@ void Projectile::update(float dt)
     position.x += velocity.x * dt;
     position.y += velocity.y * dt;
 
-    //sync physics body with logical position
-    physics->setCenter(Point2((int)position.x, (int)position.y));
+    //sync physics body with logical position, float so the sweep isn't truncated
+    physics->setPosition(position);
 
     //kill projectile if it leaves screen bounds
     if (position.x < 0 || position.x > 800 ||
@@ -23,6 +23,12 @@ public:
     //create projectile at start position with direction
     Projectile(const Point2& startPos, const Vector2f& dir);
 
+    //create an idle projectile for a pool, launch() fires it
+    Projectile();
+
+    //reuse this projectile (and its physics body) for a new shot
+    void launch(const Point2& startPos, const Vector2f& dir);
+
     //per-frame update and rendering
     void update(float dt);
     void render(GraphicsEngine* gfx);
@@ -4,8 +4,13 @@ std::map<std::string, SDL_Texture *> ResourceManager::textures;
 std::map<std::string, TTF_Font *> ResourceManager::fonts;
 std::map<std::string, Mix_Chunk *> ResourceManager::sounds;
 std::map<std::string, Mix_Music *> ResourceManager::mp3files;
+std::map<std::string, std::shared_ptr<PixelMask>> ResourceManager::pixelMasks;
 
 SDL_Texture * ResourceManager::loadTexture(std::string file, SDL_Color trans) {
+	return loadTexture(file, trans, false);
+}
+
+SDL_Texture * ResourceManager::loadTexture(std::string file, SDL_Color trans, bool buildPixelMask) {
 	SDL_Texture * texture = nullptr;
 
 	SDL_Surface * surf = IMG_Load(file.c_str());
@@ -13,10 +18,23 @@ SDL_Texture * ResourceManager::loadTexture(std::string file, SDL_Color trans) {
 		throw EngineException(IMG_GetError(), file);
 
 	SDL_SetColorKey(surf, SDL_TRUE, SDL_MapRGB(surf->format, trans.r, trans.g, trans.b));
-	
+
+	// the pixels are only on the CPU until the texture is made
+	if (buildPixelMask) {
+		try {
+			pixelMasks[file] = PixelMask::fromSurface(surf);
+		}
+		catch (EngineException &) {
+			SDL_FreeSurface(surf);
+			throw;
+		}
+	}
+
 	texture = GFX::createTextureFromSurface(surf);
-	if (nullptr == texture)
+	if (nullptr == texture) {
+		SDL_FreeSurface(surf);
 		throw EngineException(SDL_GetError(), file);
+	}
 
 	SDL_FreeSurface(surf);
 
@@ -88,6 +106,9 @@ void ResourceManager::freeResources() {
 		}
 	}
 
+	// objects still holding a mask keep it alive
+	pixelMasks.clear();
+
 #ifdef __DEBUG
 	debug("ResourceManager::freeResources() finished");
 #endif
@@ -108,3 +129,8 @@ Mix_Chunk * ResourceManager::getSound(std::string fileName) {
 Mix_Music * ResourceManager::getMP3(std::string fileName) {
 	return mp3files[fileName];
 }
+
+std::shared_ptr<PixelMask> ResourceManager::getPixelMask(std::string fileName) {
+	auto found = pixelMasks.find(fileName);
+	return found != pixelMasks.end() ? found->second : nullptr;
+}
@@ -3,9 +3,11 @@
 
 #include <map>
 #include <vector>
+#include <memory>
 
 #include "GraphicsEngine.h"
 #include "AudioEngine.h"
+#include "PixelMask.h"
 
 class ResourceManager {
 	private:
@@ -13,6 +15,7 @@ class ResourceManager {
 		static std::map<std::string, Mix_Chunk *> sounds;
 		static std::map<std::string, Mix_Music *> mp3files;
 		static std::map<std::string, TTF_Font *> fonts;
+		static std::map<std::string, std::shared_ptr<PixelMask>> pixelMasks;
 	public:
 
 		/**
@@ -29,6 +32,12 @@ class ResourceManager {
 		* by calling get* with appropriate filename
 		*/
 		static SDL_Texture * loadTexture(std::string fileName, SDL_Color transparent);
+
+		/**
+		* Also builds the image's PixelMask from its alpha and the transparent colour
+		* while the pixels are still in memory, see getPixelMask()
+		*/
+		static SDL_Texture * loadTexture(std::string fileName, SDL_Color transparent, bool buildPixelMask);
 		static TTF_Font * loadFont(std::string fileName, const int & pointSize);
 		static Mix_Chunk * loadSound(std::string fileName);
 		static Mix_Music * loadMP3(std::string fileName);
@@ -37,6 +46,11 @@ class ResourceManager {
 		static TTF_Font * getFont(std::string fileName);
 		static Mix_Chunk * getSound(std::string fileName);
 		static Mix_Music * getMP3(std::string fileName);
+
+		/**
+		* @return the mask built by loadTexture(fileName, transparent, true), nullptr if none was built
+		*/
+		static std::shared_ptr<PixelMask> getPixelMask(std::string fileName);
 };
 
 #endif
@@ -0,0 +1,122 @@
+#ifndef __ROLLING_STATS_H__
+#define __ROLLING_STATS_H__
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Summary of the samples currently in a RollingStats window
+ */
+struct StatsSummary {
+	int count;
+	float min, max, mean;
+	float p50, p95, p99;
+
+	StatsSummary() : count(0), min(0.0f), max(0.0f), mean(0.0f), p50(0.0f), p95(0.0f), p99(0.0f) {}
+};
+
+/**
+ * Keeps the last N samples (e.g. frame times in ms) in a fixed ring buffer
+ * and computes min / max / mean / percentiles over them
+ *
+ * Never allocates: both the ring and the scratch buffer used for
+ * percentiles live inside the object, so instances can sit in hot code
+ *
+ * Percentiles use nearest rank and cost one sort of the window,
+ * the result is cached until the next add()
+ */
+template <int N>
+class RollingStats {
+	private:
+		float samples[N];
+		float sorted[N];
+		int count;
+		int next;
+
+		bool dirty;
+		StatsSummary summary;
+
+	public:
+		RollingStats() : count(0), next(0), dirty(false) {}
+
+		void add(const float & value) {
+			samples[next] = value;
+			next = (next + 1) % N;
+			if (count < N)
+				++count;
+			dirty = true;
+		}
+
+		void clear() {
+			count = 0;
+			next = 0;
+			dirty = false;
+			summary = StatsSummary();
+		}
+
+		int getCount() const { return count; }
+		int getCapacity() const { return N; }
+		bool isFull() const { return count == N; }
+
+		/**
+		* @param samplesAgo - 0 is the most recent sample
+		* @return the sample or 0 if there are not that many samples yet
+		*/
+		float getSample(const int & samplesAgo) const {
+			if (samplesAgo < 0 || samplesAgo >= count)
+				return 0.0f;
+			int index = next - 1 - samplesAgo;
+			if (index < 0)
+				index += N;
+			return samples[index];
+		}
+
+		float getLatest() const { return getSample(0); }
+
+		const StatsSummary & getSummary() {
+			if (!dirty)
+				return summary;
+
+			summary = StatsSummary();
+			summary.count = count;
+			if (count == 0) {
+				dirty = false;
+				return summary;
+			}
+
+			double sum = 0.0;
+			for (int i = 0; i < count; ++i) {
+				sorted[i] = samples[i];
+				sum += samples[i];
+			}
+			std::sort(sorted, sorted + count);
+
+			summary.min = sorted[0];
+			summary.max = sorted[count - 1];
+			summary.mean = (float)(sum / count);
+			summary.p50 = percentileOfSorted(0.50f);
+			summary.p95 = percentileOfSorted(0.95f);
+			summary.p99 = percentileOfSorted(0.99f);
+
+			dirty = false;
+			return summary;
+		}
+
+		float getMin() { return getSummary().min; }
+		float getMax() { return getSummary().max; }
+		float getMean() { return getSummary().mean; }
+		float getP50() { return getSummary().p50; }
+		float getP95() { return getSummary().p95; }
+		float getP99() { return getSummary().p99; }
+
+	private:
+		// nearest rank on the sorted scratch buffer, only valid inside getSummary()
+		float percentileOfSorted(const float & p) const {
+			int rank = (int)std::ceil(p * count);
+			if (rank < 1) rank = 1;
+			if (rank > count) rank = count;
+			return sorted[rank - 1];
+		}
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include "SystemScheduler.h"
+
+#include <exception>
+#include <thread>
+
+SystemScheduler::SystemScheduler() {}
+
+SystemScheduler::System & SystemScheduler::add(const std::string & name, const SystemFunction & function) {
+	systems.push_back(std::unique_ptr<System>(new System(name, function)));
+	return *systems.back();
+}
+
+void SystemScheduler::setThreadCount(const int & count) {
+	if (count < 0)
+		throw EngineException("Invalid system thread count:", std::to_string(count));
+
+	int threads = count > 0 ? count : (int)std::thread::hardware_concurrency();
+	if (threads <= 1)
+		jobs.reset();
+	else if (!jobs || jobs->getThreadCount() != threads)
+		jobs.reset(new JobSystem(threads));
+}
+
+bool SystemScheduler::conflicts(const System & a, const System & b) {
+	if (!a.declared || !b.declared)
+		return true;
+	return (a.writing & (b.reading | b.writing)) != 0 || (b.writing & a.reading) != 0;
+}
+
+void SystemScheduler::buildStages() {
+	// greedy, a system joins the current stage if it conflicts with nobody in it,
+	// so systems that do conflict keep the order they were added in
+	stageStarts.clear();
+	for (int s = 0; s < (int)systems.size(); ++s) {
+		bool fits = !stageStarts.empty();
+		for (int t = fits ? stageStarts.back() : s; t < s && fits; ++t)
+			fits = !conflicts(*systems[t], *systems[s]);
+		if (!fits)
+			stageStarts.push_back(s);
+	}
+}
+
+void SystemScheduler::runSystem(System & system, EntityWorld & world, const float & dt) {
+	system.timer.measure();
+	system.function(world, dt);
+	system.ms = system.timer.getElapsedMs();
+}
+
+void SystemScheduler::run(EntityWorld & world, const float & dt) {
+	// rebuilt every run, declarations may change after add() and there are only a handful of systems
+	buildStages();
+
+	for (int stage = 0; stage < (int)stageStarts.size(); ++stage) {
+		const int begin = stageStarts[stage];
+		const int end = stage + 1 < (int)stageStarts.size() ? stageStarts[stage + 1] : (int)systems.size();
+
+		if (!jobs || end - begin < 2) {
+			for (int s = begin; s < end; ++s)
+				runSystem(*systems[s], world, dt);
+		}
+		else {
+			// jobs must not throw, the first exception is kept and thrown once the stage is done
+			std::vector<std::exception_ptr> errors(end - begin);
+			jobs->parallelFor(end - begin, [&](int s) {
+				try {
+					runSystem(*systems[begin + s], world, dt);
+				}
+				catch (...) {
+					errors[s] = std::current_exception();
+				}
+			});
+
+			for (size_t e = 0; e < errors.size(); ++e)
+				if (errors[e])
+					std::rethrow_exception(errors[e]);
+		}
+
+		world.flushDeferred();
+	}
+}
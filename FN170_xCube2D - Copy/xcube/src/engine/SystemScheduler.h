@@ -0,0 +1,95 @@
+#ifndef __SYSTEM_SCHEDULER_H__
+#define __SYSTEM_SCHEDULER_H__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EntityWorld.h"
+#include "JobSystem.h"
+#include "Timer.h"
+
+typedef std::function<void(EntityWorld &, const float &)> SystemFunction;
+
+/**
+ * Runs systems (functions over an EntityWorld) once per update in the order they were added.
+ *
+ * A system that declares which component types it reads and writes may run on another thread
+ * at the same time as its neighbours, as long as none of them writes what another reads or writes.
+ * Systems that declare nothing run alone. Structural changes queued with EntityWorld::defer()
+ * are applied after each group of systems (stage), so later systems see them
+ */
+class SystemScheduler {
+	public:
+		class System {
+			friend class SystemScheduler;
+			private:
+				std::string name;
+				SystemFunction function;
+				ComponentMask reading, writing;
+				bool declared;
+				double ms;
+				Timer timer;
+
+				System(const std::string & name, const SystemFunction & function)
+					: name(name), function(function), reading(0), writing(0), declared(false), ms(0) {}
+			public:
+				template <class... C>
+				System & reads() {
+					reading |= componentMask<C...>();
+					declared = true;
+					return *this;
+				}
+
+				template <class... C>
+				System & writes() {
+					writing |= componentMask<C...>();
+					declared = true;
+					return *this;
+				}
+		};
+	private:
+		std::vector<std::unique_ptr<System>> systems;	// stay put, add() hands out references
+		std::vector<int> stageStarts;
+		std::unique_ptr<JobSystem> jobs;	// nullptr while single threaded
+
+		static bool conflicts(const System & a, const System & b);
+		void buildStages();
+		void runSystem(System & system, EntityWorld & world, const float & dt);
+	public:
+		SystemScheduler();
+
+		/**
+		* @return the system, to declare its components, e.g. add("motion", f).reads<Motion>().writes<Transform>()
+		*/
+		System & add(const std::string & name, const SystemFunction & function);
+
+		/**
+		* @param count - threads running systems of a stage side by side, including the caller.
+		*				0 picks the number of hardware threads, 1 (the default) runs everything on the caller
+		*/
+		void setThreadCount(const int & count);
+		int getThreadCount() const { return jobs ? jobs->getThreadCount() : 1; }
+
+		/**
+		* Runs every system and flushes the world's deferred commands after each stage.
+		* If systems of a stage throw, the stage still finishes and the first exception is rethrown
+		*/
+		void run(EntityWorld & world, const float & dt);
+
+		int getSystemCount() const { return (int)systems.size(); }
+		const std::string & getSystemName(const int & i) const { return systems[i]->name; }
+
+		/**
+		* @return time system i took in the last run()
+		*/
+		double getSystemMs(const int & i) const { return systems[i]->ms; }
+
+		/**
+		* @return number of stages the last run() was split into
+		*/
+		int getStageCount() const { return (int)stageStarts.size(); }
+};
+
+#endif
@@ -1,19 +1,44 @@
 #include "Timer.h"
 
-Timer::Timer() : time(0) {}
+Uint64 Timer::frequency = 0;
+
+Timer::Timer() : start(0) {
+	if (0 == frequency)
+		frequency = SDL_GetPerformanceFrequency();
+}
 
 void Timer::measure() {
-	time = SDL_GetTicks();
+	start = SDL_GetPerformanceCounter();
 }
 
 void Timer::reset() {
-	time = 0;
+	start = 0;
 }
 
 Uint32 Timer::getTime() {
-	return time;
+	return (Uint32)(ticksToNanos(start) / NANOS_PER_MILLI);
 }
 
 Uint32 Timer::getElapsed() {
-	return SDL_GetTicks() - time;
-}
\ No newline at end of file
+	return (Uint32)(getElapsedNanos() / NANOS_PER_MILLI);
+}
+
+Uint64 Timer::getElapsedNanos() {
+	return ticksToNanos(SDL_GetPerformanceCounter() - start);
+}
+
+double Timer::getElapsedMs() {
+	return (double)getElapsedNanos() / (double)NANOS_PER_MILLI;
+}
+
+Uint64 Timer::getNanos() {
+	return ticksToNanos(SDL_GetPerformanceCounter());
+}
+
+Uint64 Timer::ticksToNanos(Uint64 ticks) {
+	if (0 == frequency)
+		frequency = SDL_GetPerformanceFrequency();
+
+	// split whole seconds off first, ticks * 1e9 would overflow after a few seconds
+	return (ticks / frequency) * NANOS_PER_SECOND + ((ticks % frequency) * NANOS_PER_SECOND) / frequency;
+}
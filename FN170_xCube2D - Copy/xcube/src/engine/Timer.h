@@ -7,19 +7,59 @@ static const int SECOND = 1000;
 static const int MINUTE = 60 * SECOND;
 static const int HOUR = 60 * MINUTE;
 
+static const Uint64 NANOS_PER_SECOND = 1000000000ULL;
+static const Uint64 NANOS_PER_MILLI = 1000000ULL;
+
 /**
  * Relative timer, used to tell how much time has passed
  * since certain event rather than the actual time
+ *
+ * Based on SDL_GetPerformanceCounter(), so it resolves well below
+ * a millisecond (nanosecond units, actual resolution is platform dependent)
  */
 class Timer {
 	private:
-		Uint32 time;
+		Uint64 start;	// performance counter value at measure()
+
+		static Uint64 frequency;
 	public:
 		Timer();
+
+		/**
+		* Starts (or restarts) measuring from now
+		*/
 		void measure();
 		void reset();
+
+		/**
+		* @return time of the last measure() in milliseconds
+		*/
 		Uint32 getTime();
+
+		/**
+		* @return milliseconds since measure(), truncated
+		*/
 		Uint32 getElapsed();
+
+		/**
+		* @return nanoseconds since measure()
+		*/
+		Uint64 getElapsedNanos();
+
+		/**
+		* @return fractional milliseconds since measure()
+		*/
+		double getElapsedMs();
+
+		/**
+		* @return current time in nanoseconds from an arbitrary starting point
+		*/
+		static Uint64 getNanos();
+
+		/**
+		* Converts a performance counter delta to nanoseconds without overflowing
+		*/
+		static Uint64 ticksToNanos(Uint64 ticks);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -70,6 +70,12 @@ XCube2Engine::XCube2Engine() {
 	debug("MyEngineSystem() successful");
 #endif
 
+	debugOverlayInstance = std::shared_ptr<DebugOverlay>(new DebugOverlay(gfxInstance, physicsInstance));
+
+#ifdef __DEBUG
+	debug("DebugOverlay() successful");
+#endif
+
 }
 
 XCube2Engine::~XCube2Engine() {
@@ -85,6 +91,9 @@ XCube2Engine::~XCube2Engine() {
 		myEngineSystemInstance.reset();
 	}
 
+	// overlay owns a texture, release it while the renderer is still alive
+	debugOverlayInstance.reset();
+
 	audioInstance.reset();
 	eventInstance.reset();
 	physicsInstance.reset();
@@ -12,6 +12,8 @@
 #include "custom/MyEngineSystem.h"
 #include "ResourceManager.h"
 #include "Timer.h"
+#include "Profiler.h"
+#include "DebugOverlay.h"
 
 const int _ENGINE_VERSION_MAJOR = 0;
 const int _ENGINE_VERSION_MINOR = 1;
@@ -26,6 +28,8 @@ class XCube2Engine {
 
         std::shared_ptr<MyEngineSystem> myEngineSystemInstance;
 
+		std::shared_ptr<DebugOverlay> debugOverlayInstance;
+
 		XCube2Engine();
 	public:
 		/**
@@ -51,6 +55,7 @@ class XCube2Engine {
 		std::shared_ptr<EventEngine> getEventEngine() { return eventInstance; }
 		std::shared_ptr<PhysicsEngine> getPhysicsEngine() { return physicsInstance; }
         std::shared_ptr<MyEngineSystem> getMyEngineSystem() { return myEngineSystemInstance; }
+		std::shared_ptr<DebugOverlay> getDebugOverlay() { return debugOverlayInstance; }
 };
 
 typedef XCube2Engine XEngine;